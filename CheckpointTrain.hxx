@@ -0,0 +1,366 @@
+/// ===========================================================================
+/*! \file   CheckpointTrain.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to train a TMVA MLP in segments,
+ *  checkpointing it after each one so a killed or
+ *  preempted training can pick up where it left off.
+ */
+/// ===========================================================================
+
+#ifndef CheckpointTrain_hxx
+#define CheckpointTrain_hxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+// root libraries
+#include <TFile.h>
+#include <TSystem.h>
+#include <TXMLEngine.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+#include <TMVA/MethodBase.h>
+// analysis utilities
+#include "TMVAHelper.hxx"
+#include "NativeModel.hxx"
+#include "FeatureCache.hxx"
+#include "ParallelTrain.hxx"
+
+
+
+// ============================================================================
+//! Checkpoint Train
+// ============================================================================
+/*! TMVA only writes an MLP's weights once training
+ *  is over, so a long training is cut into segments
+ *  of `interval` cycles, each a training of its own
+ *  that starts from the weights the last one ended
+ *  with. After every segment the weights file is
+ *  copied to '<checkpoints>/<method>.<cycles>.weights.xml'
+ *  and a small state file ('<method>.state') records
+ *  how far training got; on restart, training resumes
+ *  from the latest checkpoint.
+ *
+ *  TMVA keeps no optimizer state across trainings,
+ *  and none is checkpointed: each segment, and any
+ *  resume, restarts the optimizer from the saved
+ *  weights. What can be is carried over by hand:
+ *
+ *    - BFGS: segments are made a multiple of
+ *      ResetStep long, so the inverse-Hessian
+ *      estimate is dropped where TMVA would reset
+ *      it anyway (the rest of its state, e.g. the
+ *      last step taken, still starts over);
+ *    - BP: the learning rate a segment starts with is
+ *      decayed by the cycles already done;
+ *    - sampling: SamplingEpoch is rescaled so events
+ *      are sampled over the same share of all cycles.
+ *
+ *  The convergence test does restart with each
+ *  segment, and GA training isn't segmented at all.
+ *  Only the last segment tests & evaluates the
+ *  method, writing '<stem>.<method>.root' (see
+ *  ParallelTrain::Merge).
+ */
+namespace CheckpointTrain {
+
+  // --------------------------------------------------------------------------
+  //! How to checkpoint
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;               // name of TMVA process
+    std::string directory;          // tmva directory (name of data loader)
+    std::string stem;               // prefix of output file
+    std::string checkpoints;        // directory to keep checkpoints in
+    std::string key;                // identifies the training data (e.g. hash of input)
+    std::size_t interval = 1000;    // no. of cycles between checkpoints
+    std::size_t keep     = 3;       // max no. of checkpoints kept (0 = all)
+  };
+
+  // --------------------------------------------------------------------------
+  //! Progress of a training
+  // --------------------------------------------------------------------------
+  struct State {
+    uint64_t                 key    = 0;  // hash of method, options, & data
+    std::size_t              cycles = 0;  // no. of cycles done
+    std::vector<std::string> files;       // checkpoints, oldest first
+  };
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read state of a training
+  // --------------------------------------------------------------------------
+  inline bool ReadState(const std::string& path, State& state) {
+
+    std::ifstream in(path);
+    if (!in.good()) return false;
+
+    state = State();
+    std::string field;
+    while (in >> field) {
+      if      (field == "key")        in >> state.key;
+      else if (field == "cycles")     in >> state.cycles;
+      else if (field == "checkpoint") {
+        std::string file;
+        in >> file;
+        state.files.push_back(file);
+      }
+    }
+    return !state.files.empty();
+
+  }  // end 'ReadState(std::string&, State&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write state of a training
+  // --------------------------------------------------------------------------
+  /*! Written to a temporary file first & moved into
+   *  place, so a kill mid-write leaves the old state.
+   */
+  inline bool WriteState(const std::string& path, const State& state) {
+
+    const std::string temp = path + ".tmp";
+    {
+      std::ofstream out(temp, std::ios::trunc);
+      out << "key " << state.key << "\n"
+          << "cycles " << state.cycles << "\n";
+      for (const std::string& file : state.files) {
+        out << "checkpoint " << file << "\n";
+      }
+      if (!out.good()) return false;
+    }
+    return std::rename(temp.data(), path.data()) == 0;
+
+  }  // end 'WriteState(std::string&, State&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Load weights of a checkpoint into a booked method
+  // --------------------------------------------------------------------------
+  /*! n.b. the network of a booked MLP is already built
+   *  (with random weights); reading the weights rebuilds
+   *  it from the file.
+   */
+  inline bool LoadWeights(TMVA::MethodBase* method, const std::string& path) {
+
+    TXMLEngine      xml;
+    XMLDocPointer_t doc = xml.ParseFile(path.data());
+    if (!doc) return false;
+
+    XMLNodePointer_t weights = NativeModel::FindChild(xml, xml.DocGetRootElement(doc), "Weights");
+    if (weights) method -> ReadWeightsFromXML(weights);
+    xml.FreeDoc(doc);
+    return weights != nullptr;
+
+  }  // end 'LoadWeights(TMVA::MethodBase*, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get options of a segment
+  // --------------------------------------------------------------------------
+  /*! For a segment of `nCycles` cycles starting after
+   *  `done` out of `total`; see above.
+   */
+  inline std::string GetSegmentOptions(
+    const std::string& options,
+    const std::size_t done,
+    const std::size_t nCycles,
+    const std::size_t total
+  ) {
+
+    std::string segment = TMVAHelper::SetOption(options, "NCycles", std::to_string(nCycles));
+
+    // decay learning rate by cycles already done
+    if (TMVAHelper::GetOption(options, "TrainingMethod", "BP") == "BP") {
+      const double rate  = std::stod( TMVAHelper::GetOption(options, "LearningRate", "0.02") );
+      const double decay = std::stod( TMVAHelper::GetOption(options, "DecayRate", "0.01") );
+      segment = TMVAHelper::SetOption(segment, "LearningRate", std::to_string(rate * std::pow(1. - decay, done)));
+    }
+
+    // and keep sampling over the same share of cycles
+    if (!TMVAHelper::GetOption(options, "Sampling").empty()) {
+      const double epoch    = std::stod( TMVAHelper::GetOption(options, "SamplingEpoch", "1.0") );
+      const double fraction = std::clamp(((epoch * total) - done) / nCycles, 0., 1.);
+      segment = TMVAHelper::SetOption(segment, "SamplingEpoch", std::to_string(fraction));
+    }
+    return segment;
+
+  }  // end 'GetSegmentOptions(std::string&, std::size_t, std::size_t, std::size_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train one segment
+  // --------------------------------------------------------------------------
+  /*! Starts from the weights in `checkpoint` unless
+   *  it's empty. Only the last segment is tested &
+   *  evaluated.
+   */
+  inline bool TrainSegment(
+    const TMVAHelper::Trainer& helper,
+    const ParallelTrain::Dataset& data,
+    const Settings& settings,
+    const std::string& method,
+    const std::string& options,
+    const std::string& checkpoint,
+    const std::string& path,
+    const bool isLast
+  ) {
+
+    TFile* output = TFile::Open(path.data(), "recreate");
+    if (!output || output -> IsZombie()) return false;
+
+    TMVAHelper::Trainer segment = helper;
+    segment.SetMethodOptions(method, options);
+
+    TMVA::Factory*    factory = new TMVA::Factory(settings.name.data(), output, segment.CompressFactoryOptions().data());
+    TMVA::DataLoader* loader  = new TMVA::DataLoader(settings.directory.data());
+    bool              isGood  = true;
+    try {
+      ParallelTrain::LoadDataset(segment, data, loader);
+      TMVA::MethodBase* booked = segment.BookMethodToTrain(factory, loader, method);
+      if (!checkpoint.empty() && !LoadWeights(booked, checkpoint)) {
+        std::cerr << "WARNING: couldn't read checkpoint '" << checkpoint << "'!" << std::endl;
+        isGood = false;
+      }
+
+      if (isGood) {
+        factory -> TrainAllMethods();
+        if (isLast) {
+          factory -> TestAllMethods();
+          factory -> EvaluateAllMethods();
+        }
+      }
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: training '" << method << "' failed: " << error.what() << std::endl;
+      isGood = false;
+    }
+
+    output -> Close();
+    delete factory;
+    delete loader;
+    return isGood;
+
+  }  // end 'TrainSegment(TMVAHelper::Trainer&, ParallelTrain::Dataset&, Settings&, std::string& x4, bool)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train a method with checkpoints, resuming if possible
+  // --------------------------------------------------------------------------
+  /*! Returns the output file of the training, or an
+   *  empty string if it failed. If training already
+   *  finished (and its output is still there), nothing
+   *  is done.
+   */
+  inline std::string Run(
+    const TMVAHelper::Trainer& helper,
+    const ParallelTrain::Dataset& data,
+    const Settings& settings,
+    const std::string& method
+  ) {
+
+    const std::string options = helper.GetMethodOptions(method);
+    const std::string output  = settings.stem + "." + method + ".root";
+    const std::string weights = settings.directory + "/weights/" + settings.name + "_" + method + ".weights.xml";
+    const std::string status  = settings.checkpoints + "/" + method + ".state";
+    gSystem -> mkdir(settings.checkpoints.data(), true);
+
+    // figure out segment length
+    const std::size_t total    = std::stoul( TMVAHelper::GetOption(options, "NCycles", "500") );
+    const std::string training = TMVAHelper::GetOption(options, "TrainingMethod", "BP");
+    std::size_t       interval = std::max<std::size_t>(settings.interval, 1);
+    if (training == "BFGS") {
+      const std::size_t reset = std::max<std::size_t>(std::stoul( TMVAHelper::GetOption(options, "ResetStep", "50") ), 1);
+      interval = ((interval + reset - 1) / reset) * reset;
+    }
+    if (training == "GA") interval = total;
+
+    // identify training by everything but no. of cycles
+    std::string identity = method + "|" + TMVAHelper::SetOption(options, "NCycles", "*") + "|"
+                         + helper.CompressTrainingOptions() + "|" + data.cut.GetTitle() + "|" + settings.key;
+    for (const std::string& var : helper.GetTargets())  identity += "|" + var;
+    for (const std::string& var : helper.GetTrainers()) identity += "|" + var;
+    const uint64_t key = FeatureCache::Hash(identity.data(), identity.size());
+
+    // resume from latest checkpoint if possible
+    State state;
+    if (ReadState(status, state) && (state.key == key)) {
+      if ((state.cycles >= total) && TMVAHelper::DoesFileExist(output)) {
+        std::cout << "      '" << method << "' already trained for " << total << " cycles." << std::endl;
+        return output;
+      }
+      if ((state.cycles < total) && TMVAHelper::DoesFileExist(state.files.back())) {
+        std::cout << "      Resuming '" << method << "' after " << state.cycles << " cycles from " << state.files.back() << std::endl;
+      } else {
+        state = State();
+      }
+    } else {
+      state = State();
+    }
+    state.key = key;
+
+    // train segment by segment
+    while (state.cycles < total) {
+
+      const std::size_t nCycles = std::min(interval, total - state.cycles);
+      const bool        isLast  = (state.cycles + nCycles >= total);
+      const std::string path    = isLast ? output : settings.checkpoints + "/" + method + ".segment.root";
+      const std::string from    = state.files.empty() ? "" : state.files.back();
+      const bool        isGood  = TrainSegment(
+        helper,
+        data,
+        settings,
+        method,
+        GetSegmentOptions(options, state.cycles, nCycles, total),
+        from,
+        path,
+        isLast
+      );
+      if (!isGood) return "";
+
+      // save checkpoint & drop the oldest ones
+      state.cycles += nCycles;
+      const std::string file = settings.checkpoints + "/" + method + "." + std::to_string(state.cycles) + ".weights.xml";
+      std::error_code   error;
+      std::filesystem::copy_file(weights, file, std::filesystem::copy_options::overwrite_existing, error);
+      if (error) {
+        std::cerr << "WARNING: couldn't write checkpoint '" << file << "': " << error.message() << std::endl;
+        return "";
+      }
+      state.files.push_back(file);
+      while ((settings.keep > 0) && (state.files.size() > settings.keep)) {
+        std::remove(state.files.front().data());
+        state.files.erase(state.files.begin());
+      }
+      if (!WriteState(status, state)) {
+        std::cerr << "WARNING: couldn't write state of '" << method << "' to '" << status << "'!" << std::endl;
+        return "";
+      }
+      std::cout << "      Checkpointed '" << method << "' after " << state.cycles << "/" << total << " cycles." << std::endl;
+    }
+    return output;
+
+  }  // end 'Run(TMVAHelper::Trainer&, ParallelTrain::Dataset&, Settings&, std::string&)'
+
+}  // end CheckpointTrain namespace
+
+#endif
+
+// end ========================================================================
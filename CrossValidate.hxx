@@ -0,0 +1,612 @@
+/// ===========================================================================
+/*! \file   CrossValidate.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to cross-validate TMVA methods over k
+ *  folds, with the folds trained in parallel worker
+ *  processes.
+ */
+/// ===========================================================================
+
+#ifndef CrossValidate_hxx
+#define CrossValidate_hxx
+
+// c++ utilities
+#include <span>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+// root libraries
+#include <TCut.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TSystem.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Types.h>
+#include <TMVA/Reader.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "HistBoost.hxx"
+#include "TMVAHelper.hxx"
+#include "HyperSearch.hxx"
+#include "ParallelTrain.hxx"
+#include "FeatureCache.hxx"
+#include "NTupleHelper.hxx"
+#include "PreparedDataset.hxx"
+#include "NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Cross Validate
+// ============================================================================
+/*! Every event passing the training cut is put in
+ *  one of k folds by a seeded hash of its position,
+ *  so folds are equal in size only on average.
+ *  Fold i is trained on the other k - 1 folds & then
+ *  applied to fold i, so every event gets exactly
+ *  one out-of-fold estimate from a model that never
+ *  saw it. nTrain_Regression & co. are ignored.
+ *
+ *  Folds are trained at the same time in forked
+ *  workers (see ParallelTrain.hxx for why), each
+ *  training all methods on (k - 1)/k of the events;
+ *  with a core per fold, cross-validating takes about
+ *  as long as a single training. Resolution &
+ *  non-linearity (see HyperSearch.hxx) are measured
+ *  per fold & on all out-of-fold estimates, and the
+ *  estimates are written to a tuple with one row per
+ *  event, in the order the events pass the cut.
+ */
+namespace CrossValidate {
+
+  // --------------------------------------------------------------------------
+  //! How to cross-validate
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;                // name of TMVA process
+    std::string directory;           // directory to train folds in
+    std::size_t jobs       = 0;      // max no. of folds trained at once (0 = all)
+    std::size_t threads    = 0;      // no. of threads per fold for native methods (0 = cores / jobs)
+    std::size_t block_size = 4096;   // no. of events applied to at a time
+    std::size_t bins       = 10;     // no. of bins in target to measure in
+    float       weight     = 1.0;    // weight of trees
+  };
+
+  // --------------------------------------------------------------------------
+  //! Scores of a regression output
+  // --------------------------------------------------------------------------
+  struct Result {
+    std::string         output;           // e.g. "ePar_BDTG"
+    std::vector<double> resolutions;      // resolution of each fold
+    std::vector<double> linearities;      // non-linearity of each fold
+    double              resolution = 0.;  // resolution of all out-of-fold estimates
+    double              linearity  = 0.;  // non-linearity of all out-of-fold estimates
+  };
+
+
+
+  // ==========================================================================
+  //! Folds of a dataset
+  // ==========================================================================
+  /*! Deals the events passing the cut out into one
+   *  prepared cache per fold (see PreparedCaches), in
+   *  the order they pass it. The caches are keyed on
+   *  the input, variables, cut, no. of folds, & seed.
+   */
+  class Folds {
+
+    private:
+
+      // data members
+      std::size_t           m_folds      = 5;
+      uint64_t              m_seed       = 100;
+      bool                  m_spectators = false;
+      std::vector<uint32_t> m_assignment;
+      PreparedCaches        m_caches;
+
+      // ----------------------------------------------------------------------
+      //! Get path to the cache of a fold
+      // ----------------------------------------------------------------------
+      inline std::string GetPath(const std::string& stem, const std::size_t fold) const {
+
+        return stem + ".fold" + std::to_string(fold) + "of" + std::to_string(m_folds) + ".fcache";
+
+      }  // end 'GetPath(std::string&, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Get fold of a selected event
+      // ----------------------------------------------------------------------
+      /*! Hashes (SplitMix64) the seed & the event's
+       *  position among selected events, so the fold is
+       *  known as soon as the event is read.
+       */
+      inline uint32_t GetFold(const uint64_t row) const {
+
+        uint64_t hash = m_seed + (0x9E3779B97F4A7C15ULL * (row + 1));
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        hash = hash ^ (hash >> 31);
+        return hash % m_folds;
+
+      }  // end 'GetFold(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Assign selected events to folds
+      // ----------------------------------------------------------------------
+      inline void Assign(const uint64_t nRows) {
+
+        m_assignment.resize(nRows);
+        for (uint64_t iRow = 0; iRow < nRows; ++iRow) {
+          m_assignment[iRow] = GetFold(iRow);
+        }
+        return;
+
+      }  // end 'Assign(uint64_t)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline std::size_t                     GetNFolds()       const {return m_folds;}
+      inline uint64_t                        GetSeed()         const {return m_seed;}
+      inline bool                            GetSpectators()   const {return m_spectators;}
+      inline const std::vector<std::string>& GetVariables()    const {return m_caches.GetVariables();}
+      inline const std::vector<uint32_t>&    GetAssignment()   const {return m_assignment;}
+      inline const FeatureCache&             GetCache(const std::size_t fold) const {return m_caches.GetCache(fold);}
+      inline NTupleHelper&                   GetHelper()             {return m_caches.GetHelper();}
+      inline NTupleIO::Reader&               GetSource(const std::size_t fold) {return m_caches.GetSource(fold);}
+      inline TTree*                          GetTree(const std::size_t fold)   {return m_caches.GetTree(fold);}
+
+      // ----------------------------------------------------------------------
+      //! Open caches, (re)building them if they're stale
+      // ----------------------------------------------------------------------
+      /*! Caches go to '<stem>.fold<i>of<k>.fcache'. `hash`
+       *  is the hash of the input file, and `source` has
+       *  to provide every variable & the cut. Returns true
+       *  if the caches had to be (re)built.
+       */
+      inline bool Update(
+        NTupleIO::Reader& source,
+        const TCut& cut,
+        const uint64_t hash,
+        const std::string& stem
+      ) {
+
+        // key on input, folds, variables, & cut
+        const std::string split = "NumFolds=" + std::to_string(m_folds) + ":FoldSeed=" + std::to_string(m_seed);
+        const uint64_t    key   = FeatureCache::Hash(split.data(), split.size(), hash);
+
+        std::vector<std::string> paths;
+        std::vector<std::string> names;
+        for (std::size_t iFold = 0; iFold < m_folds; ++iFold) {
+          paths.push_back( GetPath(stem, iFold) );
+          names.push_back( "fold" + std::to_string(iFold) );
+        }
+
+        // each event goes straight to its fold
+        const bool isStale = m_caches.Update(paths, names, cut, key, [&]() {
+          uint64_t nRows = 0;
+          return m_caches.Write(source, cut, key, paths, [&]() -> std::size_t {return GetFold(nRows++);});
+        });
+
+        // assignment only depends on no. of events, but
+        // make sure it lines up with the caches
+        uint64_t nRows = 0;
+        for (std::size_t iFold = 0; iFold < m_folds; ++iFold) {
+          nRows += m_caches.GetCache(iFold).GetRows();
+        }
+        Assign(nRows);
+
+        std::vector<uint64_t> nInFold(m_folds, 0);
+        for (const uint32_t fold : m_assignment) {
+          ++nInFold[fold];
+        }
+
+        bool isGood = true;
+        for (std::size_t iFold = 0; iFold < m_folds; ++iFold) {
+          isGood &= (nInFold[iFold] == m_caches.GetCache(iFold).GetRows());
+        }
+        if (!isGood) {
+          std::cerr << "PANIC: folds '" << stem << "' don't match their assignment!" << std::endl;
+          assert(isGood);
+        }
+        return isStale;
+
+      }  // end 'Update(NTupleIO::Reader&, TCut&, uint64_t, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Add trees of a fold to a data loader
+      // ----------------------------------------------------------------------
+      /*! Every other fold is added for training & the
+       *  fold itself for testing. `options` are the
+       *  training options besides the split (see
+       *  PreparedDataset::ParseSplit).
+       */
+      inline void LoadTrees(
+        TMVA::DataLoader* loader,
+        const float weight,
+        const std::size_t fold,
+        std::vector<std::string> options
+      ) {
+
+        for (std::size_t iFold = 0; iFold < m_folds; ++iFold) {
+          if (iFold == fold) continue;
+          loader -> AddRegressionTree(GetTree(iFold), weight, TMVA::Types::kTraining);
+        }
+        loader -> AddRegressionTree(GetTree(fold), weight, TMVA::Types::kTesting);
+
+        options.push_back("nTrain_Regression=0:nTest_Regression=0:SplitMode=Block");
+        loader -> PrepareTrainingAndTestTree("", TMVAHelper::CompressList(options).data());
+        return;
+
+      }  // end 'LoadTrees(TMVA::DataLoader*, float, std::size_t, std::vector<std::string>)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Folds()  {};
+      ~Folds() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a trainer, no. of folds, & a seed
+      // ----------------------------------------------------------------------
+      /*! Spectators are only kept if they're added to
+       *  the data loader.
+       */
+      Folds(
+        const TMVAHelper::Trainer& trainer,
+        const std::size_t folds,
+        const uint64_t seed = 100,
+        const bool add_spectators = false
+      ) : m_caches(trainer, std::max<std::size_t>(folds, 2), add_spectators) {
+
+        m_folds      = std::max<std::size_t>(folds, 2);
+        m_seed       = seed;
+        m_spectators = add_spectators;
+
+      }  // end ctor(TMVAHelper::Trainer&, std::size_t, uint64_t, bool)'
+
+  };  // end CrossValidate::Folds
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get names of the regression outputs of a trainer
+  // --------------------------------------------------------------------------
+  /*! As named by TMVAHelper::Reader: "<target>_<method>",
+   *  method by method.
+   */
+  inline std::vector<std::string> GetOutputs(const TMVAHelper::Trainer& trainer) {
+
+    std::vector<std::string> outputs;
+    for (const std::string& method : trainer.GetMethods()) {
+      for (const std::string& target : trainer.GetTargets()) {
+        outputs.push_back(target + "_" + method);
+      }
+    }
+    return outputs;
+
+  }  // end 'GetOutputs(TMVAHelper::Trainer&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train on all but one fold & apply to it
+  // --------------------------------------------------------------------------
+  /*! Runs inside a worker, in `settings.directory`:
+   *  weights go to 'fold<i>/weights', the estimates on
+   *  fold i to 'fold<i>.oof.fcache' (one column per
+   *  output), and the training time to 'fold<i>.time'.
+   *  Returns the exit status of the worker. Native
+   *  methods train on every event of the other folds.
+   */
+  inline int RunFold(
+    const TMVAHelper::Trainer& trainer,
+    Folds& folds,
+    const Settings& settings,
+    const std::size_t fold
+  ) {
+
+    gSystem -> ChangeDirectory(settings.directory.data());
+
+    const std::string stem   = "fold" + std::to_string(fold);
+    TFile*            output = TFile::Open((stem + ".root").data(), "recreate");
+    if (!output || output -> IsZombie()) return 1;
+
+    // train every method on the other folds
+    TMVAHelper::Trainer helper = trainer;
+
+    TMVA::Tools::Instance();
+    TMVA::Factory*    factory = new TMVA::Factory(settings.name.data(), output, helper.CompressFactoryOptions().data());
+    TMVA::DataLoader* loader  = new TMVA::DataLoader(stem.data());
+    double            time    = 0.;
+    bool              isGood  = true;
+    try {
+      helper.LoadVariables(loader, folds.GetSpectators());
+      folds.LoadTrees(loader, settings.weight, fold, PreparedDataset::ParseSplit( helper.GetTrainingOptions() ).others);
+      helper.BookMethodsToTrain(factory, loader);
+
+      const auto start = std::chrono::steady_clock::now();
+      factory -> TrainAllMethods();
+
+      // native methods aren't booked, so train them
+      // on the other folds here
+      std::vector<NTupleIO::Reader*> others;
+      for (std::size_t iFold = 0; iFold < folds.GetNFolds(); ++iFold) {
+        if (iFold != fold) others.push_back( &folds.GetSource(iFold) );
+      }
+
+      // n.b. folds train at the same time, so by
+      // default they split the cores between them
+      const std::size_t nJobs = std::min(folds.GetNFolds(), (settings.jobs > 0) ? settings.jobs : folds.GetNFolds());
+      const std::size_t nCore = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+      HistBoost::Settings native;
+      native.name       = settings.name;
+      native.directory  = stem;
+      native.block_size = settings.block_size;
+      native.threads    = (settings.threads > 0) ? settings.threads : std::max<std::size_t>(nCore / std::max<std::size_t>(nJobs, 1), 1);
+      for (const std::string& method : helper.GetMethods()) {
+        if (!TMVAHelper::IsNative(method)) continue;
+        if (HistBoost::Run(helper, others, "", native, method).empty()) {
+          std::cerr << "PANIC: couldn't train " << method << " on fold " << fold << "!" << std::endl;
+          isGood = false;
+          break;
+        }
+      }
+      time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: training fold " << fold << " failed: " << error.what() << std::endl;
+      isGood = false;
+    }
+
+    output -> Close();
+    delete factory;
+    delete loader;
+    if (!isGood) return 1;
+
+    try {
+
+      // then apply them to this one
+      std::vector<std::pair<TMVAHelper::Use, std::string>> inputs;
+      for (const std::string& target : helper.GetTargets()) {
+        inputs.push_back( {TMVAHelper::Use::Target, target} );
+      }
+      for (const std::string& train : helper.GetTrainers()) {
+        inputs.push_back( {TMVAHelper::Use::Train, train} );
+      }
+
+      std::vector<std::pair<std::string, std::string>> methods;
+      for (const std::string& method : helper.GetMethods()) {
+        methods.push_back( {method, helper.GetMethodOptions(method)} );
+      }
+
+      TMVAHelper::Reader reading(inputs, methods);
+      reading.SetOptions({"!Color", "Silent"});
+
+      TMVA::Reader* reader = new TMVA::Reader(reading.CompressOptions().data());
+      reading.ReadVariables(reader, folds.GetHelper());
+      reading.BookMethodsToRead(reader, stem, settings.name);
+
+      // n.b. outputs start with the targets
+      const std::size_t              nTargets = helper.GetTargets().size();
+      const std::vector<std::string> names    = GetOutputs(helper);
+      FeatureCache::Builder          estimates(stem + ".oof.fcache", names, 0, "");
+      std::vector<float>             row(names.size());
+      NTupleBlockReader              blocks(folds.GetSource(fold), settings.block_size);
+      while (blocks.Next()) {
+        reading.EvaluateMethods(reader, folds.GetHelper(), blocks);
+        for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+          for (std::size_t iOut = 0; iOut < names.size(); ++iOut) {
+            row[iOut] = reading.GetColumn(nTargets + iOut)[iRow];
+          }
+          estimates.Append(row);
+        }
+      }
+      delete reader;
+      if (blocks.HasError()) {
+        std::cerr << "PANIC: couldn't read every entry of fold " << fold << "!" << std::endl;
+        return 1;
+      }
+      if (!estimates.Close()) return 1;
+
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: applying fold " << fold << " failed: " << error.what() << std::endl;
+      return 1;
+    }
+
+    std::ofstream result(stem + ".time");
+    result << std::setprecision(10) << time << std::endl;
+    return result.good() ? 0 : 1;
+
+  }  // end 'RunFold(TMVAHelper::Trainer&, Folds&, Settings&, std::size_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train every fold in parallel workers
+  // --------------------------------------------------------------------------
+  /*! The printout of fold i goes to
+   *  '<directory>/fold<i>.log'. Returns which folds
+   *  succeeded.
+   */
+  inline std::vector<bool> RunFolds(
+    const TMVAHelper::Trainer& trainer,
+    Folds& folds,
+    const Settings& settings
+  ) {
+
+    const std::size_t nFolds  = folds.GetNFolds();
+    const std::size_t maxJobs = (settings.jobs > 0) ? settings.jobs : nFolds;
+
+    // make sure trees exist before workers each
+    // make their own
+    gSystem -> mkdir(settings.directory.data(), true);
+    for (std::size_t iFold = 0; iFold < nFolds; ++iFold) {
+      folds.GetTree(iFold);
+    }
+
+    // printout of each fold
+    auto logOf = [&](const std::size_t iFold) {return settings.directory + "/fold" + std::to_string(iFold) + ".log";};
+
+    std::vector<bool> isGood(nFolds, false);
+    ParallelTrain::RunJobs(
+      nFolds,
+      maxJobs,
+      logOf,
+      [&](const std::size_t iFold) {
+        return RunFold(trainer, folds, settings, iFold);
+      },
+      [&](const std::size_t iFold, const ParallelTrain::Outcome outcome, const double) {
+        if (outcome == ParallelTrain::Outcome::Started) {
+          std::cout << "      Started fold " << iFold << " (log: " << logOf(iFold) << ")" << std::endl;
+          return;
+        }
+
+        double        time = 0.;
+        std::ifstream result(settings.directory + "/fold" + std::to_string(iFold) + ".time");
+        isGood[iFold] = (outcome == ParallelTrain::Outcome::Done) && (result >> time);
+        if (isGood[iFold]) {
+          std::cout << "      Finished fold " << iFold << ", trained in " << time << " s" << std::endl;
+        } else {
+          std::cerr << "WARNING: fold " << iFold << " failed! See " << logOf(iFold) << std::endl;
+        }
+      }
+    );
+    return isGood;
+
+  }  // end 'RunFolds(TMVAHelper::Trainer&, Folds&, Settings&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Cross-validate every method of a trainer
+  // --------------------------------------------------------------------------
+  /*! Out-of-fold estimates are written to the tuple
+   *  'ntOutOfFold' in `output`, with the variables of
+   *  the folds, the fold of each event, & an estimate
+   *  per output. Events of failed folds get estimates
+   *  of -max(float), like outputs the Reader skips.
+   *  Returns the scores of each output.
+   */
+  inline std::vector<Result> Run(
+    const TMVAHelper::Trainer& trainer,
+    Folds& folds,
+    const Settings& settings,
+    TFile* output
+  ) {
+
+    if (folds.GetAssignment().empty()) {
+      std::cerr << "WARNING: no events in folds! Not cross-validating." << std::endl;
+      return {};
+    }
+    const std::vector<bool> isGood = RunFolds(trainer, folds, settings);
+
+    // open estimates of each fold
+    const std::size_t                          nFolds = folds.GetNFolds();
+    const std::vector<std::string>             names  = GetOutputs(trainer);
+    std::vector<std::unique_ptr<FeatureCache>> estimates;
+    for (std::size_t iFold = 0; iFold < nFolds; ++iFold) {
+      estimates.push_back( std::make_unique<FeatureCache>() );
+
+      const std::string path = settings.directory + "/fold" + std::to_string(iFold) + ".oof.fcache";
+      const bool        isOpen = isGood[iFold]
+                              && estimates.back() -> Open(path)
+                              && (estimates.back() -> GetRows() == folds.GetCache(iFold).GetRows());
+      if (isGood[iFold] && !isOpen) {
+        std::cerr << "WARNING: couldn't read estimates of fold " << iFold << "!" << std::endl;
+      }
+      if (!isOpen) estimates.back() -> Close();
+    }
+
+    // set up output tuple
+    std::vector<std::string> columns = folds.GetVariables();
+    columns.push_back("fold");
+    columns.insert(columns.end(), names.begin(), names.end());
+
+    NTupleHelper     helper(columns);
+    NTupleIO::Writer writer(helper, output, "ntOutOfFold", "Out-of-fold estimates of cross-validation");
+
+    // pair each estimate with its true value, per fold
+    const std::size_t nVars    = folds.GetVariables().size();
+    const std::size_t nTargets = trainer.GetTargets().size();
+    std::vector<std::vector<std::vector<std::pair<float, float>>>> trueAndReco(
+      names.size(),
+      std::vector<std::vector<std::pair<float, float>>>(nFolds)
+    );
+
+    // walk events in order, taking each from its fold
+    std::vector<uint64_t> positions(nFolds, 0);
+    for (const uint32_t fold : folds.GetAssignment()) {
+
+      const uint64_t            row   = positions[fold]++;
+      const FeatureCache&       cache = folds.GetCache(fold);
+      const FeatureCache&       reco  = *estimates[fold];
+      for (std::size_t iVar = 0; iVar < nVars; ++iVar) {
+        helper.SetVariable(iVar, cache.GetValue(row, iVar));
+      }
+      helper.SetVariable(nVars, fold);
+
+      for (std::size_t iOut = 0; iOut < names.size(); ++iOut) {
+        if (!reco.IsOpen()) {
+          helper.SetVariable(nVars + 1 + iOut, -1. * std::numeric_limits<float>::max());
+          continue;
+        }
+
+        const float truth    = cache.GetValue(row, iOut % nTargets);
+        const float estimate = reco.GetValue(row, iOut);
+        helper.SetVariable(nVars + 1 + iOut, estimate);
+        trueAndReco[iOut][fold].push_back( {truth, estimate} );
+      }
+      writer.Fill();
+    }
+    output -> cd();
+    writer.Write();
+
+    // and score each output
+    std::vector<Result> results;
+    for (std::size_t iOut = 0; iOut < names.size(); ++iOut) {
+
+      Result result;
+      result.output = names[iOut];
+
+      std::vector<std::pair<float, float>> pooled;
+      for (std::size_t iFold = 0; iFold < nFolds; ++iFold) {
+        if (trueAndReco[iOut][iFold].empty()) continue;
+        pooled.insert(pooled.end(), trueAndReco[iOut][iFold].begin(), trueAndReco[iOut][iFold].end());
+
+        const auto [resolution, linearity] = HyperSearch::Measure(trueAndReco[iOut][iFold], settings.bins);
+        result.resolutions.push_back(resolution);
+        result.linearities.push_back(linearity);
+      }
+      std::tie(result.resolution, result.linearity) = HyperSearch::Measure(pooled, settings.bins);
+      results.push_back(result);
+    }
+    return results;
+
+  }  // end 'Run(TMVAHelper::Trainer&, Folds&, Settings&, TFile*)'
+
+}  // end CrossValidate namespace
+
+#endif
+
+// end ========================================================================
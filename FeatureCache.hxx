@@ -0,0 +1,461 @@
+/// ===========================================================================
+/*! \file   FeatureCache.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A class to store a tuple as a flat, memory-mapped
+ *  float matrix so that repeated training and
+ *  application passes skip ROOT decompression.
+ */
+/// ===========================================================================
+
+#ifndef FeatureCache_hxx
+#define FeatureCache_hxx
+
+// c++ utilities
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+// posix utilities
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+
+// ============================================================================
+//! Feature Cache
+// ============================================================================
+/*! A flat matrix of floats (one row per entry, one
+ *  column per variable) preceded by a small header:
+ *
+ *    - magic word & format version,
+ *    - layout (row- or column-major),
+ *    - number of rows & columns,
+ *    - hash identifying the source file (see HashFile),
+ *    - variable names & the cut applied to the source.
+ *
+ *  The data starts on a 64-byte boundary, so the
+ *  whole file can be mapped and read in place.
+ */
+class FeatureCache {
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Storage order of the matrix
+    // ------------------------------------------------------------------------
+    enum Layout : uint32_t {Row, Column};
+
+    // ------------------------------------------------------------------------
+    //! Header at the start of every cache file
+    // ------------------------------------------------------------------------
+    struct Header {
+      char     magic[8]    = {'B', 'H', 'C', 'F', 'C', 'A', 'C', 'H'};
+      uint32_t version     = 1;
+      uint32_t layout      = Layout::Row;
+      uint64_t rows        = 0;
+      uint64_t cols        = 0;
+      uint64_t source_hash = 0;
+      uint64_t names_size  = 0;
+      uint64_t cut_size    = 0;
+      uint64_t data_offset = 0;
+    };
+
+    // current format version
+    static constexpr uint32_t Version = 1;
+
+  private:
+
+    // data members
+    Header                   m_header;
+    std::string              m_path;
+    std::string              m_cut;
+    std::vector<std::string> m_variables;
+    const float*             m_data = nullptr;
+    void*                    m_map  = nullptr;
+    std::size_t              m_size = 0;
+
+  public:
+
+    // ========================================================================
+    //! Cache Builder
+    // ========================================================================
+    /*! Streams rows into a new cache file. Row-major
+     *  caches are written as rows come in; column-major
+     *  ones are held in memory until `Close()`. The file
+     *  is written under a temporary name and moved into
+     *  place at the end, so a cache that's mapped
+     *  elsewhere is never overwritten mid-read.
+     */
+    class Builder {
+
+      private:
+
+        // data members
+        Header                          m_header;
+        std::string                     m_path;
+        std::string                     m_temp;
+        std::ofstream                   m_stream;
+        std::vector<std::vector<float>> m_columns;
+
+      public:
+
+        // ----------------------------------------------------------------------
+        //! Add a row
+        // ----------------------------------------------------------------------
+        /*! Returns false if the row couldn't be written. */
+        inline bool Append(std::span<const float> row) {
+
+          if (m_header.layout == Layout::Column) {
+            for (std::size_t iCol = 0; iCol < m_columns.size(); ++iCol) {
+              m_columns[iCol].push_back(row[iCol]);
+            }
+          } else {
+            m_stream.write((const char*) row.data(), m_header.cols * sizeof(float));
+          }
+          ++m_header.rows;
+          return m_stream.good();
+
+        }  // end 'Append(std::span<const float>)'
+
+        // ----------------------------------------------------------------------
+        //! Drop an unfinished file
+        // ----------------------------------------------------------------------
+        inline void Abort() {
+
+          if (!m_stream.is_open()) return;
+          m_stream.close();
+          std::remove(m_temp.data());
+          return;
+
+        }  // end 'Abort()'
+
+        // ----------------------------------------------------------------------
+        //! Finish file & move it into place
+        // ----------------------------------------------------------------------
+        /*! If anything failed to be written, the file is
+         *  dropped & the one at `path` is left as is.
+         */
+        inline bool Close() {
+
+          if (m_header.layout == Layout::Column) {
+            for (const std::vector<float>& column : m_columns) {
+              m_stream.write((const char*) column.data(), column.size() * sizeof(float));
+            }
+          }
+
+          // update row count in header
+          m_stream.seekp(0);
+          m_stream.write((const char*) &m_header, sizeof(Header));
+          m_stream.close();
+
+          const bool isGood = !m_stream.fail() && (std::rename(m_temp.data(), m_path.data()) == 0);
+          if (!isGood) {
+            std::cerr << "WARNING couldn't write feature cache '" << m_path << "'!" << std::endl;
+            std::remove(m_temp.data());
+          }
+          return isGood;
+
+        }  // end 'Close()'
+
+        // ----------------------------------------------------------------------
+        //! Default ctor/dtor
+        // ----------------------------------------------------------------------
+        /*! A builder that's never closed leaves no file
+         *  behind.
+         */
+        Builder()  {};
+        ~Builder() {Abort();};
+
+        // ----------------------------------------------------------------------
+        //! ctor accepting a path, variables, and a description of the source
+        // ----------------------------------------------------------------------
+        Builder(
+          const std::string& path,
+          const std::vector<std::string>& vars,
+          const uint64_t sourceHash,
+          const std::string& cut,
+          const Layout layout = Layout::Row
+        ) {
+
+          m_path = path;
+          m_temp = path + ".tmp";
+
+          // join variable names
+          std::string names;
+          for (const std::string& var : vars) {
+            names.append(var + "\n");
+          }
+
+          // fill header
+          m_header.layout      = layout;
+          m_header.cols        = vars.size();
+          m_header.source_hash = sourceHash;
+          m_header.names_size  = names.size();
+          m_header.cut_size    = cut.size();
+          m_header.data_offset = ((sizeof(Header) + names.size() + cut.size() + 63) / 64) * 64;
+          if (layout == Layout::Column) {
+            m_columns.resize(vars.size());
+          }
+
+          // and write everything up to the data
+          const std::vector<char> padding(m_header.data_offset - sizeof(Header) - names.size() - cut.size(), 0);
+          m_stream.open(m_temp, std::ios::binary | std::ios::trunc);
+          m_stream.write((const char*) &m_header, sizeof(Header));
+          m_stream.write(names.data(), names.size());
+          m_stream.write(cut.data(), cut.size());
+          m_stream.write(padding.data(), padding.size());
+
+        }  // end ctor(std::string&, std::vector<std::string>&, uint64_t, std::string&, Layout)'
+
+    };  // end FeatureCache::Builder
+
+    // ------------------------------------------------------------------------
+    //! Hash a block of bytes (64-bit FNV-1a)
+    // ------------------------------------------------------------------------
+    static inline uint64_t Hash(const void* data, const std::size_t size, uint64_t hash = 14695981039346656037ULL) {
+
+      const unsigned char* bytes = (const unsigned char*) data;
+      for (std::size_t iByte = 0; iByte < size; ++iByte) {
+        hash ^= bytes[iByte];
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+
+    }  // end 'Hash(void*, std::size_t, uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Get a key identifying a file as it is now
+    // ------------------------------------------------------------------------
+    /*! Made from the canonical path, size, & time of last
+     *  write of the file, so it's cheap to get (unlike a
+     *  hash of the contents) and changes whenever the file
+     *  is rewritten. Returns an empty key if the file
+     *  can't be found.
+     */
+    static inline std::string GetFileKey(const std::string& path) {
+
+      std::error_code             error;
+      const std::filesystem::path canonical = std::filesystem::canonical(path, error);
+      if (error) return "";
+
+      const auto size = std::filesystem::file_size(canonical, error);
+      if (error) return "";
+
+      const auto time = std::filesystem::last_write_time(canonical, error);
+      if (error) return "";
+
+      return canonical.string() + ":" + std::to_string(size) + ":" + std::to_string(time.time_since_epoch().count());
+
+    }  // end 'GetFileKey(std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Hash a file
+    // ------------------------------------------------------------------------
+    /*! By default only the file's key (see GetFileKey)
+     *  is hashed, so this costs next to nothing however
+     *  big the file is. With `doContents` set, every
+     *  byte is hashed instead, e.g. for files that get
+     *  copied around or rewritten with the same size
+     *  and time. Returns 0 if the file can't be read.
+     */
+    static inline uint64_t HashFile(const std::string& path, const bool doContents = false) {
+
+      if (!doContents) {
+        const std::string key = GetFileKey(path);
+        return key.empty() ? 0 : Hash(key.data(), key.size());
+      }
+
+      const int file = open(path.data(), O_RDONLY);
+      if (file < 0) return 0;
+
+      struct stat info;
+      fstat(file, &info);
+
+      uint64_t hash = Hash(&info.st_size, sizeof(info.st_size));
+      if (info.st_size > 0) {
+        void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (map != MAP_FAILED) {
+          madvise(map, info.st_size, MADV_SEQUENTIAL);
+          hash = Hash(map, info.st_size, hash);
+          munmap(map, info.st_size);
+        } else {
+          hash = 0;
+        }
+      }
+      close(file);
+      return hash;
+
+    }  // end 'HashFile(std::string&, bool)'
+
+    // ------------------------------------------------------------------------
+    //! Getters
+    // ------------------------------------------------------------------------
+    inline bool                            IsOpen()        const {return m_data != nullptr;}
+    inline Layout                          GetLayout()     const {return (Layout) m_header.layout;}
+    inline uint64_t                        GetRows()       const {return m_header.rows;}
+    inline uint64_t                        GetCols()       const {return m_header.cols;}
+    inline uint64_t                        GetSourceHash() const {return m_header.source_hash;}
+    inline const std::string&              GetPath()       const {return m_path;}
+    inline const std::string&              GetCut()        const {return m_cut;}
+    inline const std::vector<std::string>& GetVariables()  const {return m_variables;}
+
+    // ------------------------------------------------------------------------
+    //! Get a value
+    // ------------------------------------------------------------------------
+    inline float GetValue(const uint64_t row, const uint64_t col) const {
+
+      return (m_header.layout == Layout::Column)
+        ? m_data[(col * m_header.rows) + row]
+        : m_data[(row * m_header.cols) + col];
+
+    }  // end 'GetValue(uint64_t, uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Get a row (row-major caches only)
+    // ------------------------------------------------------------------------
+    inline std::span<const float> GetRow(const uint64_t row) const {
+
+      return std::span<const float>(m_data + (row * m_header.cols), m_header.cols);
+
+    }  // end 'GetRow(uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Get a column (column-major caches only)
+    // ------------------------------------------------------------------------
+    inline std::span<const float> GetColumn(const uint64_t col) const {
+
+      return std::span<const float>(m_data + (col * m_header.rows), m_header.rows);
+
+    }  // end 'GetColumn(uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Check if cache was made from a given source
+    // ------------------------------------------------------------------------
+    /*! i.e. same format version, same source file
+     *  contents, same variables in the same order,
+     *  and the same cut.
+     */
+    inline bool Matches(
+      const uint64_t sourceHash,
+      const std::vector<std::string>& vars,
+      const std::string& cut
+    ) const {
+
+      return IsOpen()
+        && (m_header.version == Version)
+        && (m_header.source_hash == sourceHash)
+        && (m_variables == vars)
+        && (m_cut == cut);
+
+    }  // end 'Matches(uint64_t, std::vector<std::string>&, std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Unmap the file
+    // ------------------------------------------------------------------------
+    inline void Close() {
+
+      if (m_map) munmap(m_map, m_size);
+      m_map    = nullptr;
+      m_data   = nullptr;
+      m_size   = 0;
+      m_header = Header();
+      m_variables.clear();
+      m_cut.clear();
+      return;
+
+    }  // end 'Close()'
+
+    // ------------------------------------------------------------------------
+    //! Map a cache file
+    // ------------------------------------------------------------------------
+    /*! Returns false (leaving the cache closed) if the
+     *  file doesn't exist or isn't a readable cache.
+     */
+    inline bool Open(const std::string& path) {
+
+      Close();
+      m_path = path;
+
+      const int file = open(path.data(), O_RDONLY);
+      if (file < 0) return false;
+
+      struct stat info;
+      fstat(file, &info);
+      m_size = info.st_size;
+      if (m_size >= sizeof(Header)) {
+        m_map = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+        if (m_map == MAP_FAILED) m_map = nullptr;
+      }
+      close(file);
+      if (!m_map) return false;
+
+      // check header, and that the names, cut, & data
+      // it points to all lie within the file
+      //   - n.b. sizes are compared so that a corrupt
+      //     header can't overflow the sums & product
+      std::memcpy(&m_header, m_map, sizeof(Header));
+      const Header   reference;
+      const uint64_t maxValues = std::numeric_limits<uint64_t>::max() / sizeof(float);
+      const bool     isKnown   = (std::memcmp(m_header.magic, reference.magic, sizeof(reference.magic)) == 0)
+                              && (m_header.version == Version);
+      const bool     isInside  = (m_header.names_size <= m_size)
+                              && (m_header.cut_size <= m_size)
+                              && (m_header.data_offset <= m_size)
+                              && ((sizeof(Header) + m_header.names_size + m_header.cut_size) <= m_header.data_offset)
+                              && ((m_header.cols == 0) || (m_header.rows <= (maxValues / m_header.cols)))
+                              && ((m_header.rows * m_header.cols * sizeof(float)) <= (m_size - m_header.data_offset));
+      if (!isKnown || !isInside) {
+        std::cerr << "WARNING '" << path << "' isn't a usable feature cache!" << std::endl;
+        Close();
+        return false;
+      }
+
+      // grab variable names & cut
+      const char* strings = (const char*) m_map + sizeof(Header);
+      std::string names(strings, m_header.names_size);
+      std::size_t start = 0;
+      for (std::size_t stop = names.find('\n'); stop != std::string::npos; stop = names.find('\n', start)) {
+        m_variables.push_back( names.substr(start, stop - start) );
+        start = stop + 1;
+      }
+      m_cut  = std::string(strings + m_header.names_size, m_header.cut_size);
+      m_data = (const float*) ((const char*) m_map + m_header.data_offset);
+      return true;
+
+    }  // end 'Open(std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Default ctor/dtor
+    // ------------------------------------------------------------------------
+    FeatureCache()  {};
+    ~FeatureCache() {Close();};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a path
+    // ------------------------------------------------------------------------
+    FeatureCache(const std::string& path) {
+
+      Open(path);
+
+    }  // end ctor(std::string&)'
+
+    // caches own their mapping, so no copies
+    FeatureCache(const FeatureCache&) = delete;
+    FeatureCache& operator=(const FeatureCache&) = delete;
+
+};  // end FeatureCache
+
+#endif
+
+// end ========================================================================
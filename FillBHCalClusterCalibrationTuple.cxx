@@ -33,6 +33,8 @@
 #include <edm4hep/Vector3f.h>
 #include <edm4hep/utils/vector_utils.h>
 // analysis utilities
+#include "NTupleClusterSchema.hxx"
+#include "../../utility/NTupleIO.hxx"
 #include "../../utility/NTupleHelper.hxx"
 
 
@@ -50,6 +52,9 @@ struct Options {
   std::string scfi_hits;    // ecal (scfi) hit collection
   std::string image_clust;  // ecal (imaging) cluster/layer collection
   std::string image_hits;   // ecal (imaging) hit collection
+  std::string out_backend;  // output tuple backend ("tree" or "rntuple")
+  std::string out_policy;   // output writer preset ("default", "fastwrite", "smallfile", "fastread")
+  bool        do_reduce;    // store features with reduced precision
   bool        do_progress;  // print progress through frame loop
 } DefaultOptions = {
   "./forNewCalibWorkflow.evt5Ke10pim_central.d14m9y2024.podio.root",
@@ -61,6 +66,9 @@ struct Options {
   "EcalBarrelScFiRecHits",
   "EcalBarrelImagingLayers",
   "EcalBarrelImagingRecHits",
+  "tree",
+  "default",
+  false,
   true
 };
 
@@ -76,59 +84,8 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
   // --------------------------------------------------------------------------
 
   // output variables
-  NTupleHelper helper({
-    "ePar",
-    "fracParVsLeadBHCal",
-    "fracParVsLeadBEMC",
-    "fracParVsSumBHCal",
-    "fracParVsSumBEMC",
-    "fracLeadBHCalVsBEMC",
-    "fracSumBHCalVsBEMC",
-    "eLeadBHCal",
-    "eLeadBEMC",
-    "eSumBHCal",
-    "eSumBEMC",
-    "diffLeadBHCal",
-    "diffLeadBEMC",
-    "diffSumBHCal",
-    "diffSumBEMC",
-    "nHitsLeadBHCal",
-    "nHitsLeadBEMC",
-    "nClustBHCal",
-    "nClustBEMC",
-    "hLeadBHCal",
-    "hLeadBEMC",
-    "fLeadBHCal",
-    "fLeadBEMC",
-    "eLeadImage",
-    "eSumImage",
-    "eLeadScFi",
-    "eSumScFi",
-    "nClustImage",
-    "nClustScFi",
-    "hLeadImage",
-    "hLeadScFi",
-    "fLeadImage",
-    "fLeadScFi",
-    "eSumScFiLayer1",
-    "eSumScFiLayer2",
-    "eSumScFiLayer3",
-    "eSumScFiLayer4",
-    "eSumScFiLayer5",
-    "eSumScFiLayer6",
-    "eSumScFiLayer7",
-    "eSumScFiLayer8",
-    "eSumScFiLayer9",
-    "eSumScFiLayer10",
-    "eSumScFiLayer11",
-    "eSumScFiLayer12",
-    "eSumImageLayer1",
-    "eSumImageLayer2",
-    "eSumImageLayer3",
-    "eSumImageLayer4",
-    "eSumImageLayer5",
-    "eSumImageLayer6"
-  });
+  NTupleHelper helper( NTupleClusterSchema::GetVariables(), NTupleClusterSchema::GetBranches(opt.do_reduce) );
+  using Var = NTupleClusterSchema::Var;
 
   // announce start of macro
   std::cout << "\n  Beginning calibration tuple-filling macro!" << std::endl;
@@ -155,7 +112,14 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
             << std::endl;
 
   // create output ntuple
-  TNtuple* ntForCalib = new TNtuple("ntForCalib", "NTuple for calibration", helper.CompressVariables().c_str());
+  NTupleIO::Writer ntForCalib(
+    helper,
+    output,
+    "ntForCalib",
+    "NTuple for calibration",
+    NTupleIO::ParseBackend(opt.out_backend),
+    NTupleIO::ParsePolicy(opt.out_policy)
+  );
 
   // --------------------------------------------------------------------------
   // Loop over input frames
@@ -209,7 +173,7 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     edm4eic::ReconstructedParticle primary = optPrimary.value();
 
     // set particle output variables
-    helper.SetVariable( "ePar", primary.getEnergy() );
+    helper.SetVariable( Var::ePar, primary.getEnergy() );
 
     // ------------------------------------------------------------------------
     // hcal cluster loop
@@ -230,18 +194,18 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end hcal cluster loop
 
     // fill lead hcal cluster variables
-    helper.SetVariable( "eLeadBHCal", hLeadClust.getEnergy() );
-    helper.SetVariable( "nHitsLeadBHCal", (float) hLeadClust.getHits().size() );
-    helper.SetVariable( "hLeadBHCal", edm4hep::utils::eta(hLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadBHCal", edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
+    helper.SetVariable( Var::eLeadBHCal, hLeadClust.getEnergy() );
+    helper.SetVariable( Var::nHitsLeadBHCal, (float) hLeadClust.getHits().size() );
+    helper.SetVariable( Var::hLeadBHCal, edm4hep::utils::eta(hLeadClust.getPosition()) );
+    helper.SetVariable( Var::fLeadBHCal, edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
 
     // fill event-level output variables
-    helper.SetVariable( "eSumBHCal", eSumHCal);
-    helper.SetVariable( "nClustBHCal", (float) hcalClusters.size());
-    helper.SetVariable( "fracParVsSumBHCal", eSumHCal / primary.getEnergy());
-    helper.SetVariable( "fracParVsLeadBHCal", hLeadClust.getEnergy() / primary.getEnergy());
-    helper.SetVariable( "diffSumBHCal", (eSumHCal - primary.getEnergy()) / primary.getEnergy());
-    helper.SetVariable( "diffLeadBHCal", (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
+    helper.SetVariable( Var::eSumBHCal, eSumHCal);
+    helper.SetVariable( Var::nClustBHCal, (float) hcalClusters.size());
+    helper.SetVariable( Var::fracParVsSumBHCal, eSumHCal / primary.getEnergy());
+    helper.SetVariable( Var::fracParVsLeadBHCal, hLeadClust.getEnergy() / primary.getEnergy());
+    helper.SetVariable( Var::diffSumBHCal, (eSumHCal - primary.getEnergy()) / primary.getEnergy());
+    helper.SetVariable( Var::diffLeadBHCal, (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
 
     // ------------------------------------------------------------------------
     // ecal (scfi + imaging) cluster loop
@@ -262,20 +226,20 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end combined ecal cluster loop
 
     // fill lead ecal cluster variables
-    helper.SetVariable( "eLeadBEMC", eLeadClust.getEnergy() );
-    helper.SetVariable( "nHitsLeadBEMC", (float) eLeadClust.getHits().size() );
-    helper.SetVariable( "hLeadBEMC", edm4hep::utils::eta(eLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadBEMC", edm4hep::utils::angleAzimuthal(eLeadClust.getPosition()) );
+    helper.SetVariable( Var::eLeadBEMC, eLeadClust.getEnergy() );
+    helper.SetVariable( Var::nHitsLeadBEMC, (float) eLeadClust.getHits().size() );
+    helper.SetVariable( Var::hLeadBEMC, edm4hep::utils::eta(eLeadClust.getPosition()) );
+    helper.SetVariable( Var::fLeadBEMC, edm4hep::utils::angleAzimuthal(eLeadClust.getPosition()) );
 
     // fill event-level output variables
-    helper.SetVariable( "eSumBEMC", eSumECal );
-    helper.SetVariable( "nClustBEMC", (float) ecalClusters.size() );
-    helper.SetVariable( "fracParVsSumBEMC", eSumECal / primary.getEnergy() );
-    helper.SetVariable( "fracParVsLeadBEMC", eLeadClust.getEnergy() / primary.getEnergy() );
-    helper.SetVariable( "fracSumBHCalVsBEMC", eSumECal / (eSumECal + eSumHCal) );
-    helper.SetVariable( "fracLeadBHCalVsBEMC", eLeadClust.getEnergy() / (eLeadClust.getEnergy() + hLeadClust.getEnergy()) );
-    helper.SetVariable( "diffSumBEMC", (eSumECal - primary.getEnergy()) / primary.getEnergy() );
-    helper.SetVariable( "diffLeadBEMC", (eLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy() );
+    helper.SetVariable( Var::eSumBEMC, eSumECal );
+    helper.SetVariable( Var::nClustBEMC, (float) ecalClusters.size() );
+    helper.SetVariable( Var::fracParVsSumBEMC, eSumECal / primary.getEnergy() );
+    helper.SetVariable( Var::fracParVsLeadBEMC, eLeadClust.getEnergy() / primary.getEnergy() );
+    helper.SetVariable( Var::fracSumBHCalVsBEMC, eSumECal / (eSumECal + eSumHCal) );
+    helper.SetVariable( Var::fracLeadBHCalVsBEMC, eLeadClust.getEnergy() / (eLeadClust.getEnergy() + hLeadClust.getEnergy()) );
+    helper.SetVariable( Var::diffSumBEMC, (eSumECal - primary.getEnergy()) / primary.getEnergy() );
+    helper.SetVariable( Var::diffLeadBEMC, (eLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy() );
 
     // if no energy in BHCal or BIC, skip event
     const bool isHCalNonzero = (eSumHCal > 0.);
@@ -301,11 +265,11 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end scfi cluster loop
 
     // fill scfi cluster variables
-    helper.SetVariable( "nClustScFi", (float) scfiClusters.size() );
-    helper.SetVariable( "eSumScFi", eSumScFi );
-    helper.SetVariable( "eLeadScFi", sLeadClust.getEnergy() );
-    helper.SetVariable( "hLeadScFi", edm4hep::utils::eta(sLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadScFi", edm4hep::utils::angleAzimuthal(sLeadClust.getPosition()) );
+    helper.SetVariable( Var::nClustScFi, (float) scfiClusters.size() );
+    helper.SetVariable( Var::eSumScFi, eSumScFi );
+    helper.SetVariable( Var::eLeadScFi, sLeadClust.getEnergy() );
+    helper.SetVariable( Var::hLeadScFi, edm4hep::utils::eta(sLeadClust.getPosition()) );
+    helper.SetVariable( Var::fLeadScFi, edm4hep::utils::angleAzimuthal(sLeadClust.getPosition()) );
 
     // loop over scfi hits
     std::map<int32_t, float> mapScFiSumToLayer;
@@ -314,18 +278,9 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end scfi hit loop
 
     // fill scfi layer variables
-    helper.SetVariable( "eSumScFiLayer1", mapScFiSumToLayer[1] );
-    helper.SetVariable( "eSumScFiLayer2", mapScFiSumToLayer[2] );
-    helper.SetVariable( "eSumScFiLayer3", mapScFiSumToLayer[3] );
-    helper.SetVariable( "eSumScFiLayer4", mapScFiSumToLayer[4] );
-    helper.SetVariable( "eSumScFiLayer5", mapScFiSumToLayer[5] );
-    helper.SetVariable( "eSumScFiLayer6", mapScFiSumToLayer[6] );
-    helper.SetVariable( "eSumScFiLayer7", mapScFiSumToLayer[7] );
-    helper.SetVariable( "eSumScFiLayer8", mapScFiSumToLayer[8] );
-    helper.SetVariable( "eSumScFiLayer9", mapScFiSumToLayer[9] );
-    helper.SetVariable( "eSumScFiLayer10", mapScFiSumToLayer[10] );
-    helper.SetVariable( "eSumScFiLayer11", mapScFiSumToLayer[11] );
-    helper.SetVariable( "eSumScFiLayer12", mapScFiSumToLayer[12] );
+    for (std::size_t iLayer = 0; iLayer < NTupleClusterSchema::NScFiLayers; ++iLayer) {
+      helper.SetVariable( Var::eSumScFiLayer1 + iLayer, mapScFiSumToLayer[iLayer + 1] );
+    }
 
     // ------------------------------------------------------------------------
     // imaging cluster loop
@@ -346,11 +301,11 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end imaging cluster loop
 
     // fill imaging cluster variables
-    helper.SetVariable( "nClustImage", (float) imageClusters.size() );
-    helper.SetVariable( "eSumImage", eSumImage );
-    helper.SetVariable( "eLeadImage", iLeadClust.getEnergy() );
-    helper.SetVariable( "hLeadImage", edm4hep::utils::eta(iLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadImage", edm4hep::utils::angleAzimuthal(iLeadClust.getPosition()) );
+    helper.SetVariable( Var::nClustImage, (float) imageClusters.size() );
+    helper.SetVariable( Var::eSumImage, eSumImage );
+    helper.SetVariable( Var::eLeadImage, iLeadClust.getEnergy() );
+    helper.SetVariable( Var::hLeadImage, edm4hep::utils::eta(iLeadClust.getPosition()) );
+    helper.SetVariable( Var::fLeadImage, edm4hep::utils::angleAzimuthal(iLeadClust.getPosition()) );
 
     // loop over scfi hits
     std::map<int32_t, float> mapImageSumToLayer;
@@ -359,24 +314,21 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }  // end scfi hit loop
 
     // fill image layer variables
-    helper.SetVariable( "eSumImageLayer1", mapImageSumToLayer[1] );
-    helper.SetVariable( "eSumImageLayer2", mapImageSumToLayer[2] );
-    helper.SetVariable( "eSumImageLayer3", mapImageSumToLayer[3] );
-    helper.SetVariable( "eSumImageLayer4", mapImageSumToLayer[4] );
-    helper.SetVariable( "eSumImageLayer5", mapImageSumToLayer[5] );
-    helper.SetVariable( "eSumImageLayer6", mapImageSumToLayer[6] );
+    for (std::size_t iLayer = 0; iLayer < NTupleClusterSchema::NImageLayers; ++iLayer) {
+      helper.SetVariable( Var::eSumImageLayer1 + iLayer, mapImageSumToLayer[iLayer + 1] );
+    }
 
     // ------------------------------------------------------------------------
     // fill ntuple
     //  -----------------------------------------------------------------------
-    ntForCalib -> Fill( helper.GetValues().data() );
+    ntForCalib.Fill();
 
   }  // end frame loop
   std::cout << "    Finished frame loop" << std::endl;
 
   // save output & close files
   output     -> cd();
-  ntForCalib -> Write();
+  ntForCalib.Write();
   output     -> Close();
 
   // announce end & exit
@@ -0,0 +1,1126 @@
+/// ===========================================================================
+/*! \file   HistBoost.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A native, multithreaded trainer for gradient-
+ *  boosted regression forests on binned features,
+ *  writing weights TMVA (and NativeModel::Forest)
+ *  read as a BDTG.
+ */
+/// ===========================================================================
+
+#ifndef HistBoost_hxx
+#define HistBoost_hxx
+
+// c++ utilities
+#include <span>
+#include <cmath>
+#include <cctype>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+// root libraries
+#include <TCut.h>
+#include <RVersion.h>
+#include <TSystem.h>
+#include <TXMLEngine.h>
+// tmva components
+#include <TMVA/Version.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "TMVAHelper.hxx"
+#include "NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Histogram Boost
+// ============================================================================
+/*! Trains a least-squares gradient-boosted forest
+ *  the way histogram-based boosters do, instead of
+ *  sorting events at every node like TMVA:
+ *
+ *    - each feature is cut into at most `MaxBins`
+ *      bins at quantiles of (a sample of) its values,
+ *      and every event is stored as one byte per
+ *      feature;
+ *    - a node's best split is found by filling a
+ *      histogram of the residuals per feature & bin
+ *      and scanning it, and only the smaller child of
+ *      a split is filled: the larger one is its
+ *      parent's histogram minus the smaller one's;
+ *    - histograms are filled in fixed-size chunks of
+ *      events on a pool of threads, then summed (&
+ *      scanned) feature by feature in parallel, so
+ *      results don't depend on the no. of threads.
+ *
+ *  Trees are grown level by level to `MaxDepth`, and
+ *  leaves respond with (shrinkage) x sum(residual) /
+ *  (no. of events + lambda). Options follow TMVA's
+ *  BDT where they overlap (NTrees, MaxDepth,
+ *  MinNodeSize, Shrinkage, UseBaggedBoost,
+ *  BaggedSampleFraction); MaxBins, Lambda, NThreads,
+ *  & Seed are added. n.b. TMVA's BDTG uses a Huber
+ *  loss by default, this only does least squares.
+ *
+ *  Weights are written as a TMVA BDT boosted with
+ *  "Grad" (the first tree's boost weight holds the
+ *  initial estimate), so TMVA::Reader, TMVAHelper,
+ *  & NativeModel::Forest read them like any BDTG.
+ */
+namespace HistBoost {
+
+  // --------------------------------------------------------------------------
+  //! Training options
+  // --------------------------------------------------------------------------
+  struct Config {
+    std::size_t trees     = 800;    // no. of trees
+    std::size_t depth     = 3;      // max depth of trees
+    double      min_node  = 5.;     // min % of (sampled) events per leaf
+    double      shrinkage = 0.1;    // learning rate
+    double      lambda    = 0.;     // L2 regularization of leaf responses
+    bool        bagging   = false;  // train each tree on a random sample
+    double      fraction  = 0.6;    // fraction of events sampled
+    std::size_t bins      = 256;    // max no. of bins per feature (<= 256)
+    std::size_t threads   = 0;      // no. of threads (0 = all cores)
+    uint64_t    seed      = 100;    // seed for sampling
+  };
+
+  // --------------------------------------------------------------------------
+  //! Where to write weights
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;                 // name of TMVA process
+    std::string directory;            // tmva directory (name of data loader)
+    std::size_t block_size = 4096;    // no. of entries read at a time
+    std::size_t threads    = 0;       // no. of threads unless set by NThreads (0 = all cores)
+  };
+
+  // --------------------------------------------------------------------------
+  //! Events to train on
+  // --------------------------------------------------------------------------
+  struct Data {
+    std::vector<std::string>        variables;  // training variables
+    std::string                     target;     // regression target
+    std::vector<std::vector<float>> columns;    // values of each variable
+    std::vector<float>              values;     // values of target
+  };
+
+  // --------------------------------------------------------------------------
+  //! A trained tree
+  // --------------------------------------------------------------------------
+  /*! Nodes are stored in the order they're made, with
+   *  a node's children next to each other; an event
+   *  goes to the second child iff x >= cut (i.e. its
+   *  bin is above the split bin).
+   */
+  struct Tree {
+    std::vector<int32_t> feature;   // variable cut on, or -1 for a leaf
+    std::vector<uint8_t> split;     // last bin of first child
+    std::vector<float>   cut;       // cut value
+    std::vector<int32_t> child;     // index of first child
+    std::vector<int32_t> depth;     // depth of node
+    std::vector<double>  response;  // response if it were a leaf
+  };
+
+  // --------------------------------------------------------------------------
+  //! A trained forest
+  // --------------------------------------------------------------------------
+  struct Forest {
+    double            offset = 0.;  // initial estimate
+    std::vector<Tree> trees;
+    double            time   = 0.;  // training time in s
+    uint64_t          events = 0;   // no. of events trained on
+  };
+
+  // --------------------------------------------------------------------------
+  //! Sums of a histogram bin
+  // --------------------------------------------------------------------------
+  struct Bin {
+    double sum   = 0.;  // sum of residuals
+    double count = 0.;  // no. of events
+  };
+
+
+
+  // ==========================================================================
+  //! Thread pool
+  // ==========================================================================
+  /*! Runs tasks 0 to N - 1 on persistent workers (and
+   *  the calling thread), returning once all are done.
+   *  Trees need a few dozen parallel steps each, so
+   *  threads are started once instead of per step.
+   */
+  class Pool {
+
+    private:
+
+      // data members
+      std::vector<std::thread>         m_workers;
+      std::mutex                       m_mutex;
+      std::condition_variable          m_start;
+      std::condition_variable          m_done;
+      std::function<void(std::size_t)> m_task;
+      std::size_t                      m_tasks = 0;
+      std::atomic<std::size_t>         m_next  = 0;
+      std::size_t                      m_busy  = 0;
+      uint64_t                         m_round = 0;
+      bool                             m_stop  = false;
+
+      // ----------------------------------------------------------------------
+      //! Take tasks until there are none left
+      // ----------------------------------------------------------------------
+      inline void Drain() {
+
+        for (std::size_t task = m_next++; task < m_tasks; task = m_next++) {
+          m_task(task);
+        }
+        return;
+
+      }  // end 'Drain()'
+
+      // ----------------------------------------------------------------------
+      //! Loop of a worker
+      // ----------------------------------------------------------------------
+      inline void Work() {
+
+        uint64_t seen = 0;
+        while (true) {
+          {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&]() {return m_stop || (m_round != seen);});
+            if (m_stop) return;
+            seen = m_round;
+          }
+          Drain();
+          {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0) m_done.notify_all();
+          }
+        }
+
+      }  // end 'Work()'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Get no. of threads (including the caller)
+      // ----------------------------------------------------------------------
+      inline std::size_t GetSize() const {return m_workers.size() + 1;}
+
+      // ----------------------------------------------------------------------
+      //! Run tasks
+      // ----------------------------------------------------------------------
+      inline void Run(const std::size_t nTasks, const std::function<void(std::size_t)>& task) {
+
+        if (nTasks == 0) return;
+        if (m_workers.empty() || (nTasks == 1)) {
+          for (std::size_t iTask = 0; iTask < nTasks; ++iTask) task(iTask);
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_task  = task;
+          m_tasks = nTasks;
+          m_next  = 0;
+          m_busy  = m_workers.size();
+          ++m_round;
+        }
+        m_start.notify_all();
+        Drain();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]() {return m_busy == 0;});
+        return;
+
+      }  // end 'Run(std::size_t, std::function<void(std::size_t)>&)'
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a no. of threads (0 = all cores)
+      // ----------------------------------------------------------------------
+      Pool(const std::size_t threads = 0) {
+
+        const std::size_t nThreads = (threads > 0) ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        for (std::size_t iThread = 1; iThread < nThreads; ++iThread) {
+          m_workers.emplace_back([this]() {Work();});
+        }
+
+      }  // end ctor(std::size_t)
+
+      // ----------------------------------------------------------------------
+      //! dtor
+      // ----------------------------------------------------------------------
+      ~Pool() {
+
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_stop = true;
+        }
+        m_start.notify_all();
+        for (std::thread& worker : m_workers) {
+          worker.join();
+        }
+
+      }  // end dtor
+
+  };  // end HistBoost::Pool
+
+
+
+  // --------------------------------------------------------------------------
+  //! Check if a flag is set in a colon-separated list
+  // --------------------------------------------------------------------------
+  /*! i.e. "<flag>" (or "<flag>=True"), the last one
+   *  winning over any "!<flag>".
+   */
+  inline bool HasFlag(const std::string& options, const std::string& flag, const bool fallback = false) {
+
+    bool        isSet = fallback;
+    std::size_t start = 0;
+    while (start <= options.size()) {
+      const std::size_t stop  = std::min(options.find(':', start), options.size());
+      const std::string entry = options.substr(start, stop - start);
+      start = stop + 1;
+
+      if (entry == flag)       isSet = true;
+      if (entry == "!" + flag) isSet = false;
+      if (entry.rfind(flag + "=", 0) == 0) {
+        const char value = entry.size() > flag.size() + 1 ? entry[flag.size() + 1] : 'F';
+        isSet = (value == 'T') || (value == 't') || (value == '1');
+      }
+    }
+    return isSet;
+
+  }  // end 'HasFlag(std::string&, std::string&, bool)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Parse training options
+  // --------------------------------------------------------------------------
+  /*! Options that aren't set keep their value in
+   *  `defaults`.
+   */
+  inline Config ParseConfig(const std::string& options, const Config& defaults = Config()) {
+
+    Config config = defaults;
+    config.trees     = std::stoul( TMVAHelper::GetOption(options, "NTrees", std::to_string(config.trees)) );
+    config.depth     = std::stoul( TMVAHelper::GetOption(options, "MaxDepth", std::to_string(config.depth)) );
+    config.min_node  = std::stod( TMVAHelper::GetOption(options, "MinNodeSize", std::to_string(config.min_node)) );
+    config.shrinkage = std::stod( TMVAHelper::GetOption(options, "Shrinkage", std::to_string(config.shrinkage)) );
+    config.lambda    = std::stod( TMVAHelper::GetOption(options, "Lambda", std::to_string(config.lambda)) );
+    config.bagging   = HasFlag(options, "UseBaggedBoost", config.bagging);
+    config.fraction  = std::stod( TMVAHelper::GetOption(options, "BaggedSampleFraction", std::to_string(config.fraction)) );
+    config.bins      = std::clamp<std::size_t>(std::stoul( TMVAHelper::GetOption(options, "MaxBins", std::to_string(config.bins)) ), 2, 256);
+    config.threads   = std::stoul( TMVAHelper::GetOption(options, "NThreads", std::to_string(config.threads)) );
+    config.seed      = std::stoull( TMVAHelper::GetOption(options, "Seed", std::to_string(config.seed)) );
+    return config;
+
+  }  // end 'ParseConfig(std::string&, Config&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read events passing a cut
+  // --------------------------------------------------------------------------
+  /*! `source` has to provide the target, every
+   *  variable, & the cut. Events are appended to
+   *  `data`, so several sources can be read into it.
+   *  Returns false if the source couldn't be read to
+   *  the end.
+   */
+  inline bool ReadData(
+    NTupleIO::Reader& source,
+    const TCut& cut,
+    Data& data,
+    const std::size_t block_size = 4096
+  ) {
+
+    // map variables onto columns of the source
+    NTupleHelper*            helper = source.GetHelper();
+    std::vector<std::size_t> columns;
+    for (const std::string& var : data.variables) {
+      columns.push_back( helper -> GetIndex(var) );
+    }
+    const std::size_t target = helper -> GetIndex(data.target);
+
+    data.columns.resize(data.variables.size());
+
+    NTupleIO::Selector selector("histSelector", cut, source);
+    NTupleBlockReader  blocks(source, block_size);
+    blocks.SetSelector(selector);
+    while (blocks.Next()) {
+      std::span<const uint8_t> mask   = blocks.GetMask();
+      std::span<const float>   values = blocks.GetColumn(target);
+      for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+        if (mask[iRow]) data.values.push_back(values[iRow]);
+      }
+      for (std::size_t iVar = 0; iVar < columns.size(); ++iVar) {
+        std::span<const float> column = blocks.GetColumn(columns[iVar]);
+        for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+          if (mask[iRow]) data.columns[iVar].push_back(column[iRow]);
+        }
+      }
+    }
+    return !blocks.HasError();
+
+  }  // end 'ReadData(NTupleIO::Reader&, TCut&, Data&, std::size_t)'
+
+
+
+  // ==========================================================================
+  //! Booster
+  // ==========================================================================
+  /*! Holds the binned events & the state of training,
+   *  see above.
+   */
+  class Booster {
+
+    private:
+
+      // events are taken in chunks of this many, so
+      // sums don't depend on the no. of threads
+      static constexpr uint64_t ChunkSize = 16384;
+
+      // histograms are filled in at most this many
+      // blocks of chunks, to bound their memory
+      static constexpr uint64_t MaxBlocks = 256;
+
+      // data members
+      Config                          m_config;
+      Pool                            m_pool;
+      uint64_t                        m_rows     = 0;
+      std::size_t                     m_features = 0;
+      std::size_t                     m_stride   = 0;
+      std::vector<std::vector<float>> m_edges;
+      std::vector<uint8_t>            m_bins;
+      std::vector<float>              m_target;
+      std::vector<double>             m_estimate;
+      std::vector<float>              m_residual;
+      std::vector<uint32_t>           m_rows_in;
+      std::vector<uint32_t>           m_scratch;
+      std::vector<Bin>                m_partials;
+
+      // ----------------------------------------------------------------------
+      //! Get no. of chunks in a range
+      // ----------------------------------------------------------------------
+      static inline std::size_t GetNChunks(const uint64_t nRows) {
+
+        return (nRows + ChunkSize - 1) / ChunkSize;
+
+      }  // end 'GetNChunks(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Bin every feature
+      // ----------------------------------------------------------------------
+      /*! Edges are quantiles of (at most ~100k evenly
+       *  spaced) values; an event's bin is the no. of
+       *  edges at or below its value (NaNs go in the
+       *  first bin, as TMVA sends them left).
+       */
+      inline void MakeBins(const Data& data) {
+
+        m_edges.assign(m_features, {});
+        m_pool.Run(m_features, [&](const std::size_t iFeature) {
+          const std::vector<float>& column = data.columns[iFeature];
+          const uint64_t            step   = std::max<uint64_t>(m_rows / 100000, 1);
+
+          std::vector<float> sample;
+          for (uint64_t iRow = 0; iRow < m_rows; iRow += step) {
+            if (!std::isnan(column[iRow])) sample.push_back(column[iRow]);
+          }
+          std::sort(sample.begin(), sample.end());
+
+          std::vector<float>& edges = m_edges[iFeature];
+          for (std::size_t iEdge = 1; (iEdge < m_config.bins) && !sample.empty(); ++iEdge) {
+            const float edge = sample[(iEdge * sample.size()) / m_config.bins];
+            if ((edge > sample.front()) && (edges.empty() || (edge > edges.back()))) {
+              edges.push_back(edge);
+            }
+          }
+        });
+
+        // then bin events chunk by chunk
+        m_bins.resize(m_features * m_rows);
+        const std::size_t nChunks = GetNChunks(m_rows);
+        m_pool.Run(m_features * nChunks, [&](const std::size_t task) {
+          const std::size_t         iFeature = task / nChunks;
+          const uint64_t            first    = (task % nChunks) * ChunkSize;
+          const uint64_t            stop     = std::min(first + ChunkSize, m_rows);
+          const std::vector<float>& edges    = m_edges[iFeature];
+          const std::vector<float>& column   = data.columns[iFeature];
+          uint8_t* const            bins     = m_bins.data() + (iFeature * m_rows);
+          for (uint64_t iRow = first; iRow < stop; ++iRow) {
+            bins[iRow] = std::isnan(column[iRow]) ? 0 : std::upper_bound(edges.begin(), edges.end(), column[iRow]) - edges.begin();
+          }
+        });
+        return;
+
+      }  // end 'MakeBins(Data&)'
+
+      // ----------------------------------------------------------------------
+      //! Fill histogram of a range of events
+      // ----------------------------------------------------------------------
+      /*! Each block of events fills its own histogram,
+       *  and these are summed in order. Blocks reuse the
+       *  buffer allocated by Train, clearing only their
+       *  own part of it.
+       */
+      inline void Fill(const uint64_t begin, const uint64_t end, std::vector<Bin>& histogram) {
+
+        const uint64_t    nRows   = end - begin;
+        const uint64_t    blockSize = std::max(ChunkSize, ((nRows + MaxBlocks - 1) / MaxBlocks));
+        const std::size_t nBlocks   = (nRows + blockSize - 1) / blockSize;
+        const std::size_t size      = m_features * m_stride;
+
+        histogram.assign(size, Bin());
+        m_pool.Run(nBlocks, [&](const std::size_t iBlock) {
+          Bin* const     partial = m_partials.data() + (iBlock * size);
+          const uint64_t last    = std::min(begin + ((iBlock + 1) * blockSize), end);
+          std::fill_n(partial, size, Bin());
+          for (uint64_t first = begin + (iBlock * blockSize); first < last; first += ChunkSize) {
+            const uint64_t stop = std::min(first + ChunkSize, last);
+            for (std::size_t iFeature = 0; iFeature < m_features; ++iFeature) {
+              const uint8_t* const bins = m_bins.data() + (iFeature * m_rows);
+              Bin* const           hist = partial + (iFeature * m_stride);
+              for (uint64_t iIndex = first; iIndex < stop; ++iIndex) {
+                const uint32_t row = m_rows_in[iIndex];
+                hist[bins[row]].sum   += m_residual[row];
+                hist[bins[row]].count += 1.;
+              }
+            }
+          }
+        });
+
+        // and sum blocks feature by feature
+        m_pool.Run(m_features, [&](const std::size_t iFeature) {
+          for (std::size_t iBlock = 0; iBlock < nBlocks; ++iBlock) {
+            const Bin* const partial = m_partials.data() + (iBlock * size) + (iFeature * m_stride);
+            Bin* const       hist    = histogram.data() + (iFeature * m_stride);
+            for (std::size_t iBin = 0; iBin < m_stride; ++iBin) {
+              hist[iBin].sum   += partial[iBin].sum;
+              hist[iBin].count += partial[iBin].count;
+            }
+          }
+        });
+        return;
+
+      }  // end 'Fill(uint64_t, uint64_t, std::vector<Bin>&)'
+
+      // ----------------------------------------------------------------------
+      //! Split a range of events in place
+      // ----------------------------------------------------------------------
+      /*! Events with bin <= `split` in `feature` come
+       *  first, keeping their order; returns where the
+       *  rest start.
+       */
+      inline uint64_t Partition(const uint64_t begin, const uint64_t end, const int32_t feature, const uint8_t split) {
+
+        const uint8_t* const  bins    = m_bins.data() + (feature * m_rows);
+        const std::size_t     nChunks = GetNChunks(end - begin);
+        std::vector<uint64_t> nLeft(nChunks, 0);
+        m_pool.Run(nChunks, [&](const std::size_t iChunk) {
+          const uint64_t first = begin + (iChunk * ChunkSize);
+          const uint64_t stop  = std::min(first + ChunkSize, end);
+          for (uint64_t iIndex = first; iIndex < stop; ++iIndex) {
+            nLeft[iChunk] += (bins[m_rows_in[iIndex]] <= split);
+          }
+        });
+
+        // find where each chunk's events go
+        std::vector<uint64_t> leftAt(nChunks, begin);
+        std::vector<uint64_t> rightAt(nChunks, begin);
+        for (std::size_t iChunk = 1; iChunk < nChunks; ++iChunk) {
+          leftAt[iChunk]  = leftAt[iChunk - 1] + nLeft[iChunk - 1];
+          rightAt[iChunk] = rightAt[iChunk - 1] + (ChunkSize - nLeft[iChunk - 1]);
+        }
+        const uint64_t middle = leftAt.back() + nLeft.back();
+        for (std::size_t iChunk = 0; iChunk < nChunks; ++iChunk) {
+          rightAt[iChunk] += middle - begin;
+        }
+
+        m_pool.Run(nChunks, [&](const std::size_t iChunk) {
+          const uint64_t first = begin + (iChunk * ChunkSize);
+          const uint64_t stop  = std::min(first + ChunkSize, end);
+          uint64_t       left  = leftAt[iChunk];
+          uint64_t       right = rightAt[iChunk];
+          for (uint64_t iIndex = first; iIndex < stop; ++iIndex) {
+            const uint32_t row = m_rows_in[iIndex];
+            m_scratch[(bins[row] <= split) ? left++ : right++] = row;
+          }
+        });
+        m_pool.Run(nChunks, [&](const std::size_t iChunk) {
+          const uint64_t first = begin + (iChunk * ChunkSize);
+          const uint64_t stop  = std::min(first + ChunkSize, end);
+          std::copy(m_scratch.begin() + first, m_scratch.begin() + stop, m_rows_in.begin() + first);
+        });
+        return middle;
+
+      }  // end 'Partition(uint64_t, uint64_t, int32_t, uint8_t)'
+
+      // ----------------------------------------------------------------------
+      //! Pick events to grow a tree with
+      // ----------------------------------------------------------------------
+      /*! Each event is kept or dropped by a hash of the
+       *  seed, tree, & event, so the sample doesn't
+       *  depend on the no. of threads. Returns the no.
+       *  of events picked.
+       */
+      inline uint64_t Sample(const std::size_t iTree) {
+
+        if (!m_config.bagging || (m_config.fraction >= 1.)) {
+          for (uint64_t iRow = 0; iRow < m_rows; ++iRow) {
+            m_rows_in[iRow] = iRow;
+          }
+          return m_rows;
+        }
+
+        auto isPicked = [&](const uint64_t row) {
+          uint64_t hash = m_config.seed + (0x9E3779B97F4A7C15ULL * (iTree + 1)) + (row * 0xBF58476D1CE4E5B9ULL);
+          hash ^= hash >> 30;
+          hash *= 0xBF58476D1CE4E5B9ULL;
+          hash ^= hash >> 27;
+          hash *= 0x94D049BB133111EBULL;
+          hash ^= hash >> 31;
+          return ((hash >> 11) * 0x1.0p-53) < m_config.fraction;
+        };
+
+        const std::size_t     nChunks = GetNChunks(m_rows);
+        std::vector<uint64_t> nPicked(nChunks, 0);
+        m_pool.Run(nChunks, [&](const std::size_t iChunk) {
+          const uint64_t first = iChunk * ChunkSize;
+          const uint64_t stop  = std::min(first + ChunkSize, m_rows);
+          for (uint64_t iRow = first; iRow < stop; ++iRow) {
+            nPicked[iChunk] += isPicked(iRow);
+          }
+        });
+
+        std::vector<uint64_t> pickedAt(nChunks, 0);
+        for (std::size_t iChunk = 1; iChunk < nChunks; ++iChunk) {
+          pickedAt[iChunk] = pickedAt[iChunk - 1] + nPicked[iChunk - 1];
+        }
+        m_pool.Run(nChunks, [&](const std::size_t iChunk) {
+          const uint64_t first = iChunk * ChunkSize;
+          const uint64_t stop  = std::min(first + ChunkSize, m_rows);
+          uint64_t       at    = pickedAt[iChunk];
+          for (uint64_t iRow = first; iRow < stop; ++iRow) {
+            if (isPicked(iRow)) m_rows_in[at++] = iRow;
+          }
+        });
+        return pickedAt.back() + nPicked.back();
+
+      }  // end 'Sample(std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Find the best split of a node
+      // ----------------------------------------------------------------------
+      /*! Returns (gain, feature, split bin); the feature
+       *  is -1 if no split leaves at least `minCount`
+       *  events on both sides.
+       */
+      inline std::tuple<double, int32_t, uint8_t> FindSplit(const std::vector<Bin>& histogram, const double minCount) {
+
+        std::vector<std::tuple<double, int32_t, uint8_t>> best(m_features, {0., -1, 0});
+        m_pool.Run(m_features, [&](const std::size_t iFeature) {
+          const Bin* const  hist  = histogram.data() + (iFeature * m_stride);
+          const std::size_t nBins = m_edges[iFeature].size() + 1;
+
+          Bin total;
+          for (std::size_t iBin = 0; iBin < nBins; ++iBin) {
+            total.sum   += hist[iBin].sum;
+            total.count += hist[iBin].count;
+          }
+          const double parent = (total.sum * total.sum) / (total.count + m_config.lambda);
+
+          Bin left;
+          for (std::size_t iBin = 0; iBin + 1 < nBins; ++iBin) {
+            left.sum   += hist[iBin].sum;
+            left.count += hist[iBin].count;
+
+            const double rightSum   = total.sum - left.sum;
+            const double rightCount = total.count - left.count;
+            if ((left.count < minCount) || (rightCount < minCount)) continue;
+
+            const double gain = (left.sum * left.sum) / (left.count + m_config.lambda)
+                              + (rightSum * rightSum) / (rightCount + m_config.lambda)
+                              - parent;
+            if (gain > std::get<0>(best[iFeature])) {
+              best[iFeature] = {gain, (int32_t) iFeature, (uint8_t) iBin};
+            }
+          }
+        });
+
+        std::tuple<double, int32_t, uint8_t> split = {0., -1, 0};
+        for (const auto& candidate : best) {
+          if (std::get<0>(candidate) > std::get<0>(split)) split = candidate;
+        }
+        return split;
+
+      }  // end 'FindSplit(std::vector<Bin>&, double)'
+
+      // ----------------------------------------------------------------------
+      //! Grow one tree
+      // ----------------------------------------------------------------------
+      inline Tree Grow(const uint64_t nPicked) {
+
+        // a node waiting to be split
+        struct Open {
+          int32_t          node;
+          uint64_t         begin;
+          uint64_t         end;
+          std::vector<Bin> histogram;
+        };
+
+        const double minCount = std::max(1., (m_config.min_node / 100.) * nPicked);
+        Tree         tree;
+        auto addNode = [&](const int32_t depth, const double sum, const double count) {
+          tree.feature.push_back(-1);
+          tree.split.push_back(0);
+          tree.cut.push_back(0.);
+          tree.child.push_back(-1);
+          tree.depth.push_back(depth);
+          // n.b. an empty node gets no response rather
+          // than 0/0 when lambda is zero
+          const double norm = count + m_config.lambda;
+          tree.response.push_back((norm > 0.) ? m_config.shrinkage * sum / norm : 0.);
+          return (int32_t) tree.feature.size() - 1;
+        };
+
+        std::vector<Open> level(1);
+        level[0].node  = 0;
+        level[0].begin = 0;
+        level[0].end   = nPicked;
+        Fill(0, nPicked, level[0].histogram);
+        {
+          double sum = 0.;
+          for (std::size_t iBin = 0; iBin < m_stride; ++iBin) sum += level[0].histogram[iBin].sum;
+          addNode(0, sum, nPicked);
+        }
+
+        for (std::size_t iDepth = 0; (iDepth < m_config.depth) && !level.empty(); ++iDepth) {
+
+          std::vector<Open> next;
+          for (Open& open : level) {
+
+            const auto [gain, feature, split] = FindSplit(open.histogram, minCount);
+            if (feature < 0) continue;
+
+            // sums of each side from the histogram
+            Bin left;
+            Bin right;
+            const Bin* const hist = open.histogram.data() + (feature * m_stride);
+            for (std::size_t iBin = 0; iBin < m_stride; ++iBin) {
+              Bin& side = (iBin <= split) ? left : right;
+              side.sum   += hist[iBin].sum;
+              side.count += hist[iBin].count;
+            }
+
+            tree.feature[open.node] = feature;
+            tree.split[open.node]   = split;
+            tree.cut[open.node]     = m_edges[feature][split];
+            tree.child[open.node]   = addNode(iDepth + 1, left.sum, left.count);
+            addNode(iDepth + 1, right.sum, right.count);
+
+            // fill the smaller child & subtract it from
+            // its parent for the larger one
+            if (iDepth + 1 >= m_config.depth) continue;
+
+            const uint64_t middle = Partition(open.begin, open.end, feature, split);
+
+            Open first  = {tree.child[open.node], open.begin, middle, {}};
+            Open second = {tree.child[open.node] + 1, middle, open.end, {}};
+            Open& small = ((middle - open.begin) <= (open.end - middle)) ? first : second;
+            Open& large = ((middle - open.begin) <= (open.end - middle)) ? second : first;
+            Fill(small.begin, small.end, small.histogram);
+            large.histogram = std::move(open.histogram);
+            for (std::size_t iBin = 0; iBin < large.histogram.size(); ++iBin) {
+              large.histogram[iBin].sum   -= small.histogram[iBin].sum;
+              large.histogram[iBin].count -= small.histogram[iBin].count;
+            }
+            next.push_back(std::move(first));
+            next.push_back(std::move(second));
+          }
+          level = std::move(next);
+        }
+        return tree;
+
+      }  // end 'Grow(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Add a tree to the estimates & update residuals
+      // ----------------------------------------------------------------------
+      inline void Update(const Tree& tree) {
+
+        m_pool.Run(GetNChunks(m_rows), [&](const std::size_t iChunk) {
+          const uint64_t first = iChunk * ChunkSize;
+          const uint64_t stop  = std::min(first + ChunkSize, m_rows);
+          for (uint64_t iRow = first; iRow < stop; ++iRow) {
+            int32_t node = 0;
+            while (tree.feature[node] >= 0) {
+              node = tree.child[node] + (m_bins[(tree.feature[node] * m_rows) + iRow] > tree.split[node]);
+            }
+            m_estimate[iRow] += tree.response[node];
+            m_residual[iRow]  = m_target[iRow] - m_estimate[iRow];
+          }
+        });
+        return;
+
+      }  // end 'Update(Tree&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Train a forest
+      // ----------------------------------------------------------------------
+      /*! n.b. residuals are minus the gradient of the
+       *  squared error, so leaves step along them.
+       */
+      inline Forest Train(const Data& data) {
+
+        const auto start = std::chrono::steady_clock::now();
+
+        m_rows     = data.values.size();
+        m_features = data.variables.size();
+        m_stride   = m_config.bins;
+        if ((m_rows == 0) || (m_rows > std::numeric_limits<uint32_t>::max())) {
+          std::cerr << "WARNING: can't train on " << m_rows << " events!" << std::endl;
+          return Forest();
+        }
+        MakeBins(data);
+
+        // blocks hold at least a chunk, so a fill never
+        // needs more partial histograms than this
+        const std::size_t nBlocks = std::min<std::size_t>(GetNChunks(m_rows), MaxBlocks);
+        m_partials.assign(nBlocks * m_features * m_stride, Bin());
+
+        // start from the mean target
+        Forest forest;
+        forest.events = m_rows;
+        m_target      = data.values;
+        for (const float value : m_target) {
+          forest.offset += value;
+        }
+        forest.offset /= m_rows;
+
+        m_estimate.assign(m_rows, forest.offset);
+        m_residual.resize(m_rows);
+        for (uint64_t iRow = 0; iRow < m_rows; ++iRow) {
+          m_residual[iRow] = m_target[iRow] - forest.offset;
+        }
+        m_rows_in.resize(m_rows);
+        m_scratch.resize(m_rows);
+
+        // then boost
+        //   - n.b. a tree bagging no events is skipped
+        for (std::size_t iTree = 0; iTree < m_config.trees; ++iTree) {
+          const uint64_t nPicked = Sample(iTree);
+          if (nPicked == 0) continue;
+          forest.trees.push_back( Grow(nPicked) );
+          Update(forest.trees.back());
+        }
+
+        forest.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return forest;
+
+      }  // end 'Train(Data&)'
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a config
+      // ----------------------------------------------------------------------
+      Booster(const Config& config) : m_config(config), m_pool(config.threads) {};
+      ~Booster() {};
+
+  };  // end HistBoost::Booster
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print a number at a given precision
+  // --------------------------------------------------------------------------
+  inline std::string ToString(const double value, const int precision = 17) {
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    return std::string(buffer);
+
+  }  // end 'ToString(double, int)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Add a variable (or target) to a weights header
+  // --------------------------------------------------------------------------
+  /*! TMVA's internal name of an expression replaces
+   *  anything that isn't alphanumeric with '_'.
+   */
+  inline void AddVariable(
+    TXMLEngine& xml,
+    XMLNodePointer_t parent,
+    const std::string& type,
+    const std::size_t index,
+    const std::string& expression,
+    std::span<const float> values
+  ) {
+
+    std::string internal = expression;
+    for (char& letter : internal) {
+      if (!std::isalnum((unsigned char) letter)) letter = '_';
+    }
+
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    for (const float value : values) {
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+    if (values.empty()) {
+      min = 0.;
+      max = 0.;
+    }
+
+    XMLNodePointer_t node = xml.NewChild(parent, nullptr, type.data());
+    xml.NewAttr(node, nullptr, (type == "Target" ? "TargetIndex" : "VarIndex"), std::to_string(index).data());
+    xml.NewAttr(node, nullptr, "Expression", expression.data());
+    xml.NewAttr(node, nullptr, "Label", expression.data());
+    xml.NewAttr(node, nullptr, "Title", expression.data());
+    xml.NewAttr(node, nullptr, "Unit", "");
+    xml.NewAttr(node, nullptr, "Internal", internal.data());
+    xml.NewAttr(node, nullptr, "Type", "F");
+    xml.NewAttr(node, nullptr, "Min", ToString(min, 9).data());
+    xml.NewAttr(node, nullptr, "Max", ToString(max, 9).data());
+    return;
+
+  }  // end 'AddVariable(TXMLEngine&, XMLNodePointer_t, std::string&, std::size_t, std::string&, std::span<const float>)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Add a node (and everything below it) to a tree
+  // --------------------------------------------------------------------------
+  /*! Nodes cut with cType = 1, i.e. events go right
+   *  iff x >= cut, the same as when binned.
+   */
+  inline void AddNode(
+    TXMLEngine& xml,
+    XMLNodePointer_t parent,
+    const Tree& tree,
+    const int32_t index,
+    const std::string& pos
+  ) {
+
+    const bool isLeaf = (tree.feature[index] < 0);
+
+    XMLNodePointer_t node = xml.NewChild(parent, nullptr, "Node");
+    xml.NewAttr(node, nullptr, "pos", pos.data());
+    xml.NewAttr(node, nullptr, "depth", std::to_string(tree.depth[index]).data());
+    xml.NewAttr(node, nullptr, "NCoef", "0");
+    xml.NewAttr(node, nullptr, "IVar", std::to_string(tree.feature[index]).data());
+    xml.NewAttr(node, nullptr, "Cut", ToString(tree.cut[index], 9).data());
+    xml.NewAttr(node, nullptr, "cType", "1");
+    xml.NewAttr(node, nullptr, "res", ToString(tree.response[index]).data());
+    xml.NewAttr(node, nullptr, "rms", "0");
+    xml.NewAttr(node, nullptr, "purity", "0");
+    xml.NewAttr(node, nullptr, "nType", isLeaf ? "1" : "0");
+    if (isLeaf) return;
+
+    AddNode(xml, node, tree, tree.child[index], "l");
+    AddNode(xml, node, tree, tree.child[index] + 1, "r");
+    return;
+
+  }  // end 'AddNode(TXMLEngine&, XMLNodePointer_t, Tree&, int32_t, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write a forest as a TMVA BDT weights file
+  // --------------------------------------------------------------------------
+  /*! Only options TMVA's BDT knows are written, so
+   *  TMVA::Reader can book the file as a BDT.
+   */
+  inline bool WriteWeights(
+    const std::string& path,
+    const std::string& method,
+    const Data& data,
+    const Config& config,
+    const Forest& forest
+  ) {
+
+    TXMLEngine       xml;
+    XMLDocPointer_t  doc  = xml.NewDoc();
+    XMLNodePointer_t root = xml.NewChild(nullptr, nullptr, "MethodSetup");
+    xml.NewAttr(root, nullptr, "Method", ("BDT::" + method).data());
+    xml.DocSetRootElement(doc, root);
+
+    // general info
+    XMLNodePointer_t info = xml.NewChild(root, nullptr, "GeneralInfo");
+    auto addInfo = [&](const std::string& name, const std::string& value) {
+      XMLNodePointer_t entry = xml.NewChild(info, nullptr, "Info");
+      xml.NewAttr(entry, nullptr, "name", name.data());
+      xml.NewAttr(entry, nullptr, "value", value.data());
+    };
+    addInfo("TMVA Release", std::string(TMVA_RELEASE) + " [" + std::to_string(TMVA_VERSION_CODE) + "]");
+    addInfo("ROOT Release", std::string(ROOT_RELEASE) + " [" + std::to_string(ROOT_VERSION_CODE) + "]");
+    addInfo("Creator", "HistBoost");
+    addInfo("Training events", std::to_string(forest.events));
+    addInfo("TrainingTime", ToString(forest.time));
+    addInfo("AnalysisType", "Regression");
+
+    // options
+    XMLNodePointer_t options = xml.NewChild(root, nullptr, "Options");
+    auto addOption = [&](const std::string& name, const std::string& value) {
+      XMLNodePointer_t option = xml.NewChild(options, nullptr, "Option", value.data());
+      xml.NewAttr(option, nullptr, "name", name.data());
+      xml.NewAttr(option, nullptr, "modified", "Yes");
+    };
+    addOption("NTrees", std::to_string(forest.trees.size()));
+    addOption("MaxDepth", std::to_string(config.depth));
+    addOption("MinNodeSize", ToString(config.min_node, 6) + "%");
+    addOption("BoostType", "Grad");
+    addOption("Shrinkage", ToString(config.shrinkage, 6));
+    addOption("UseBaggedBoost", config.bagging ? "True" : "False");
+    addOption("BaggedSampleFraction", ToString(config.fraction, 6));
+
+    // variables, spectators, classes, & targets
+    XMLNodePointer_t variables = xml.NewChild(root, nullptr, "Variables");
+    xml.NewAttr(variables, nullptr, "NVar", std::to_string(data.variables.size()).data());
+    for (std::size_t iVar = 0; iVar < data.variables.size(); ++iVar) {
+      AddVariable(xml, variables, "Variable", iVar, data.variables[iVar], data.columns[iVar]);
+    }
+
+    XMLNodePointer_t spectators = xml.NewChild(root, nullptr, "Spectators");
+    xml.NewAttr(spectators, nullptr, "NSpec", "0");
+
+    XMLNodePointer_t classes = xml.NewChild(root, nullptr, "Classes");
+    xml.NewAttr(classes, nullptr, "NClass", "1");
+    XMLNodePointer_t regression = xml.NewChild(classes, nullptr, "Class");
+    xml.NewAttr(regression, nullptr, "Name", "Regression");
+    xml.NewAttr(regression, nullptr, "Index", "0");
+
+    XMLNodePointer_t targets = xml.NewChild(root, nullptr, "Targets");
+    xml.NewAttr(targets, nullptr, "NTrgt", "1");
+    AddVariable(xml, targets, "Target", 0, data.target, data.values);
+
+    XMLNodePointer_t transforms = xml.NewChild(root, nullptr, "Transformations");
+    xml.NewAttr(transforms, nullptr, "NTransformations", "0");
+    xml.NewChild(root, nullptr, "MVAPdfs");
+
+    // and finally the trees: the first one's boost
+    // weight is the initial estimate
+    XMLNodePointer_t weights = xml.NewChild(root, nullptr, "Weights");
+    xml.NewAttr(weights, nullptr, "NTrees", std::to_string(forest.trees.size()).data());
+    xml.NewAttr(weights, nullptr, "AnalysisType", "1");
+    for (std::size_t iTree = 0; iTree < forest.trees.size(); ++iTree) {
+      XMLNodePointer_t tree = xml.NewChild(weights, nullptr, "BinaryTree");
+      xml.NewAttr(tree, nullptr, "type", "DecisionTree");
+      xml.NewAttr(tree, nullptr, "boostWeight", (iTree == 0 ? ToString(forest.offset) : std::string("1")).data());
+      xml.NewAttr(tree, nullptr, "itree", std::to_string(iTree).data());
+      AddNode(xml, tree, forest.trees[iTree], 0, "s");
+    }
+
+    // write to a temporary file first so an existing
+    // file is never left half-written
+    const std::string temp = path + ".tmp";
+    xml.SaveDoc(doc, temp.data());
+    xml.FreeDoc(doc);
+    return std::rename(temp.data(), path.data()) == 0;
+
+  }  // end 'WriteWeights(std::string&, std::string&, Data&, Config&, Forest&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train a method natively
+  // --------------------------------------------------------------------------
+  /*! Trains on every event of `sources` passing `cut`
+   *  (n.b. TMVA's train/test split isn't applied, so
+   *  pass a prepared training set to hold events out),
+   *  and writes '<directory>/weights/<name>_<method>
+   *  .weights.xml'. Returns the path of the weights,
+   *  or an empty string if training failed.
+   */
+  inline std::string Run(
+    const TMVAHelper::Trainer& helper,
+    const std::vector<NTupleIO::Reader*>& sources,
+    const TCut& cut,
+    const Settings& settings,
+    const std::string& method
+  ) {
+
+    if (helper.GetTargets().size() != 1) {
+      std::cerr << "WARNING: " << method << " only trains on a single target!" << std::endl;
+      return "";
+    }
+
+    Config defaults;
+    defaults.threads = settings.threads;
+
+    const Config config = ParseConfig(helper.GetMethodOptions(method), defaults);
+
+    Data data;
+    data.variables = helper.GetTrainers();
+    data.target    = helper.GetTargets().front();
+    for (NTupleIO::Reader* source : sources) {
+      if (!ReadData(*source, cut, data, settings.block_size)) {
+        std::cerr << "WARNING: couldn't read every event to train " << method << " on!" << std::endl;
+        return "";
+      }
+    }
+    if (data.values.empty()) {
+      std::cerr << "WARNING: no events to train " << method << " on!" << std::endl;
+      return "";
+    }
+
+    Booster      booster(config);
+    const Forest forest = booster.Train(data);
+    if (forest.trees.empty()) return "";
+
+    const std::string directory = settings.directory + "/weights";
+    const std::string path      = directory + "/" + settings.name + "_" + method + ".weights.xml";
+    gSystem -> mkdir(directory.data(), true);
+    if (!WriteWeights(path, method, data, config, forest)) {
+      std::cerr << "WARNING: couldn't write weights of " << method << " to '" << path << "'!" << std::endl;
+      return "";
+    }
+
+    std::cout << "      Trained " << method << ": " << forest.trees.size() << " trees on "
+              << forest.events << " events in " << forest.time << " s."
+              << std::endl;
+    return path;
+
+  }  // end 'Run(TMVAHelper::Trainer&, std::vector<NTupleIO::Reader*>&, TCut&, Settings&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train a method natively on a single source
+  // --------------------------------------------------------------------------
+  inline std::string Run(
+    const TMVAHelper::Trainer& helper,
+    NTupleIO::Reader& source,
+    const TCut& cut,
+    const Settings& settings,
+    const std::string& method
+  ) {
+
+    return Run(helper, std::vector<NTupleIO::Reader*>{&source}, cut, settings, method);
+
+  }  // end 'Run(TMVAHelper::Trainer&, NTupleIO::Reader&, TCut&, Settings&, std::string&)'
+
+}  // end HistBoost namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,684 @@
+/// ===========================================================================
+/*! \file   HyperSearch.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to search the options of TMVA methods
+ *  (grid, random, or successive halving) with trials
+ *  run in parallel worker processes.
+ */
+/// ===========================================================================
+
+#ifndef HyperSearch_hxx
+#define HyperSearch_hxx
+
+// c++ utilities
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+// root libraries
+#include <TFile.h>
+#include <TSystem.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "TMVAHelper.hxx"
+#include "ParallelTrain.hxx"
+#include "PreparedDataset.hxx"
+#include "NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Hyperparameter Search
+// ============================================================================
+/*! Each trial trains one method with one set of
+ *  options in a forked process (see ParallelTrain.hxx
+ *  for why), on the events of a PreparedDataset so
+ *  every trial sees the same split. The trained
+ *  weights are then applied to all of the testing
+ *  events, and the trial is scored by
+ *
+ *    score = resolution + (weight) x non-linearity,
+ *
+ *  where the testing events are sorted into bins of
+ *  equal population in the (first) target, and
+ *
+ *    resolution    = < RMS(reco) / mean(reco) >,
+ *    non-linearity = < |mean(reco) / mean(true) - 1| >,
+ *
+ *  averaged over the bins. Lower is better.
+ *
+ *  Trials "clearly worse" than the rest are stopped
+ *  early by training everything on part of the
+ *  training events first: with successive halving,
+ *  only the best 1/eta of each round moves on to eta
+ *  times as many events; with a grid or random search
+ *  and a screening fraction, only trials scoring
+ *  within a factor of the best screened one are
+ *  trained on all events. Trials still running when
+ *  the time budget runs out are killed.
+ */
+namespace HyperSearch {
+
+  // --------------------------------------------------------------------------
+  //! Search strategies
+  // --------------------------------------------------------------------------
+  enum class Strategy {Grid, Random, Halving};
+
+  // --------------------------------------------------------------------------
+  //! Outcomes of a trial
+  // --------------------------------------------------------------------------
+  enum class Status {Pending, Done, Stopped, Failed, TimedOut, Skipped};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Values to try for one option of a method
+  // --------------------------------------------------------------------------
+  struct Parameter {
+    std::string              name;    // option name, e.g. "NTrees"
+    std::vector<std::string> values;  // values to try, e.g. {"500", "1000"}
+  };
+
+  // --------------------------------------------------------------------------
+  //! Parameter space of a method
+  // --------------------------------------------------------------------------
+  /*! Options not searched over are taken from the
+   *  method's options in the trainer.
+   */
+  struct Space {
+    std::string            method;      // method name, e.g. "BDTG"
+    std::vector<Parameter> parameters;  // options to search over
+  };
+
+  // --------------------------------------------------------------------------
+  //! How to run the search
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;                          // name of TMVA process
+    std::string directory;                     // directory to run trials in
+    Strategy    strategy   = Strategy::Grid;   // how to pick trials
+    std::size_t trials     = 20;               // no. of configurations per method (random)
+    uint64_t    seed       = 12345;            // seed for random search
+    std::size_t jobs       = 1;                // max no. of trials at once
+    double      budget     = 0.;               // wall-clock budget in s (0 = none)
+    double      screen     = 0.;               // fraction of training events to screen on (grid/random, 0 = off)
+    double      stop       = 1.5;              // stop trials scoring worse than this x best screened score
+    std::size_t eta        = 3;                // halving: keep 1/eta of trials, give them eta x events
+    uint64_t    min_events = 0;                // halving: training events of first round (0 = auto)
+    std::size_t bins       = 10;               // no. of target bins to score in
+    double      linearity  = 1.;               // weight of non-linearity in score
+    std::size_t block_size = 4096;             // no. of testing events evaluated at a time
+    float       weight     = 1.0;              // weight of trees
+  };
+
+  // --------------------------------------------------------------------------
+  //! A single training of a method
+  // --------------------------------------------------------------------------
+  struct Trial {
+    std::size_t                                      id         = 0;                 // trial no.
+    std::size_t                                      config     = 0;                 // configuration no. (within method)
+    std::size_t                                      round      = 0;                 // round of search
+    std::string                                      method;                         // method trained
+    std::vector<std::pair<std::string, std::string>> values;                         // searched option values
+    std::string                                      options;                        // full method options
+    uint64_t                                         events     = 0;                 // no. of training events (0 = all)
+    Status                                           status     = Status::Pending;  // outcome
+    double                                           resolution = 0.;                // resolution on testing events
+    double                                           linearity  = 0.;                // non-linearity on testing events
+    double                                           score      = std::numeric_limits<double>::max();  // score (lower is better)
+    double                                           time       = 0.;                // training time in s
+  };
+
+
+
+  // --------------------------------------------------------------------------
+  //! Turn a string into a search strategy
+  // --------------------------------------------------------------------------
+  inline Strategy ParseStrategy(const std::string& name) {
+
+    if (name == "grid")    return Strategy::Grid;
+    if (name == "random")  return Strategy::Random;
+    if (name == "halving") return Strategy::Halving;
+
+    std::cerr << "WARNING: unknown search strategy '" << name << "'! Using grid search." << std::endl;
+    return Strategy::Grid;
+
+  }  // end 'ParseStrategy(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Turn a trial status into a string
+  // --------------------------------------------------------------------------
+  inline std::string GetStatusName(const Status status) {
+
+    switch (status) {
+      case Status::Done:     return "done";
+      case Status::Stopped:  return "stopped";
+      case Status::Failed:   return "failed";
+      case Status::TimedOut: return "timeout";
+      case Status::Skipped:  return "skipped";
+      case Status::Pending:
+        [[fallthrough]];
+      default:
+        return "pending";
+    }
+
+  }  // end 'GetStatusName(Status)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get configurations of a parameter space to try
+  // --------------------------------------------------------------------------
+  /*! Configurations are numbered like the digits of a
+   *  mixed-radix number (last parameter fastest). A
+   *  grid search takes every one, a random search
+   *  draws `settings.trials` distinct ones (or all of
+   *  them if there aren't more).
+   */
+  inline std::vector<std::vector<std::pair<std::string, std::string>>> GetConfigs(
+    const Space& space,
+    const Settings& settings
+  ) {
+
+    uint64_t nConfigs = 1;
+    for (const Parameter& parameter : space.parameters) {
+      nConfigs *= std::max<std::size_t>(parameter.values.size(), 1);
+    }
+
+    // pick which configurations to try
+    std::vector<uint64_t> picks;
+    if ((settings.strategy == Strategy::Random) && (settings.trials < nConfigs)) {
+      std::mt19937_64 engine(settings.seed);
+      while (picks.size() < settings.trials) {
+        const uint64_t pick = engine() % nConfigs;
+        if (std::find(picks.begin(), picks.end(), pick) == picks.end()) picks.push_back(pick);
+      }
+    } else {
+      for (uint64_t iConfig = 0; iConfig < nConfigs; ++iConfig) {
+        picks.push_back(iConfig);
+      }
+    }
+
+    // and decode them
+    std::vector<std::vector<std::pair<std::string, std::string>>> configs;
+    for (uint64_t pick : picks) {
+      std::vector<std::pair<std::string, std::string>> config(space.parameters.size());
+      for (std::size_t iPar = space.parameters.size(); iPar > 0; --iPar) {
+        const Parameter&  parameter = space.parameters[iPar - 1];
+        const std::size_t nValues   = parameter.values.size();
+        if (nValues == 0) continue;
+
+        config[iPar - 1] = {parameter.name, parameter.values[pick % nValues]};
+        pick /= nValues;
+      }
+      configs.push_back(config);
+    }
+    return configs;
+
+  }  // end 'GetConfigs(Space&, Settings&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Measure resolution & non-linearity
+  // --------------------------------------------------------------------------
+  /*! Takes pairs of (true, reconstructed) values and
+   *  returns (resolution, non-linearity), see above.
+   */
+  inline std::pair<double, double> Measure(
+    std::vector<std::pair<float, float>>& trueAndReco,
+    const std::size_t bins
+  ) {
+
+    std::sort(trueAndReco.begin(), trueAndReco.end());
+
+    const std::size_t nValues = trueAndReco.size();
+    const std::size_t nBins   = std::min(std::max<std::size_t>(bins, 1), nValues);
+    if (nBins == 0) return {0., 0.};
+
+    double resolution = 0.;
+    double linearity  = 0.;
+    for (std::size_t iBin = 0; iBin < nBins; ++iBin) {
+      const std::size_t first = (iBin * nValues) / nBins;
+      const std::size_t stop  = ((iBin + 1) * nValues) / nBins;
+
+      double sumTrue = 0.;
+      double sumReco = 0.;
+      double sumReco2 = 0.;
+      for (std::size_t iValue = first; iValue < stop; ++iValue) {
+        sumTrue  += trueAndReco[iValue].first;
+        sumReco  += trueAndReco[iValue].second;
+        sumReco2 += trueAndReco[iValue].second * trueAndReco[iValue].second;
+      }
+
+      const double nInBin   = stop - first;
+      const double meanTrue = sumTrue / nInBin;
+      const double meanReco = sumReco / nInBin;
+      const double rmsReco  = std::sqrt(std::max((sumReco2 / nInBin) - (meanReco * meanReco), 0.));
+      if (meanReco != 0.) resolution += rmsReco / std::abs(meanReco);
+      if (meanTrue != 0.) linearity  += std::abs((meanReco / meanTrue) - 1.);
+    }
+    return {resolution / nBins, linearity / nBins};
+
+  }  // end 'Measure(std::vector<std::pair<float, float>>&, std::size_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train & score a single trial
+  // --------------------------------------------------------------------------
+  /*! Runs inside a worker, in `settings.directory`:
+   *  weights go to 'trial<id>/weights', and the
+   *  resolution, non-linearity, & training time are
+   *  written to 'trial<id>.result'. Returns the exit
+   *  status of the worker.
+   */
+  inline int RunTrial(
+    const TMVAHelper::Trainer& trainer,
+    PreparedDataset& prepared,
+    const Settings& settings,
+    const Trial& trial
+  ) {
+
+    gSystem -> ChangeDirectory(settings.directory.data());
+
+    const std::string stem   = "trial" + std::to_string(trial.id);
+    TFile*            output = TFile::Open((stem + ".root").data(), "recreate");
+    if (!output || output -> IsZombie()) return 1;
+
+    // train only this method with this trial's options
+    TMVAHelper::Trainer helper = trainer;
+    helper.SetMethodOptions(trial.method, trial.options);
+
+    TMVA::Tools::Instance();
+    TMVA::Factory*    factory = new TMVA::Factory(settings.name.data(), output, helper.CompressFactoryOptions().data());
+    TMVA::DataLoader* loader  = new TMVA::DataLoader(stem.data());
+    double            time    = 0.;
+    bool              isGood  = true;
+    try {
+      helper.LoadVariables(loader);
+      prepared.LoadTrees(loader, settings.weight, trial.events);
+      helper.BookMethodToTrain(factory, loader, trial.method);
+
+      const auto start = std::chrono::steady_clock::now();
+      factory -> TrainAllMethods();
+      time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: training trial " << trial.id << " failed: " << error.what() << std::endl;
+      isGood = false;
+    }
+
+    output -> Close();
+    delete factory;
+    delete loader;
+    if (!isGood) return 1;
+
+    std::vector<std::pair<float, float>> trueAndReco;
+    try {
+
+      // then apply it to the testing events
+      std::vector<std::pair<TMVAHelper::Use, std::string>> inputs;
+      for (const std::string& target : helper.GetTargets()) {
+        inputs.push_back( {TMVAHelper::Use::Target, target} );
+      }
+      for (const std::string& train : helper.GetTrainers()) {
+        inputs.push_back( {TMVAHelper::Use::Train, train} );
+      }
+
+      TMVAHelper::Reader reading(inputs, {{trial.method, trial.options}});
+      reading.SetOptions({"!Color", "Silent"});
+
+      TMVA::Reader* reader = new TMVA::Reader(reading.CompressOptions().data());
+      reading.ReadVariables(reader, prepared.GetHelper());
+      reading.BookMethodsToRead(reader, stem, settings.name);
+
+      // n.b. outputs start with the targets, so the
+      // first target is column 0 & its estimate follows
+      // the last target
+      const std::size_t nTargets = helper.GetTargets().size();
+      NTupleBlockReader blocks(prepared.GetTestSource(), settings.block_size);
+      while (blocks.Next()) {
+        reading.EvaluateMethods(reader, prepared.GetHelper(), blocks);
+        std::span<const float> truth    = reading.GetColumn(0);
+        std::span<const float> estimate = reading.GetColumn(nTargets);
+        for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+          trueAndReco.push_back( {truth[iRow], estimate[iRow]} );
+        }
+      }
+      delete reader;
+      if (blocks.HasError()) {
+        std::cerr << "PANIC: couldn't read every test entry of trial " << trial.id << "!" << std::endl;
+        return 1;
+      }
+
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: applying trial " << trial.id << " failed: " << error.what() << std::endl;
+      return 1;
+    }
+    if (trueAndReco.empty()) return 1;
+
+    const auto    [resolution, linearity] = Measure(trueAndReco, settings.bins);
+    std::ofstream result(stem + ".result");
+    result << std::setprecision(10) << resolution << " " << linearity << " " << time << std::endl;
+    return result.good() ? 0 : 1;
+
+  }  // end 'RunTrial(TMVAHelper::Trainer&, PreparedDataset&, Settings&, Trial&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Run a batch of trials in parallel workers
+  // --------------------------------------------------------------------------
+  /*! Workers are only started before `deadline`, and
+   *  any still running at it are killed. The printout
+   *  of trial X goes to '<directory>/trialX.log'.
+   */
+  inline void RunTrials(
+    const TMVAHelper::Trainer& trainer,
+    PreparedDataset& prepared,
+    const Settings& settings,
+    std::vector<Trial>& trials,
+    const std::chrono::steady_clock::time_point deadline
+  ) {
+
+    const bool hasBudget = (settings.budget > 0.);
+    ParallelTrain::RunJobs(
+      trials.size(),
+      settings.jobs,
+      [&](const std::size_t iTrial) {
+        return settings.directory + "/trial" + std::to_string(trials[iTrial].id) + ".log";
+      },
+      [&](const std::size_t iTrial) {
+        return RunTrial(trainer, prepared, settings, trials[iTrial]);
+      },
+      [&](const std::size_t iTrial, const ParallelTrain::Outcome outcome, const double) {
+        Trial& trial = trials[iTrial];
+        switch (outcome) {
+          case ParallelTrain::Outcome::Started:
+            return;
+          case ParallelTrain::Outcome::Skipped:
+            trial.status = Status::Skipped;
+            return;
+          case ParallelTrain::Outcome::TimedOut:
+            trial.status = Status::TimedOut;
+            break;
+          case ParallelTrain::Outcome::Done:
+          case ParallelTrain::Outcome::Failed: {
+            std::ifstream result(settings.directory + "/trial" + std::to_string(trial.id) + ".result");
+            if ((outcome == ParallelTrain::Outcome::Done) && (result >> trial.resolution >> trial.linearity >> trial.time)) {
+              trial.status = Status::Done;
+              trial.score  = trial.resolution + (settings.linearity * trial.linearity);
+            } else {
+              trial.status = Status::Failed;
+            }
+            break;
+          }
+        }
+        std::cout << "      Trial " << std::setw(4) << trial.id << " (" << trial.method << ", "
+                  << ((trial.events > 0) ? std::to_string(trial.events) : "all") << " events): "
+                  << GetStatusName(trial.status);
+        if (trial.status == Status::Done) {
+          std::cout << ", score = " << trial.score << ", time = " << trial.time << " s";
+        }
+        std::cout << std::endl;
+      },
+      hasBudget ? deadline : std::chrono::steady_clock::time_point::max()
+    );
+    return;
+
+  }  // end 'RunTrials(TMVAHelper::Trainer&, PreparedDataset&, Settings&, std::vector<Trial>&, time_point)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Keep the best trials of a round
+  // --------------------------------------------------------------------------
+  /*! Trials that finished but didn't make the cut (the
+   *  best `keep`, and within `factor` of the best
+   *  score) are marked as stopped.
+   */
+  inline std::vector<Trial> Promote(
+    std::vector<Trial>& trials,
+    const std::size_t keep,
+    const double factor = std::numeric_limits<double>::max()
+  ) {
+
+    std::vector<std::size_t> ranks;
+    for (std::size_t iTrial = 0; iTrial < trials.size(); ++iTrial) {
+      if (trials[iTrial].status == Status::Done) ranks.push_back(iTrial);
+    }
+    std::stable_sort(ranks.begin(), ranks.end(), [&](const std::size_t lhs, const std::size_t rhs) {
+      return trials[lhs].score < trials[rhs].score;
+    });
+
+    std::vector<Trial> promoted;
+    for (const std::size_t iTrial : ranks) {
+      const bool isClose = (trials[iTrial].score <= factor * trials[ranks.front()].score);
+      if ((promoted.size() < keep) && isClose) {
+        promoted.push_back(trials[iTrial]);
+      } else {
+        trials[iTrial].status = Status::Stopped;
+      }
+    }
+    return promoted;
+
+  }  // end 'Promote(std::vector<Trial>&, std::size_t, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Search the parameter spaces of several methods
+  // --------------------------------------------------------------------------
+  /*! Methods are searched one after another, with the
+   *  trials of each round run in parallel. Returns
+   *  every trial run; the final scores are those of
+   *  trials trained on all events (events = 0).
+   */
+  inline std::vector<Trial> Run(
+    const TMVAHelper::Trainer& trainer,
+    PreparedDataset& prepared,
+    const std::vector<Space>& spaces,
+    const Settings& settings
+  ) {
+
+    const auto     deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(settings.budget)
+    );
+    const uint64_t nTrain   = prepared.GetTrain().GetRows();
+    const uint64_t eta      = std::max<std::size_t>(settings.eta, 2);
+
+    // make sure directories & trees exist before
+    // workers race to create them
+    gSystem -> mkdir(settings.directory.data(), true);
+    prepared.GetTrainTree();
+    prepared.GetTestTree();
+
+    std::vector<Trial> results;
+    std::size_t        nextId = 0;
+    for (const Space& space : spaces) {
+
+      // native methods aren't trained through a factory,
+      // & can't be limited to part of the events yet
+      if (TMVAHelper::IsNative(space.method)) {
+        std::cerr << "WARNING: can't search options of native method '" << space.method << "', skipping it." << std::endl;
+        continue;
+      }
+      std::cout << "    Searching options of '" << space.method << "':" << std::endl;
+
+      // set up a trial per configuration
+      std::vector<Trial> candidates;
+      for (const auto& config : GetConfigs(space, settings)) {
+        Trial trial;
+        trial.config  = candidates.size();
+        trial.method  = space.method;
+        trial.values  = config;
+        trial.options = trainer.GetMethodOptions(space.method);
+        for (const auto& [name, value] : config) {
+          trial.options = TMVAHelper::SetOption(trial.options, name, value);
+        }
+        candidates.push_back(trial);
+      }
+
+      // ----------------------------------------------------------------------
+      // successive halving: fewer trials on more events each round
+      // ----------------------------------------------------------------------
+      if (settings.strategy == Strategy::Halving) {
+
+        std::size_t nRounds = 1;
+        for (uint64_t nLeft = candidates.size(); nLeft > 1; nLeft = (nLeft + eta - 1) / eta) {
+          ++nRounds;
+        }
+
+        uint64_t events = settings.min_events;
+        if (events == 0) {
+          events = nTrain;
+          for (std::size_t iRound = 1; iRound < nRounds; ++iRound) {
+            events /= eta;
+          }
+        }
+        events = std::max<uint64_t>(events, 1);
+
+        for (std::size_t iRound = 0; !candidates.empty(); ++iRound) {
+          const bool isLast = (candidates.size() == 1) || (events >= nTrain);
+          for (Trial& trial : candidates) {
+            trial.id     = nextId++;
+            trial.round  = iRound;
+            trial.events = isLast ? 0 : events;
+            trial.status = Status::Pending;
+          }
+          RunTrials(trainer, prepared, settings, candidates, deadline);
+
+          std::vector<Trial> promoted;
+          if (!isLast) {
+            promoted = Promote(candidates, (candidates.size() + eta - 1) / eta);
+          }
+          results.insert(results.end(), candidates.begin(), candidates.end());
+          candidates = promoted;
+          events    *= eta;
+        }
+        continue;
+      }
+
+      // ----------------------------------------------------------------------
+      // grid or random: optionally screen on fewer events first
+      // ----------------------------------------------------------------------
+      std::size_t iRound = 0;
+      if ((settings.screen > 0.) && (settings.screen < 1.)) {
+        for (Trial& trial : candidates) {
+          trial.id     = nextId++;
+          trial.round  = iRound;
+          trial.events = std::max<uint64_t>(settings.screen * nTrain, 1);
+        }
+        RunTrials(trainer, prepared, settings, candidates, deadline);
+
+        std::vector<Trial> promoted = Promote(candidates, candidates.size(), settings.stop);
+        results.insert(results.end(), candidates.begin(), candidates.end());
+        candidates = promoted;
+        ++iRound;
+      }
+      for (Trial& trial : candidates) {
+        trial.id     = nextId++;
+        trial.round  = iRound;
+        trial.events = 0;
+        trial.status = Status::Pending;
+      }
+      RunTrials(trainer, prepared, settings, candidates, deadline);
+      results.insert(results.end(), candidates.begin(), candidates.end());
+    }  // end space loop
+    return results;
+
+  }  // end 'Run(TMVAHelper::Trainer&, PreparedDataset&, std::vector<Space>&, Settings&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write a table of trials
+  // --------------------------------------------------------------------------
+  /*! One whitespace-separated row per trial, trials
+   *  trained on all events first and then by score.
+   */
+  inline void WriteTable(std::vector<Trial> trials, std::ostream& out) {
+
+    std::stable_sort(trials.begin(), trials.end(), [](const Trial& lhs, const Trial& rhs) {
+      if ((lhs.events == 0) != (rhs.events == 0)) return lhs.events == 0;
+      return lhs.score < rhs.score;
+    });
+
+    out << std::left
+        << std::setw(6)  << "trial"
+        << std::setw(10) << "method"
+        << std::setw(6)  << "round"
+        << std::setw(10) << "events"
+        << std::setw(9)  << "status"
+        << std::setw(13) << "resolution"
+        << std::setw(13) << "linearity"
+        << std::setw(13) << "score"
+        << std::setw(11) << "time[s]"
+        << "options"
+        << std::endl;
+    for (const Trial& trial : trials) {
+
+      std::string values;
+      for (const auto& [name, value] : trial.values) {
+        values += (values.empty() ? "" : ":") + name + "=" + value;
+      }
+
+      const bool isScored = (trial.status == Status::Done) || (trial.status == Status::Stopped);
+      out << std::setw(6)  << trial.id
+          << std::setw(10) << trial.method
+          << std::setw(6)  << trial.round
+          << std::setw(10) << ((trial.events > 0) ? std::to_string(trial.events) : "all")
+          << std::setw(9)  << GetStatusName(trial.status)
+          << std::setw(13) << (isScored ? std::to_string(trial.resolution) : "-")
+          << std::setw(13) << (isScored ? std::to_string(trial.linearity) : "-")
+          << std::setw(13) << (isScored ? std::to_string(trial.score) : "-")
+          << std::setw(11) << (isScored ? std::to_string(trial.time) : "-")
+          << values
+          << std::endl;
+    }
+    out << std::right;
+    return;
+
+  }  // end 'WriteTable(std::vector<Trial>, std::ostream&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get best trial of a method trained on all events
+  // --------------------------------------------------------------------------
+  /*! Returns a trial with status Pending if there's
+   *  none.
+   */
+  inline Trial GetBest(const std::vector<Trial>& trials, const std::string& method) {
+
+    Trial best;
+    for (const Trial& trial : trials) {
+      if ((trial.method != method) || (trial.events != 0) || (trial.status != Status::Done)) continue;
+      if ((best.status == Status::Pending) || (trial.score < best.score)) best = trial;
+    }
+    return best;
+
+  }  // end 'GetBest(std::vector<Trial>&, std::string&)'
+
+}  // end HyperSearch namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,450 @@
+/// ===========================================================================
+/*! \file   NTupleBlockReader.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A class to read a tuple in blocks of entries
+ *  into contiguous per-column arrays.
+ */
+/// ===========================================================================
+
+#ifndef NTupleBlockReader_hxx
+#define NTupleBlockReader_hxx
+
+// c++ utilities
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <Bytes.h>
+#include <TLeaf.h>
+#include <TMath.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TBufferFile.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! NTuple Block Reader
+// ============================================================================
+/*! Reads a tuple through an NTupleIO::Reader in
+ *  blocks of up to N entries, storing each variable
+ *  in its own contiguous array (structure-of-arrays)
+ *  so that cuts, inference, and histogramming can
+ *  run over a whole block at once.
+ *
+ *  For trees, blocks are cut at cluster boundaries
+ *  whenever possible and a TTreeCache is set to the
+ *  block's entry range, so each block costs a few
+ *  large reads instead of one read per basket.
+ *
+ *  If every active branch is a Float_t or Int_t
+ *  scalar/fixed-size array, each branch is then read
+ *  a whole basket at a time through ROOT's bulk API
+ *  and decoded straight into its columns. Otherwise
+ *  (e.g. Float16_t, double, or RNTuple & cache
+ *  backends) entries are loaded one at a time through
+ *  the reader and transposed into the columns.
+ */
+class NTupleBlockReader {
+
+  private:
+
+    // ------------------------------------------------------------------------
+    //! A branch read in bulk
+    // ------------------------------------------------------------------------
+    /*! `buffer` holds the `count` entries of the last
+     *  basket read, starting from entry `start`.
+     */
+    struct BulkBranch {
+      TBranch*                     branch = nullptr;
+      std::size_t                  first  = 0;
+      std::size_t                  size   = 1;
+      bool                         is_int = false;
+      std::unique_ptr<TBufferFile> buffer;
+      int64_t                      start  = 0;
+      int64_t                      count  = 0;
+    };
+
+    // data members
+    NTupleIO::Reader*   m_reader   = nullptr;
+    NTupleIO::Selector* m_selector = nullptr;
+    TTree*              m_tree     = nullptr;
+    std::size_t         m_capacity = 0;
+    std::size_t         m_size     = 0;
+    uint64_t            m_first    = 0;
+    uint64_t            m_next     = 0;
+    uint64_t            m_entries  = 0;
+    uint64_t            m_stop     = 0;
+    uint64_t            m_bytes    = 0;
+    bool                m_error    = false;
+    bool                m_use_bulk = true;
+    bool                m_checked  = false;
+
+    // branches read in bulk (empty if reading entry by entry)
+    std::vector<BulkBranch> m_bulk;
+
+    // block storage
+    std::vector<float>   m_columns;
+    std::vector<uint8_t> m_mask;
+
+    // ------------------------------------------------------------------------
+    //! Find end of the next block
+    // ------------------------------------------------------------------------
+    /*! Takes as many whole clusters as fit in the block;
+     *  if the first cluster alone is too big, the block
+     *  is simply cut at its capacity.
+     */
+    inline uint64_t FindBlockEnd(const uint64_t first) const {
+
+      const uint64_t limit = std::min(first + m_capacity, m_stop);
+      if (!m_tree) return limit;
+
+      uint64_t aligned  = first;
+      auto     clusters = m_tree -> GetClusterIterator(first);
+      for (Long64_t start = clusters.Next(); start < (Long64_t) m_stop; start = clusters.Next()) {
+        const uint64_t stop = std::min((uint64_t) clusters.GetNextEntry(), m_stop);
+        if (stop > limit) break;
+        aligned = stop;
+      }
+      return (aligned > first) ? aligned : limit;
+
+    }  // end 'FindBlockEnd(uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Find branches to read in bulk
+    // ------------------------------------------------------------------------
+    /*! Mirrors how NTupleHelper::SetBranches binds
+     *  branches. If any active branch can't be read in
+     *  bulk, none are.
+     */
+    inline void FindBulkBranches() {
+
+      m_checked = true;
+      m_bulk.clear();
+      if (!m_tree || !m_use_bulk) return;
+
+      // lambda to add a branch if it's readable in bulk
+      auto addBranch = [this](const std::string& name, const std::size_t first, const std::size_t size, const bool isInt) {
+        TBranch* branch = m_tree -> GetBranch(name.data());
+        TLeaf*   leaf   = m_tree -> GetLeaf(name.data());
+        if (!branch || !leaf || !branch -> SupportsBulkRead()) return false;
+        if (leaf -> GetLeafCount() || (leaf -> GetLenStatic() != (int) size)) return false;
+
+        const std::string type = leaf -> GetTypeName();
+        if (type != (isInt ? "Int_t" : "Float_t")) return false;
+
+        BulkBranch bulk;
+        bulk.branch = branch;
+        bulk.first  = first;
+        bulk.size   = size;
+        bulk.is_int = isInt;
+        bulk.buffer = std::make_unique<TBufferFile>(TBuffer::kWrite, 32 * 1024);
+        m_bulk.push_back( std::move(bulk) );
+        return true;
+      };
+
+      const NTupleHelper* helper   = m_reader -> GetHelper();
+      const auto&         branches = helper -> GetBranches();
+      for (std::size_t iBranch = 0; iBranch < branches.size(); ++iBranch) {
+        if (!helper -> IsActive(iBranch)) continue;
+
+        // typed branch if the tree has it, otherwise one
+        // float branch per element
+        const NTupleHelper::Branch& branch  = branches[iBranch];
+        const std::size_t           nBefore = m_bulk.size();
+        bool isGood = (branch.type != NTupleHelper::Type::Double)
+                   && addBranch(branch.name, branch.first, branch.size, branch.type == NTupleHelper::Type::Int);
+        if (!isGood) {
+          m_bulk.resize(nBefore);
+          isGood = true;
+          for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+            const std::size_t iVar = branch.first + iElem;
+            isGood &= addBranch(helper -> GetVariables()[iVar], iVar, 1, false);
+          }
+        }
+
+        if (!isGood) {
+          m_bulk.clear();
+          return;
+        }
+      }
+      return;
+
+    }  // end 'FindBulkBranches()'
+
+    // ------------------------------------------------------------------------
+    //! Read the current block entry by entry
+    // ------------------------------------------------------------------------
+    inline bool ReadEntries() {
+
+      std::span<const float> values = m_reader -> GetHelper() -> GetValueSpan();
+      for (std::size_t iRow = 0; iRow < m_size; ++iRow) {
+
+        const int64_t bytes = m_reader -> GetEntry(m_first + iRow);
+        if (bytes < 0) {
+          std::cerr << "WARNING error in entry #" << m_first + iRow << "! Stopping block reads!" << std::endl;
+          return false;
+        }
+        m_bytes += bytes;
+
+        for (std::size_t iVar = 0; iVar < values.size(); ++iVar) {
+          m_columns[(iVar * m_capacity) + iRow] = values[iVar];
+        }
+        m_mask[iRow] = m_selector ? m_selector -> Pass() : 1;
+      }
+      return true;
+
+    }  // end 'ReadEntries()'
+
+    // ------------------------------------------------------------------------
+    //! Read the current block a basket at a time
+    // ------------------------------------------------------------------------
+    /*! Baskets are kept until the block moves past
+     *  them, so a basket straddling two blocks is only
+     *  read once. Values are serialized big-endian, so
+     *  they're decoded with `frombuf`.
+     */
+    inline bool ReadBaskets() {
+
+      for (BulkBranch& bulk : m_bulk) {
+        for (uint64_t entry = m_first; entry < m_next;) {
+
+          // grab basket holding entry if need be
+          if (((int64_t) entry < bulk.start) || ((int64_t) entry >= bulk.start + bulk.count)) {
+            const Int_t    count  = bulk.branch -> GetBulkRead().GetEntriesSerialized(entry, *bulk.buffer);
+            const Long64_t basket = TMath::BinarySearch(
+              (Long64_t) bulk.branch -> GetWriteBasket() + 1,
+              bulk.branch -> GetBasketEntry(),
+              (Long64_t) entry
+            );
+            bulk.start = (basket >= 0) ? bulk.branch -> GetBasketEntry()[basket] : 0;
+            bulk.count = count;
+            if ((count <= 0) || ((int64_t) entry < bulk.start) || ((int64_t) entry >= bulk.start + count)) {
+              std::cerr << "WARNING error in bulk read of entry #" << entry << " of '" << bulk.branch -> GetName()
+                        << "'! Stopping block reads!" << std::endl;
+              bulk.count = 0;
+              return false;
+            }
+            m_bytes += count * bulk.size * sizeof(float);
+          }
+
+          // then decode entries of the basket in the block
+          const uint64_t stop = std::min((uint64_t) (bulk.start + bulk.count), m_next);
+          char*          data = bulk.buffer -> GetCurrent() + ((entry - bulk.start) * bulk.size * sizeof(float));
+          for (; entry < stop; ++entry) {
+            const std::size_t iRow = entry - m_first;
+            for (std::size_t iElem = 0; iElem < bulk.size; ++iElem) {
+              float& value = m_columns[((bulk.first + iElem) * m_capacity) + iRow];
+              if (bulk.is_int) {
+                Int_t integer;
+                frombuf(data, &integer);
+                value = integer;
+              } else {
+                frombuf(data, &value);
+              }
+            }
+          }
+        }
+      }  // end branch loop
+
+      // the selector reads whatever branches it needs itself
+      for (std::size_t iRow = 0; iRow < m_size; ++iRow) {
+        m_mask[iRow] = m_selector ? m_selector -> Pass(m_first + iRow) : 1;
+      }
+      return true;
+
+    }  // end 'ReadBaskets()'
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Getters
+    // ------------------------------------------------------------------------
+    inline std::size_t GetCapacity()   const {return m_capacity;}
+    inline std::size_t GetSize()       const {return m_size;}
+    inline uint64_t    GetFirstEntry() const {return m_first;}
+    inline uint64_t    GetEntries()    const {return m_entries;}
+    inline uint64_t    GetBytes()      const {return m_bytes;}
+    inline bool        HasError()      const {return m_error;}
+    inline bool        IsBulk()        const {return !m_bulk.empty();}
+
+    // ------------------------------------------------------------------------
+    //! Get values of a variable in the current block
+    // ------------------------------------------------------------------------
+    inline std::span<const float> GetColumn(const std::size_t iVar) const {
+
+      return std::span<const float>(m_columns.data() + (iVar * m_capacity), m_size);
+
+    }  // end 'GetColumn(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Get values of a variable in the current block by name
+    // ------------------------------------------------------------------------
+    inline std::span<const float> GetColumn(const std::string& var) const {
+
+      return GetColumn( m_reader -> GetHelper() -> GetIndex(var) );
+
+    }  // end 'GetColumn(std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Get selection mask of current block
+    // ------------------------------------------------------------------------
+    /*! One flag per row, set if the row passed the
+     *  selector (or always, if no selector was set).
+     */
+    inline std::span<const uint8_t> GetMask() const {
+
+      return std::span<const uint8_t>(m_mask.data(), m_size);
+
+    }  // end 'GetMask()'
+
+    // ------------------------------------------------------------------------
+    //! Set selector to evaluate while reading
+    // ------------------------------------------------------------------------
+    /*! The selector needs to belong to the same reader,
+     *  since it's evaluated on each entry as it's read
+     *  (or, for bulk reads, on each entry of the block
+     *  once the block is read).
+     */
+    inline void SetSelector(NTupleIO::Selector& selector) {
+
+      m_selector = &selector;
+      return;
+
+    }  // end 'SetSelector(NTupleIO::Selector&)'
+
+    // ------------------------------------------------------------------------
+    //! Restrict reading to a range of entries
+    // ------------------------------------------------------------------------
+    /*! Reads entries in [first, stop) starting from the
+     *  next call to `Next()`. Lets several readers split
+     *  one tuple between them.
+     */
+    inline void SetRange(const uint64_t first, const uint64_t stop) {
+
+      m_stop = std::min(stop, m_entries);
+      m_next = std::min(first, m_stop);
+      m_size = 0;
+      return;
+
+    }  // end 'SetRange(uint64_t, uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Turn bulk reads on/off
+    // ------------------------------------------------------------------------
+    /*! On by default; turning it off forces entry by
+     *  entry reads, e.g. to compare the two.
+     */
+    inline void SetUseBulk(const bool useBulk) {
+
+      m_use_bulk = useBulk;
+      m_checked  = false;
+      return;
+
+    }  // end 'SetUseBulk(bool)'
+
+    // ------------------------------------------------------------------------
+    //! Copy a row of the current block back into the helper
+    // ------------------------------------------------------------------------
+    /*! For consumers (e.g. TMVA::Reader) that still read
+     *  one entry at a time from the helper's buffer.
+     */
+    inline void LoadRow(const std::size_t iRow) {
+
+      std::span<float> values = m_reader -> GetHelper() -> GetValueSpan();
+      for (std::size_t iVar = 0; iVar < values.size(); ++iVar) {
+        values[iVar] = m_columns[(iVar * m_capacity) + iRow];
+      }
+      return;
+
+    }  // end 'LoadRow(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Read the next block
+    // ------------------------------------------------------------------------
+    /*! Returns false once every entry has been read,
+     *  or if an entry couldn't be read. In the latter
+     *  case the block is dropped and `HasError()` is
+     *  set (for good), so callers need to check it
+     *  after their loop to know if they saw every
+     *  entry.
+     */
+    inline bool Next() {
+
+      if (m_error || (m_next >= m_stop)) return false;
+      if (!m_checked) FindBulkBranches();
+
+      // set range of block & point cache at it
+      m_first = m_next;
+      m_next  = FindBlockEnd(m_first);
+      m_size  = m_next - m_first;
+      if (m_tree) {
+        m_tree -> SetCacheEntryRange(m_first, m_next);
+      }
+
+      // read block into columns
+      const bool isRead = m_bulk.empty() ? ReadEntries() : ReadBaskets();
+      if (!isRead) {
+        m_size  = 0;
+        m_error = true;
+        return false;
+      }
+      return true;
+
+    }  // end 'Next()'
+
+    // ------------------------------------------------------------------------
+    //! Default ctor/dtor
+    // ------------------------------------------------------------------------
+    NTupleBlockReader()  {};
+    ~NTupleBlockReader() {};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a reader, a block size, and a cache size
+    // ------------------------------------------------------------------------
+    NTupleBlockReader(
+      NTupleIO::Reader& reader,
+      const std::size_t capacity = 4096,
+      const int64_t cache = 32 * 1024 * 1024
+    ) {
+
+      if (capacity == 0) {
+        std::cerr << "PANIC: block reader needs a non-zero block size!" << std::endl;
+        assert(capacity > 0);
+      }
+
+      m_reader   = &reader;
+      m_capacity = capacity;
+      m_entries  = reader.GetEntries();
+      m_stop     = m_entries;
+
+      // allocate blocks
+      const std::size_t nVars = reader.GetHelper() -> GetVariables().size();
+      m_columns.resize(nVars * m_capacity);
+      m_mask.resize(m_capacity);
+
+      // trees get a cache covering every branch
+      if (reader.GetBackend() == NTupleIO::Backend::Tree) {
+        m_tree = reader.GetTree();
+        m_tree -> SetCacheSize(cache);
+        m_tree -> AddBranchToCache("*", true);
+        m_tree -> StopCacheLearningPhase();
+      }
+
+    }  // end ctor(NTupleIO::Reader&, std::size_t, int64_t)'
+
+};  // end NTupleBlockReader
+
+#endif
+
+// end ========================================================================
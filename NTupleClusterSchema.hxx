@@ -0,0 +1,319 @@
+/// ===========================================================================
+/*! \file   NTupleClusterSchema.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A small namespace to define the layout of the
+ *  BHCal/BIC cluster calibration tuple once, at
+ *  compile time.
+ */
+/// ===========================================================================
+
+#ifndef NTupleClusterSchema_hxx
+#define NTupleClusterSchema_hxx
+
+// c++ utilities
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+#include <algorithm>
+// root libraries
+#include <TMath.h>
+// analysis utilities
+#include "NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! List of calibration tuple variables
+// ============================================================================
+/*! Every variable in the calibration tuple, in the
+ *  order they're stored. Both the index enum and the
+ *  list of names below are generated from this, so
+ *  the two can never fall out of sync.
+ */
+#define NTUPLE_CLUSTER_VARIABLES(X) \
+  X(ePar)                \
+  X(fracParVsLeadBHCal)  \
+  X(fracParVsLeadBEMC)   \
+  X(fracParVsSumBHCal)   \
+  X(fracParVsSumBEMC)    \
+  X(fracLeadBHCalVsBEMC) \
+  X(fracSumBHCalVsBEMC)  \
+  X(eLeadBHCal)          \
+  X(eLeadBEMC)           \
+  X(eSumBHCal)           \
+  X(eSumBEMC)            \
+  X(diffLeadBHCal)       \
+  X(diffLeadBEMC)        \
+  X(diffSumBHCal)        \
+  X(diffSumBEMC)         \
+  X(nHitsLeadBHCal)      \
+  X(nHitsLeadBEMC)       \
+  X(nClustBHCal)         \
+  X(nClustBEMC)          \
+  X(hLeadBHCal)          \
+  X(hLeadBEMC)           \
+  X(fLeadBHCal)          \
+  X(fLeadBEMC)           \
+  X(eLeadImage)          \
+  X(eSumImage)           \
+  X(eLeadScFi)           \
+  X(eSumScFi)            \
+  X(nClustImage)         \
+  X(nClustScFi)          \
+  X(hLeadImage)          \
+  X(hLeadScFi)           \
+  X(fLeadImage)          \
+  X(fLeadScFi)           \
+  X(eSumScFiLayer1)      \
+  X(eSumScFiLayer2)      \
+  X(eSumScFiLayer3)      \
+  X(eSumScFiLayer4)      \
+  X(eSumScFiLayer5)      \
+  X(eSumScFiLayer6)      \
+  X(eSumScFiLayer7)      \
+  X(eSumScFiLayer8)      \
+  X(eSumScFiLayer9)      \
+  X(eSumScFiLayer10)     \
+  X(eSumScFiLayer11)     \
+  X(eSumScFiLayer12)     \
+  X(eSumImageLayer1)     \
+  X(eSumImageLayer2)     \
+  X(eSumImageLayer3)     \
+  X(eSumImageLayer4)     \
+  X(eSumImageLayer5)     \
+  X(eSumImageLayer6)
+
+#define NTUPLE_CLUSTER_ENUM(var) var,
+#define NTUPLE_CLUSTER_NAME(var) #var,
+
+
+
+// ============================================================================
+//! Cluster NTuple Schema
+// ============================================================================
+/*! Compile-time description of the calibration
+ *  tuple. The `Var` enum doubles as an O(1)
+ *  index into an `NTupleHelper` built from
+ *  `GetVariables()`.
+ */
+namespace NTupleClusterSchema {
+
+  // --------------------------------------------------------------------------
+  //! Variable indices
+  // --------------------------------------------------------------------------
+  enum Var : std::size_t {
+    NTUPLE_CLUSTER_VARIABLES(NTUPLE_CLUSTER_ENUM)
+    NVars
+  };
+
+  // --------------------------------------------------------------------------
+  //! Variable names, in the same order as the indices
+  // --------------------------------------------------------------------------
+  inline constexpr std::array<std::string_view, NVars> Names = {
+    NTUPLE_CLUSTER_VARIABLES(NTUPLE_CLUSTER_NAME)
+  };
+
+  // number of layers in the imaging & scfi parts of the BIC
+  inline constexpr std::size_t NScFiLayers  = eSumScFiLayer12 - eSumScFiLayer1 + 1;
+  inline constexpr std::size_t NImageLayers = eSumImageLayer6 - eSumImageLayer1 + 1;
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get the name of a variable
+  // --------------------------------------------------------------------------
+  inline std::string GetName(const Var var) {
+
+    return std::string( Names[var] );
+
+  }  // end 'GetName(Var)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get full list of variable names
+  // --------------------------------------------------------------------------
+  inline std::vector<std::string> GetVariables() {
+
+    std::vector<std::string> variables;
+    for (const std::string_view name : Names) {
+      variables.emplace_back( name );
+    }
+    return variables;
+
+  }  // end 'GetVariables()'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Set reduced precision of a branch holding a variable
+  // --------------------------------------------------------------------------
+  /*! Azimuths are quantized within [-pi, pi] on 16
+   *  bits. Pseudorapidities keep 16 bits of mantissa
+   *  rather than a range, since an empty cluster's is
+   *  infinite & has to survive as such. Energies/
+   *  fractions/differences keep 12 bits of mantissa
+   *  (relative error < 1.3e-4). The particle energy
+   *  (i.e. the target) is left at full precision.
+   */
+  inline void SetReducedPrecision(NTupleHelper::Branch& branch, const Var var) {
+
+    if (branch.type != NTupleHelper::Type::Float) return;
+    switch (var) {
+      case ePar:
+        break;
+      case hLeadBHCal:
+        [[fallthrough]];
+      case hLeadBEMC:
+        [[fallthrough]];
+      case hLeadImage:
+        [[fallthrough]];
+      case hLeadScFi:
+        branch.bits = 16;
+        break;
+      case fLeadBHCal:
+        [[fallthrough]];
+      case fLeadBEMC:
+        [[fallthrough]];
+      case fLeadImage:
+        [[fallthrough]];
+      case fLeadScFi:
+        branch.bits = 16;
+        branch.min  = -TMath::Pi();
+        branch.max  = TMath::Pi();
+        break;
+      default:
+        branch.bits = 12;
+        break;
+    }
+    return;
+
+  }  // end 'SetReducedPrecision(NTupleHelper::Branch&, Var)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get storage layout for a list of variables
+  // --------------------------------------------------------------------------
+  /*! Counts are stored as ints, and the per-layer
+   *  energy sums as fixed-size arrays (e.g.
+   *  'eSumScFiLayer[12]') when every layer is
+   *  present in order. Everything else, including
+   *  names outside the schema, stays a float. If
+   *  `reduced` is set, floats from the schema get
+   *  the precision set by `SetReducedPrecision`.
+   */
+  inline std::vector<NTupleHelper::Branch> GetBranches(
+    const std::vector<std::string>& vars,
+    const bool reduced = false
+  ) {
+
+    // counts & arrays in the schema
+    const std::array<Var, 6> counts = {
+      nHitsLeadBHCal,
+      nHitsLeadBEMC,
+      nClustBHCal,
+      nClustBEMC,
+      nClustImage,
+      nClustScFi
+    };
+    const std::array<std::pair<std::string, std::pair<Var, std::size_t>>, 2> arrays = {{
+      {"eSumScFiLayer",  {eSumScFiLayer1,  NScFiLayers}},
+      {"eSumImageLayer", {eSumImageLayer1, NImageLayers}}
+    }};
+
+    std::vector<NTupleHelper::Branch> branches;
+    for (std::size_t iVar = 0; iVar < vars.size(); ++iVar) {
+
+      // check if this starts a complete array
+      bool isArray = false;
+      for (const auto& [array, firstAndSize] : arrays) {
+        const auto [first, size] = firstAndSize;
+        if (iVar + size > vars.size()) continue;
+
+        bool isComplete = true;
+        for (std::size_t iElem = 0; iElem < size; ++iElem) {
+          isComplete &= (vars[iVar + iElem] == Names[first + iElem]);
+        }
+        if (!isComplete) continue;
+
+        branches.push_back( {array, NTupleHelper::Type::Float, iVar, size} );
+        if (reduced) SetReducedPrecision(branches.back(), first);
+        iVar   += size - 1;
+        isArray = true;
+        break;
+      }
+      if (isArray) continue;
+
+      // otherwise add a scalar
+      const bool isCount = std::any_of(
+        counts.begin(),
+        counts.end(),
+        [&](const Var count) {return vars[iVar] == Names[count];}
+      );
+      branches.push_back( {
+        vars[iVar],
+        isCount ? NTupleHelper::Type::Int : NTupleHelper::Type::Float,
+        iVar,
+        1
+      } );
+
+      // set precision if needed
+      const auto name = std::find(Names.begin(), Names.end(), vars[iVar]);
+      if (reduced && (name != Names.end())) {
+        SetReducedPrecision(branches.back(), (Var) std::distance(Names.begin(), name));
+      }
+    }
+    return branches;
+
+  }  // end 'GetBranches(std::vector<std::string>&, bool)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get storage layout of the full tuple
+  // --------------------------------------------------------------------------
+  inline std::vector<NTupleHelper::Branch> GetBranches(const bool reduced = false) {
+
+    return GetBranches( GetVariables(), reduced );
+
+  }  // end 'GetBranches(bool)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get storage layout of the TMVA output tuple
+  // --------------------------------------------------------------------------
+  /*! Targets copied from the calibration tuple follow
+   *  the schema; if `reduced` is set, regression
+   *  outputs (e.g. 'ePar_MLP') keep 12 bits of
+   *  mantissa.
+   */
+  inline std::vector<NTupleHelper::Branch> GetOutputBranches(
+    const std::vector<std::string>& outputs,
+    const bool reduced = false
+  ) {
+
+    std::vector<NTupleHelper::Branch> branches = GetBranches(outputs, reduced);
+    for (NTupleHelper::Branch& branch : branches) {
+      const bool isInSchema = std::find(Names.begin(), Names.end(), branch.name) != Names.end();
+      if (reduced && !isInSchema && (branch.type == NTupleHelper::Type::Float)) {
+        branch.bits = 12;
+      }
+    }
+    return branches;
+
+  }  // end 'GetOutputBranches(std::vector<std::string>&, bool)'
+
+}  // end NTupleClusterSchema namespace
+
+#undef NTUPLE_CLUSTER_ENUM
+#undef NTUPLE_CLUSTER_NAME
+
+#endif
+
+// end ========================================================================
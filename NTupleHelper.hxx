@@ -14,10 +14,17 @@
 #include <map>
 #include <limits>
 #include <string>
+#include <span>
 #include <vector>
+#include <cmath>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <algorithm>
 // root libraries
+#include <TLeaf.h>
+#include <TTree.h>
 #include <TNtuple.h>
 
 // forward declaration of TMVAHelper::Reader
@@ -35,6 +42,42 @@ namespace TMVAHelper {
  */
 class NTupleHelper {
 
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Storage types of branches
+    // ------------------------------------------------------------------------
+    enum class Type {Float, Int, Double};
+
+    // ------------------------------------------------------------------------
+    //! Layout of a branch
+    // ------------------------------------------------------------------------
+    /*! A branch stores `size` consecutive variables starting
+     *  at index `first`: scalars have a size of 1, and
+     *  larger sizes make a fixed-size array branch (e.g.
+     *  'eSumScFiLayer[12]'). Individual elements are still
+     *  addressed by their own variable name.
+     *
+     *  Float branches can opt into reduced precision with
+     *  `bits` > 0: with a range (`min` < `max`) values are
+     *  quantized onto `bits` bits within it (finite values
+     *  outside are clamped & counted, see GetNClamped),
+     *  otherwise only `bits` bits of mantissa are kept.
+     *  Trees store these
+     *  as Float16_t (mantissa-only ones take 3 bytes if
+     *  `bits` <= 16); other backends keep floats, which
+     *  then compress better.
+     */
+    struct Branch {
+      std::string name;
+      Type        type  = Type::Float;
+      std::size_t first = 0;
+      std::size_t size  = 1;
+      int         bits  = 0;
+      float       min   = 0.;
+      float       max   = 0.;
+    };
+
   private:
 
     // data members
@@ -42,56 +85,604 @@ class NTupleHelper {
     std::vector<std::string>           m_variables;
     std::map<std::string, std::size_t> m_index;
 
+    // branch layout & storage for non-float branches
+    std::vector<Branch>       m_branches;
+    std::vector<std::size_t>  m_offsets;
+    std::vector<bool>         m_as_float;
+    std::vector<bool>         m_active;
+    std::vector<int32_t>      m_ints;
+    std::vector<double>       m_doubles;
+    uint64_t                  m_clamped = 0;
+
+    // ------------------------------------------------------------------------
+    //! Set branch layout & allocate storage
+    // ------------------------------------------------------------------------
+    inline void SetLayout(const std::vector<Branch>& branches) {
+
+      m_branches = branches;
+      m_offsets.clear();
+      m_as_float.assign(m_branches.size(), false);
+      m_active.assign(m_branches.size(), true);
+      m_ints.clear();
+      m_doubles.clear();
+
+      std::size_t nCovered = 0;
+      for (const Branch& branch : m_branches) {
+
+        // make sure branches cover variables in order
+        if (branch.first != nCovered) {
+          assert(branch.first == nCovered);
+        }
+        nCovered += branch.size;
+
+        // and that any reduced precision is usable
+        if (!IsValidPrecision(branch)) {
+          std::cerr << "PANIC: branch '" << branch.name << "' has an invalid precision (bits = " << branch.bits
+                    << ", range = [" << branch.min << ", " << branch.max << "])!" << std::endl;
+          assert(IsValidPrecision(branch));
+        }
+
+        // and assign storage
+        switch (branch.type) {
+          case Type::Int:
+            m_offsets.push_back( m_ints.size() );
+            m_ints.resize( m_ints.size() + branch.size );
+            break;
+          case Type::Double:
+            m_offsets.push_back( m_doubles.size() );
+            m_doubles.resize( m_doubles.size() + branch.size );
+            break;
+          case Type::Float:
+            [[fallthrough]];
+          default:
+            m_offsets.push_back( branch.first );
+            break;
+        }
+      }  // end branch loop
+
+      // check that every variable is in a branch
+      if (nCovered != m_variables.size()) {
+        assert(nCovered == m_variables.size());
+      }
+      return;
+
+    }  // end 'SetLayout(std::vector<Branch>&)'
+
   public:
 
+    // ------------------------------------------------------------------------
+    //! Make a layout with one float branch per variable
+    // ------------------------------------------------------------------------
+    static inline std::vector<Branch> MakeFlatLayout(const std::vector<std::string>& vars) {
+
+      std::vector<Branch> branches;
+      for (std::size_t iVar = 0; iVar < vars.size(); ++iVar) {
+        branches.push_back( {vars[iVar], Type::Float, iVar, 1} );
+      }
+      return branches;
+
+    }  // end 'MakeFlatLayout(std::vector<std::string>&)'
+
     // ------------------------------------------------------------------------
     //! Getters
     // ------------------------------------------------------------------------
-    inline std::vector<float>       GetValues()    const {return m_values;}
-    inline std::vector<std::string> GetVariables() const {return m_variables;}
+    /*! Values are handed out by reference or as a span over the
+     *  helper's own buffer, so nothing is copied per entry.
+     */
+    inline const std::vector<float>&       GetValues()    const {return m_values;}
+    inline const std::vector<std::string>& GetVariables() const {return m_variables;}
+    inline std::span<const float>          GetValueSpan() const {return m_values;}
+    inline std::span<float>                GetValueSpan()       {return m_values;}
+    inline const std::vector<Branch>&      GetBranches()  const {return m_branches;}
+    inline uint64_t                        GetNClamped()  const {return m_clamped;}
 
     // ------------------------------------------------------------------------
-    //! Get a specific variable
+    //! Check if every branch is a float scalar (i.e. TNtuple-compatible)
+    // ------------------------------------------------------------------------
+    inline bool IsFlat() const {
+
+      return std::all_of(
+        m_branches.begin(),
+        m_branches.end(),
+        [](const Branch& branch) {return (branch.type == Type::Float) && (branch.size == 1) && (branch.bits <= 0);}
+      );
+
+    }  // end 'IsFlat()'
+
+    // ------------------------------------------------------------------------
+    //! Check if a branch is quantized within a range
+    // ------------------------------------------------------------------------
+    static inline bool IsRanged(const Branch& branch) {
+
+      return (branch.type == Type::Float) && (branch.bits > 0) && (branch.min < branch.max);
+
+    }  // end 'IsRanged(Branch&)'
+
+    // ------------------------------------------------------------------------
+    //! Check if a branch's reduced precision can be stored
+    // ------------------------------------------------------------------------
+    /*! Only float branches can be reduced, to 1 - 31
+     *  bits; a range, if set at all, needs `min` < `max`.
+     *  No bits (i.e. full precision) is always fine.
+     */
+    static inline bool IsValidPrecision(const Branch& branch) {
+
+      if (branch.bits == 0) return true;
+
+      const bool hasRange = (branch.min != 0.) || (branch.max != 0.);
+      return (branch.type == Type::Float)
+          && (branch.bits >= 1)
+          && (branch.bits <= 31)
+          && (!hasRange || (branch.min < branch.max));
+
+    }  // end 'IsValidPrecision(Branch&)'
+
+    // ------------------------------------------------------------------------
+    //! Keep only the leading bits of a float's mantissa
+    // ------------------------------------------------------------------------
+    /*! Rounds to nearest (ties to even), so the relative
+     *  error is at most 2^-(bits + 1). Infinities and NaNs
+     *  are left alone.
+     */
+    static inline float TruncateMantissa(const float value, const int bits) {
+
+      if ((bits <= 0) || (bits >= 23)) return value;
+
+      uint32_t word;
+      std::memcpy(&word, &value, sizeof(float));
+      if ((word & 0x7f800000u) == 0x7f800000u) return value;
+
+      const uint32_t shift = 23 - bits;
+      const uint32_t mask  = (1u << shift) - 1;
+      word += (mask >> 1) + ((word >> shift) & 1u);
+      word &= ~mask;
+
+      float truncated;
+      std::memcpy(&truncated, &word, sizeof(float));
+      return truncated;
+
+    }  // end 'TruncateMantissa(float, int)'
+
+    // ------------------------------------------------------------------------
+    //! Quantize a float onto `bits` bits within [min, max]
+    // ------------------------------------------------------------------------
+    /*! Rounds onto the same kind of grid as a ranged
+     *  Float16_t, so packing by ROOT adds at most one
+     *  more step of error. Values outside the range
+     *  are clamped, while infinities and NaNs are left
+     *  alone (n.b. a ranged Float16_t still clamps
+     *  them when a tree is filled). Needs 1 - 31 bits
+     *  and `min` < `max` (see IsValidPrecision); values
+     *  are left alone otherwise.
+     */
+    static inline float Quantize(const float value, const float min, const float max, const int bits) {
+
+      if (!std::isfinite(value) || (bits < 1) || (bits > 31) || !(min < max)) return value;
+
+      const double   factor  = (double) (1u << bits) / (max - min);
+      const double   clamped = std::clamp((double) value, (double) min, (double) max);
+      const uint32_t step    = (uint32_t) (0.5 + factor * (clamped - min));
+      return (float) (min + (step / factor));
+
+    }  // end 'Quantize(float, float, float, int)'
+
+    // ------------------------------------------------------------------------
+    //! Round a float onto an int branch
+    // ------------------------------------------------------------------------
+    /*! Values are clamped to the range of an int32_t
+     *  first, so the unset value (-FLT_MAX) is stored
+     *  as the smallest int. NaNs are stored as that too.
+     */
+    static inline int32_t ToInt(const float value) {
+
+      if (std::isnan(value)) return std::numeric_limits<int32_t>::min();
+
+      const double clamped = std::clamp(
+        (double) value,
+        (double) std::numeric_limits<int32_t>::min(),
+        (double) std::numeric_limits<int32_t>::max()
+      );
+      return (int32_t) std::lround(clamped);
+
+    }  // end 'ToInt(float)'
+
+    // ------------------------------------------------------------------------
+    //! Get address of a branch's storage
+    // ------------------------------------------------------------------------
+    inline void* GetBranchAddress(const std::size_t iBranch) {
+
+      switch (m_branches[iBranch].type) {
+        case Type::Int:
+          return &m_ints[m_offsets[iBranch]];
+        case Type::Double:
+          return &m_doubles[m_offsets[iBranch]];
+        case Type::Float:
+          [[fallthrough]];
+        default:
+          return &m_values[m_offsets[iBranch]];
+      }
+
+    }  // end 'GetBranchAddress(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Flag a branch as read element-by-element into the float buffer
+    // ------------------------------------------------------------------------
+    /*! Used when a file predates the branch's typed
+     *  layout, so unpacking skips it.
+     */
+    inline void SetReadAsFloat(const std::size_t iBranch, const bool asFloat) {
+
+      m_as_float[iBranch] = asFloat;
+      return;
+
+    }  // end 'SetReadAsFloat(std::size_t, bool)'
+
+    // ------------------------------------------------------------------------
+    //! Check if a branch is read
+    // ------------------------------------------------------------------------
+    inline bool IsActive(const std::size_t iBranch) const {return m_active[iBranch];}
+
+    // ------------------------------------------------------------------------
+    //! Only read branches holding the listed variables
+    // ------------------------------------------------------------------------
+    /*! Names can be variables (e.g. 'eSumScFiLayer3') or
+     *  branches (e.g. 'eSumScFiLayer'); an array branch
+     *  is read if any of its elements is listed. Names
+     *  the helper doesn't know about are ignored.
+     */
+    inline void SetActive(const std::vector<std::string>& names) {
+
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+        const Branch& branch = m_branches[iBranch];
+
+        bool isListed = std::find(names.begin(), names.end(), branch.name) != names.end();
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          const std::string& var = m_variables[branch.first + iElem];
+          isListed |= (std::find(names.begin(), names.end(), var) != names.end());
+        }
+        m_active[iBranch] = isListed;
+      }
+      return;
+
+    }  // end 'SetActive(std::vector<std::string>&)'
+
+    // ------------------------------------------------------------------------
+    //! Turn off every TTree branch except the active ones
+    // ------------------------------------------------------------------------
+    /*! Matches how `SetBranches` binds branches, so
+     *  older all-float tuples are handled too.
+     */
+    inline void SetBranchStatus(TTree* tree) const {
+
+      tree -> SetBranchStatus("*", false);
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+        if (!m_active[iBranch]) continue;
+
+        const Branch& branch = m_branches[iBranch];
+        if (tree -> GetBranch(branch.name.data())) {
+          tree -> SetBranchStatus(branch.name.data(), true);
+          continue;
+        }
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          tree -> SetBranchStatus(m_variables[branch.first + iElem].data(), true);
+        }
+      }
+      return;
+
+    }  // end 'SetBranchStatus(TTree*)'
+
+    // ------------------------------------------------------------------------
+    //! Get TTree leaf list of a branch (e.g. 'eSumScFiLayer[12]/F')
     // ------------------------------------------------------------------------
-    inline float GetVariable(const std::string& var) {
+    inline std::string GetLeafList(const std::size_t iBranch) const {
+
+      const Branch& branch = m_branches[iBranch];
+
+      std::string leaf = branch.name;
+      if (branch.size > 1) {
+        leaf.append( "[" + std::to_string(branch.size) + "]" );
+      }
+      switch (branch.type) {
+        case Type::Int:
+          leaf.append("/I");
+          break;
+        case Type::Double:
+          leaf.append("/D");
+          break;
+        case Type::Float:
+          [[fallthrough]];
+        default:
+          if (IsRanged(branch)) {
+            leaf.append(
+              "/f[" + std::to_string(branch.min) + "," + std::to_string(branch.max) + "," + std::to_string(branch.bits) + "]"
+            );
+          } else if ((branch.bits > 0) && (branch.bits <= 16)) {
+            leaf.append( "/f[0,0," + std::to_string(branch.bits) + "]" );
+          } else {
+            leaf.append("/F");
+          }
+          break;
+      }
+      return leaf;
+
+    }  // end 'GetLeafList(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Get C++ type name of a branch (e.g. 'std::array<float,12>')
+    // ------------------------------------------------------------------------
+    inline std::string GetTypeName(const std::size_t iBranch) const {
+
+      const Branch& branch = m_branches[iBranch];
+
+      std::string type;
+      switch (branch.type) {
+        case Type::Int:
+          type = "std::int32_t";
+          break;
+        case Type::Double:
+          type = "double";
+          break;
+        case Type::Float:
+          [[fallthrough]];
+        default:
+          type = "float";
+          break;
+      }
+
+      if (branch.size > 1) {
+        type = "std::array<" + type + "," + std::to_string(branch.size) + ">";
+      }
+      return type;
+
+    }  // end 'GetTypeName(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Copy values into storage of non-float branches
+    // ------------------------------------------------------------------------
+    /*! The float buffer is what TMVA and the accessors see,
+     *  so values are moved in/out of int and double storage
+     *  right before filling and right after reading. Doubles
+     *  are only as precise as the float buffer.
+     *
+     *  Reduced-precision float branches are rounded here,
+     *  in place, so every backend stores the same values.
+     *  Values clamped to a range are counted.
+     */
+    inline void PackValues() {
+
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+        const Branch& branch = m_branches[iBranch];
+        if (branch.type == Type::Float) {
+          if (branch.bits <= 0) continue;
+          for (std::size_t iVar = branch.first; iVar < branch.first + branch.size; ++iVar) {
+            if (!IsRanged(branch)) {
+              m_values[iVar] = TruncateMantissa(m_values[iVar], branch.bits);
+              continue;
+            }
+            if ((m_values[iVar] < branch.min) || (m_values[iVar] > branch.max)) ++m_clamped;
+            m_values[iVar] = Quantize(m_values[iVar], branch.min, branch.max, branch.bits);
+          }
+          continue;
+        }
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          const float value = m_values[branch.first + iElem];
+          if (branch.type == Type::Int) {
+            m_ints[m_offsets[iBranch] + iElem] = ToInt(value);
+          } else {
+            m_doubles[m_offsets[iBranch] + iElem] = value;
+          }
+        }
+      }
+      return;
+
+    }  // end 'PackValues()'
+
+    // ------------------------------------------------------------------------
+    //! Copy values out of storage of non-float branches
+    // ------------------------------------------------------------------------
+    inline void UnpackValues() {
+
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+        const Branch& branch = m_branches[iBranch];
+        if (!m_active[iBranch] || m_as_float[iBranch] || (branch.type == Type::Float)) continue;
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          m_values[branch.first + iElem] = (branch.type == Type::Int)
+                                         ? (float) m_ints[m_offsets[iBranch] + iElem]
+                                         : (float) m_doubles[m_offsets[iBranch] + iElem];
+        }
+      }
+      return;
+
+    }  // end 'UnpackValues()'
+
+    // ------------------------------------------------------------------------
+    //! Get the index of a specific variable
+    // ------------------------------------------------------------------------
+    /*! Lets callers resolve a name once and then use
+     *  the O(1) index-based accessors below inside
+     *  of their event loops.
+     */
+    inline std::size_t GetIndex(const std::string& var) const {
 
       // check if variable exists
       if (!m_index.count(var)) {
         assert(m_index.count(var));
       }
 
-      // then get variable
-      return m_values.at(m_index[var]);
+      // then get index
+      return m_index.at(var);
+
+    }  // end 'GetIndex(std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Get a specific variable
+    // ------------------------------------------------------------------------
+    inline float GetVariable(const std::string& var) const {
+
+      return m_values[GetIndex(var)];
 
     }  // end 'GetVariable(std::string&)'
 
+    // ------------------------------------------------------------------------
+    //! Get a specific variable by index
+    // ------------------------------------------------------------------------
+    inline float GetVariable(const std::size_t index) const {
+
+      assert(index < m_values.size());
+      return m_values[index];
+
+    }  // end 'GetVariable(std::size_t)'
+
     // ------------------------------------------------------------------------
     //! Set a variable
     // ------------------------------------------------------------------------
     inline void SetVariable(const std::string& var, const float val) {
 
-      // check if variable exists
-      if (!m_index.count(var)) {
-        assert(m_index.count(var));
-      }
-
-      // then set variable
-      m_values.at(m_index[var]) = val;
+      m_values[GetIndex(var)] = val;
       return;
 
     }  // end 'SetVariable(std::string&, float)'
 
     // ------------------------------------------------------------------------
-    //! Assign variables to TNtuple branches
+    //! Set a variable by index
     // ------------------------------------------------------------------------
-    inline void SetBranches(TNtuple* tuple) {
+    inline void SetVariable(const std::size_t index, const float val) {
 
-      for (const std::string& var : m_variables) {
-        tuple -> SetBranchAddress(var.data(), &m_values.at(m_index[var]));
+      assert(index < m_values.size());
+      m_values[index] = val;
+      return;
+
+    }  // end 'SetVariable(std::size_t, float)'
+
+    // ------------------------------------------------------------------------
+    //! Set all variables at once
+    // ------------------------------------------------------------------------
+    /*! Copies into the existing buffer, so no allocation
+     *  takes place as long as the sizes match.
+     */
+    inline void SetValues(std::span<const float> values) {
+
+      assert(values.size() == m_values.size());
+      std::copy(values.begin(), values.end(), m_values.begin());
+      return;
+
+    }  // end 'SetValues(std::span<const float>)'
+
+    // ------------------------------------------------------------------------
+    //! Create TTree branches pointing at the helper's buffer
+    // ------------------------------------------------------------------------
+    /*! After this, `Fill(TTree*)` picks up the current
+     *  values directly from the helper's storage.
+     */
+    inline void CreateBranches(TTree* tree) {
+
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+        tree -> Branch(
+          m_branches[iBranch].name.data(),
+          GetBranchAddress(iBranch),
+          GetLeafList(iBranch).data()
+        );
       }
+      SetAliases(tree);
+      return;
+
+    }  // end 'CreateBranches(TTree*)'
+
+    // ------------------------------------------------------------------------
+    //! Alias elements of array branches to their variable names
+    // ------------------------------------------------------------------------
+    /*! e.g. 'eSumScFiLayer1' becomes an alias of 'eSumScFiLayer[0]',
+     *  so TMVA variables and cuts can keep using element names.
+     *  Aliases are written out with the tree.
+     */
+    inline void SetAliases(TTree* tree) const {
+
+      for (const Branch& branch : m_branches) {
+        if (branch.size < 2) continue;
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          const std::string& var = m_variables[branch.first + iElem];
+          if (tree -> GetBranch(var.data())) continue;
+
+          const std::string element = branch.name + "[" + std::to_string(iElem) + "]";
+          tree -> SetAlias(var.data(), element.data());
+        }
+      }
+      return;
+
+    }  // end 'SetAliases(TTree*)'
+
+    // ------------------------------------------------------------------------
+    //! Fill a TNtuple with the current values
+    // ------------------------------------------------------------------------
+    inline int Fill(TNtuple* tuple) {
+
+      assert(tuple -> GetNvar() == (int) m_values.size());
+      PackValues();
+      return tuple -> Fill(m_values.data());
+
+    }  // end 'Fill(TNtuple*)'
+
+    // ------------------------------------------------------------------------
+    //! Fill a TTree whose branches point at the helper's buffer
+    // ------------------------------------------------------------------------
+    inline int Fill(TTree* tree) {
+
+      PackValues();
+      return tree -> Fill();
+
+    }  // end 'Fill(TTree*)'
+
+    // ------------------------------------------------------------------------
+    //! Read an entry of a TTree whose branches point at the helper
+    // ------------------------------------------------------------------------
+    inline int GetEntry(TTree* tree, const uint64_t entry) {
+
+      const int bytes = tree -> GetEntry(entry);
+      UnpackValues();
+      return bytes;
+
+    }  // end 'GetEntry(TTree*, uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Assign variables to TNtuple/TTree branches
+    // ------------------------------------------------------------------------
+    /*! Branches are bound with their typed layout when the
+     *  tree has them. Otherwise (e.g. an older all-float
+     *  TNtuple) each element is bound as its own float
+     *  branch.
+     */
+    inline void SetBranches(TTree* tuple) {
+
+      for (std::size_t iBranch = 0; iBranch < m_branches.size(); ++iBranch) {
+
+        const Branch& branch = m_branches[iBranch];
+
+        // check if tree has the branch with the expected type
+        TLeaf*      leaf = tuple -> GetLeaf(branch.name.data());
+        std::string type = leaf ? leaf -> GetTypeName() : "";
+        const bool  hasTyped = (leaf != nullptr)
+          && ((branch.type != Type::Int)    || (type == "Int_t"))
+          && ((branch.type != Type::Double) || (type == "Double_t"))
+          && ((branch.type != Type::Float)  || (type == "Float_t") || (type == "Float16_t"));
+
+        // bind typed branch if possible
+        if (hasTyped) {
+          m_as_float[iBranch] = false;
+          tuple -> SetBranchAddress(branch.name.data(), GetBranchAddress(iBranch));
+          continue;
+        }
+
+        // otherwise bind each element as a float
+        m_as_float[iBranch] = true;
+        for (std::size_t iElem = 0; iElem < branch.size; ++iElem) {
+          const std::size_t iVar = branch.first + iElem;
+          tuple -> SetBranchAddress(m_variables[iVar].data(), &m_values[iVar]);
+        }
+      }  // end branch loop
+      SetAliases(tuple);
       return;
 
-    }  // end 'SetBranches(TNtuple*)'
+    }  // end 'SetBranches(TTree*)'
 
     // ------------------------------------------------------------------------
     //! Reset values
@@ -132,7 +723,16 @@ class NTupleHelper {
     // ------------------------------------------------------------------------
     //! ctor accepting a list of variables
     // ------------------------------------------------------------------------
-    NTupleHelper(const std::vector<std::string>& vars) {
+    /*! Every variable is stored as its own float
+     *  branch, like in a TNtuple.
+     */
+    NTupleHelper(const std::vector<std::string>& vars)
+      : NTupleHelper(vars, MakeFlatLayout(vars)) {};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a list of variables and a branch layout
+    // ------------------------------------------------------------------------
+    NTupleHelper(const std::vector<std::string>& vars, const std::vector<Branch>& branches) {
 
       // set variables
       m_variables = vars;
@@ -145,7 +745,10 @@ class NTupleHelper {
       }
       m_values.resize(m_variables.size());
 
-    }  // end ctor(std::vector<std::string>&)'
+      // then set how variables are stored
+      SetLayout(branches);
+
+    }  // end ctor(std::vector<std::string>&, std::vector<Branch>&)'
 
     // make TMVAHelper::Reader a friend
     friend class TMVAHelper::Reader;
@@ -0,0 +1,992 @@
+/// ===========================================================================
+/*! \file   NTupleIO.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A lightweight namespace to read and write the
+ *  contents of an NTupleHelper with different
+ *  storage backends (TNtuple/TTree, RNTuple, or
+ *  a memory-mapped feature cache).
+ */
+/// ===========================================================================
+
+#ifndef NTupleIO_hxx
+#define NTupleIO_hxx
+
+// c++ utilities
+#include <span>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cctype>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TCut.h>
+#include <Compression.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TNtuple.h>
+#include <TFormula.h>
+#include <TTreeFormula.h>
+// root rntuple components
+#include <ROOT/REntry.hxx>
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+// analysis utilities
+#include "FeatureCache.hxx"
+#include "NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! NTuple I/O
+// ============================================================================
+/*! A small namespace to move the values held by an
+ *  NTupleHelper in and out of files, independent of
+ *  how they're stored on disk.
+ */
+namespace NTupleIO {
+
+  // --------------------------------------------------------------------------
+  //! Available storage backends
+  // --------------------------------------------------------------------------
+  enum Backend {Tree, RNTuple, Cache};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to bind a helper's storage to an RNTuple entry
+  // --------------------------------------------------------------------------
+  /*! Fields whose on-disk type matches the helper's
+   *  layout are bound as is. Otherwise (e.g. a tuple
+   *  written before counts/arrays were typed) each
+   *  element is bound to its own float field. Branches
+   *  that aren't active are skipped.
+   */
+  inline void BindEntry(
+    NTupleHelper& helper,
+    ROOT::Experimental::REntry& entry,
+    const ROOT::Experimental::RNTupleDescriptor& descriptor
+  ) {
+
+    const auto& branches = helper.GetBranches();
+    for (std::size_t iBranch = 0; iBranch < branches.size(); ++iBranch) {
+
+      if (!helper.IsActive(iBranch)) continue;
+
+      const auto iField  = descriptor.FindFieldId(branches[iBranch].name);
+      const bool isTyped = (iField != ROOT::Experimental::kInvalidDescriptorId)
+        && (descriptor.GetFieldDescriptor(iField).GetTypeName() == helper.GetTypeName(iBranch));
+
+      if (isTyped) {
+        helper.SetReadAsFloat(iBranch, false);
+        entry.BindRawPtr(branches[iBranch].name, helper.GetBranchAddress(iBranch));
+        continue;
+      }
+
+      helper.SetReadAsFloat(iBranch, true);
+      for (std::size_t iElem = 0; iElem < branches[iBranch].size; ++iElem) {
+        const std::size_t iVar = branches[iBranch].first + iElem;
+        entry.BindRawPtr(helper.GetVariables()[iVar], &helper.GetValueSpan()[iVar]);
+      }
+    }
+    return;
+
+  }  // end 'BindEntry(NTupleHelper&, REntry&, RNTupleDescriptor&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to translate a backend name into a backend
+  // --------------------------------------------------------------------------
+  /*! Accepts "tree"/"ttree"/"tntuple" or "rntuple"
+   *  (case insensitive), so the backend can be picked
+   *  from a macro option. Anything else falls back
+   *  on the tree backend with a warning.
+   */
+  inline Backend ParseBackend(const std::string& name) {
+
+    std::string lower;
+    for (const char c : name) {
+      lower.push_back( std::tolower(c) );
+    }
+
+    if (lower == "rntuple") {
+      return Backend::RNTuple;
+    } else if ((lower == "tree") || (lower == "tntuple") || (lower == "ttree")) {
+      return Backend::Tree;
+    } else {
+      std::cerr << "WARNING: unknown tuple backend '" << name << "'! Using 'tree' instead." << std::endl;
+      return Backend::Tree;
+    }
+
+  }  // end 'ParseBackend(std::string&)'
+
+
+
+  // ==========================================================================
+  //! Writer Policy
+  // ==========================================================================
+  /*! Compression, basket, and cluster settings for a
+   *  tuple writer. Zeroes (and kUseGlobal) leave the
+   *  ROOT defaults alone. Following TTree conventions,
+   *  a positive auto-flush/auto-save is a number of
+   *  entries and a negative one a number of bytes.
+   *  For RNTuple, the basket size sets the page size
+   *  and the auto-flush bytes the cluster size.
+   */
+  struct Policy {
+    ROOT::RCompressionSetting::EAlgorithm::EValues algorithm = ROOT::RCompressionSetting::EAlgorithm::kUseGlobal;
+    int     level       = 0;  // compression level (1 - 9)
+    int     basket_size = 0;  // basket (page) size in bytes
+    int64_t auto_flush  = 0;  // cluster size
+    int64_t auto_save   = 0;  // how often to save the tree header
+  };
+
+  // --------------------------------------------------------------------------
+  //! Available writer presets
+  // --------------------------------------------------------------------------
+  enum Preset {Default, FastWrite, SmallFile, FastRead};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to get the policy of a preset
+  // --------------------------------------------------------------------------
+  /*! - FastWrite: light LZ4, small clusters, no auto-save
+   *  - SmallFile: LZMA, big baskets & clusters
+   *  - FastRead:  ZSTD at a low level (fast to unzip),
+   *               big baskets & clusters so reads are
+   *               few and large
+   */
+  inline Policy GetPolicy(const Preset preset) {
+
+    Policy policy;
+    switch (preset) {
+      case Preset::FastWrite:
+        policy.algorithm   = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+        policy.level       = 1;
+        policy.basket_size = 64 * 1024;
+        policy.auto_flush  = -16 * 1024 * 1024;
+        policy.auto_save   = -1024LL * 1024 * 1024 * 1024;
+        break;
+      case Preset::SmallFile:
+        policy.algorithm   = ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+        policy.level       = 8;
+        policy.basket_size = 512 * 1024;
+        policy.auto_flush  = -128 * 1024 * 1024;
+        break;
+      case Preset::FastRead:
+        policy.algorithm   = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+        policy.level       = 2;
+        policy.basket_size = 256 * 1024;
+        policy.auto_flush  = -64 * 1024 * 1024;
+        break;
+      case Preset::Default:
+        [[fallthrough]];
+      default:
+        break;
+    }
+    return policy;
+
+  }  // end 'GetPolicy(Preset)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to translate a preset name into a policy
+  // --------------------------------------------------------------------------
+  /*! Accepts "default", "fastwrite", "smallfile", or
+   *  "fastread" (case insensitive, '_' and '-' are
+   *  ignored).
+   */
+  inline Policy ParsePolicy(const std::string& name) {
+
+    std::string lower;
+    for (const char c : name) {
+      if ((c == '_') || (c == '-')) continue;
+      lower.push_back( std::tolower(c) );
+    }
+
+    if (lower == "fastwrite") {
+      return GetPolicy(Preset::FastWrite);
+    } else if (lower == "smallfile") {
+      return GetPolicy(Preset::SmallFile);
+    } else if (lower == "fastread") {
+      return GetPolicy(Preset::FastRead);
+    } else if (lower.empty() || (lower == "default")) {
+      return GetPolicy(Preset::Default);
+    } else {
+      std::cerr << "PANIC: unknown writer policy '" << name << "'!" << std::endl;
+      assert(lower == "default");
+      return GetPolicy(Preset::Default);
+    }
+
+  }  // end 'ParsePolicy(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to apply a policy to a tree
+  // --------------------------------------------------------------------------
+  /*! Compression is set per branch, so other objects
+   *  in the same file keep the file's settings.
+   */
+  inline void ApplyPolicy(TTree* tree, const Policy& policy) {
+
+    if (policy.algorithm != ROOT::RCompressionSetting::EAlgorithm::kUseGlobal) {
+      const int settings = ROOT::CompressionSettings(policy.algorithm, policy.level);
+      TObjArray* branches = tree -> GetListOfBranches();
+      for (int iBranch = 0; iBranch < branches -> GetEntriesFast(); ++iBranch) {
+        ((TBranch*) branches -> At(iBranch)) -> SetCompressionSettings(settings);
+      }
+    }
+    if (policy.basket_size != 0) tree -> SetBasketSize("*", policy.basket_size);
+    if (policy.auto_flush  != 0) tree -> SetAutoFlush(policy.auto_flush);
+    if (policy.auto_save   != 0) tree -> SetAutoSave(policy.auto_save);
+    return;
+
+  }  // end 'ApplyPolicy(TTree*, Policy&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to translate a policy into RNTuple write options
+  // --------------------------------------------------------------------------
+  inline ROOT::Experimental::RNTupleWriteOptions GetWriteOptions(const Policy& policy) {
+
+    ROOT::Experimental::RNTupleWriteOptions options;
+    if (policy.algorithm != ROOT::RCompressionSetting::EAlgorithm::kUseGlobal) {
+      options.SetCompression( ROOT::CompressionSettings(policy.algorithm, policy.level) );
+    }
+    if (policy.basket_size > 0) options.SetApproxUnzippedPageSize(policy.basket_size);
+    if (policy.auto_flush  < 0) options.SetApproxZippedClusterSize(-policy.auto_flush);
+    return options;
+
+  }  // end 'GetWriteOptions(Policy&)'
+
+
+
+  // ==========================================================================
+  //! Tuple Writer
+  // ==========================================================================
+  /*! Writes the values held by an NTupleHelper into
+   *  a file. With the tree backend a TNtuple (or a
+   *  TTree, if the helper has int/double/array
+   *  branches) is filled straight from the helper's
+   *  storage; with the RNTuple backend each field is
+   *  bound to the same storage, so neither path
+   *  copies per entry.
+   */
+  class Writer {
+
+    private:
+
+      // data members
+      Backend       m_backend;
+      NTupleHelper* m_helper = nullptr;
+      TTree*        m_tuple  = nullptr;
+
+      // rntuple members
+      std::unique_ptr<ROOT::Experimental::RNTupleWriter> m_writer;
+      std::unique_ptr<ROOT::Experimental::REntry>        m_entry;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline Backend  GetBackend() const {return m_backend;}
+      inline TTree*   GetTuple()   const {return m_tuple;}
+
+      // ----------------------------------------------------------------------
+      //! Fill with the helper's current values
+      // ----------------------------------------------------------------------
+      inline void Fill() {
+
+        switch (m_backend) {
+          case Backend::RNTuple:
+            m_helper -> PackValues();
+            m_writer -> Fill(*m_entry);
+            break;
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_helper -> Fill(m_tuple);
+            break;
+        }
+        return;
+
+      }  // end 'Fill()'
+
+      // ----------------------------------------------------------------------
+      //! Write tuple to its file
+      // ----------------------------------------------------------------------
+      /*! For the RNTuple backend this commits the dataset,
+       *  so it needs to be called before the file is closed.
+       */
+      inline void Write() {
+
+        if (m_helper && (m_helper -> GetNClamped() > 0)) {
+          std::cerr << "WARNING: " << m_helper -> GetNClamped()
+                    << " values were clamped to the range of a reduced-precision branch!"
+                    << std::endl;
+        }
+
+        switch (m_backend) {
+          case Backend::RNTuple:
+            m_entry.reset();
+            m_writer.reset();
+            break;
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_tuple -> Write();
+            break;
+        }
+        return;
+
+      }  // end 'Write()'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor
+      // ----------------------------------------------------------------------
+      Writer() {};
+
+      // ----------------------------------------------------------------------
+      //! dtor
+      // ----------------------------------------------------------------------
+      /*! Commits an RNTuple that was never written, so the
+       *  writer doesn't outlive its file (n.b. the writer
+       *  still has to go before the file is closed).
+       */
+      ~Writer() {
+        m_entry.reset();
+        m_writer.reset();
+      };
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a helper, an output file, and tuple name/title
+      // ----------------------------------------------------------------------
+      Writer(
+        NTupleHelper& helper,
+        TFile* file,
+        const std::string& name,
+        const std::string& title,
+        const Backend backend = Backend::Tree,
+        const Policy& policy = Policy()
+      ) {
+
+        m_backend = backend;
+        m_helper  = &helper;
+
+        file -> cd();
+        switch (m_backend) {
+
+          case Backend::RNTuple:
+            {
+              // create a field for each branch
+              const auto& branches = helper.GetBranches();
+              auto        model    = ROOT::Experimental::RNTupleModel::CreateBare();
+              for (std::size_t iBranch = 0; iBranch < branches.size(); ++iBranch) {
+                model -> AddField(
+                  ROOT::Experimental::RFieldBase::Create(
+                    branches[iBranch].name,
+                    helper.GetTypeName(iBranch)
+                  ).Unwrap()
+                );
+              }
+
+              // then bind each field to the helper's storage
+              m_writer = ROOT::Experimental::RNTupleWriter::Append(std::move(model), name, *file, GetWriteOptions(policy));
+              m_entry  = m_writer -> CreateEntry();
+              for (std::size_t iBranch = 0; iBranch < branches.size(); ++iBranch) {
+                m_entry -> BindRawPtr(branches[iBranch].name, helper.GetBranchAddress(iBranch));
+              }
+            }
+            break;
+
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            if (helper.IsFlat()) {
+              m_tuple = new TNtuple(name.data(), title.data(), helper.CompressVariables().data());
+            } else {
+              m_tuple = new TTree(name.data(), title.data());
+              helper.CreateBranches(m_tuple);
+            }
+            ApplyPolicy(m_tuple, policy);
+            break;
+
+        }
+
+      }  // end ctor(NTupleHelper&, TFile*, std::string&, std::string&, Backend, Policy&)'
+
+  };  // end NTupleIO::Writer
+
+
+
+  // ==========================================================================
+  //! Tuple Reader
+  // ==========================================================================
+  /*! Reads entries of a tuple into the buffer of an
+   *  NTupleHelper, whichever backend the tuple was
+   *  written with (or from a feature cache made from
+   *  it).
+   */
+  class Reader {
+
+    private:
+
+      // data members
+      Backend       m_backend;
+      std::string   m_name;
+      std::string   m_path;
+      bool          m_bound  = false;
+      NTupleHelper* m_helper = nullptr;
+      TTree*        m_tree   = nullptr;
+
+      // cache members
+      const FeatureCache*      m_cache = nullptr;
+      std::vector<std::size_t> m_columns;
+
+      // names of variables to read (empty if reading all)
+      std::vector<std::string> m_projection;
+
+      // rntuple members
+      std::unique_ptr<ROOT::Experimental::RNTupleReader> m_reader;
+      std::unique_ptr<ROOT::Experimental::REntry>        m_entry;
+      std::unique_ptr<NTupleHelper>                      m_bridge;
+
+      // ----------------------------------------------------------------------
+      //! Bind helper to the tuple
+      // ----------------------------------------------------------------------
+      /*! Done lazily so that a reader whose tree is only
+       *  handed to TMVA never points the tree at the
+       *  helper's buffer.
+       */
+      inline void Bind() {
+
+        switch (m_backend) {
+          case Backend::RNTuple:
+            m_entry = m_reader -> GetModel().CreateBareEntry();
+            BindEntry(*m_helper, *m_entry, m_reader -> GetDescriptor());
+            break;
+          case Backend::Cache:
+            break;
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_helper -> SetBranches(m_tree);
+            break;
+        }
+        m_bound = true;
+        return;
+
+      }  // end 'Bind()'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline Backend       GetBackend() const {return m_backend;}
+      inline std::string   GetName()    const {return m_name;}
+      inline NTupleHelper* GetHelper()  const {return m_helper;}
+
+      // ----------------------------------------------------------------------
+      //! Get number of entries
+      // ----------------------------------------------------------------------
+      inline uint64_t GetEntries() const {
+
+        switch (m_backend) {
+          case Backend::RNTuple:
+            return m_reader -> GetNEntries();
+          case Backend::Cache:
+            return m_cache -> GetRows();
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            return m_tree -> GetEntries();
+        }
+
+      }  // end 'GetEntries()'
+
+      // ----------------------------------------------------------------------
+      //! Load an entry into the helper
+      // ----------------------------------------------------------------------
+      /*! Returns the number of bytes read for the tree
+       *  and cache backends (negative on error), and 1
+       *  for RNTuple which doesn't report bytes per entry.
+       */
+      inline int64_t GetEntry(const uint64_t entry) {
+
+        if (!m_bound) Bind();
+        switch (m_backend) {
+          case Backend::RNTuple:
+            m_reader -> LoadEntry(entry, *m_entry);
+            m_helper -> UnpackValues();
+            return 1;
+          case Backend::Cache:
+            {
+              std::span<float> values = m_helper -> GetValueSpan();
+              for (std::size_t iVar = 0; iVar < values.size(); ++iVar) {
+                values[iVar] = m_cache -> GetValue(entry, m_columns[iVar]);
+              }
+              return values.size() * sizeof(float);
+            }
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            return m_helper -> GetEntry(m_tree, entry);
+        }
+
+      }  // end 'GetEntry(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Only read the listed variables
+      // ----------------------------------------------------------------------
+      /*! Everything else is skipped on disk: tree
+       *  branches are switched off, and RNTuples are
+       *  reopened with a model holding only the needed
+       *  fields. Names the helper doesn't know about
+       *  (e.g. extra branches in a cut) are switched on
+       *  for trees if present. Caches are already in
+       *  memory, so nothing changes for them.
+       */
+      inline void SetActiveVariables(const std::vector<std::string>& names) {
+
+        m_projection = names;
+        m_helper -> SetActive(names);
+        switch (m_backend) {
+
+          case Backend::RNTuple:
+            {
+              const auto& descriptor = m_reader -> GetDescriptor();
+              const auto& branches   = m_helper -> GetBranches();
+
+              // mirror how BindEntry will bind each branch
+              auto model = ROOT::Experimental::RNTupleModel::CreateBare();
+              for (std::size_t iBranch = 0; iBranch < branches.size(); ++iBranch) {
+                if (!m_helper -> IsActive(iBranch)) continue;
+
+                const auto iField  = descriptor.FindFieldId(branches[iBranch].name);
+                const bool isTyped = (iField != ROOT::Experimental::kInvalidDescriptorId)
+                  && (descriptor.GetFieldDescriptor(iField).GetTypeName() == m_helper -> GetTypeName(iBranch));
+                if (isTyped) {
+                  model -> AddField(
+                    ROOT::Experimental::RFieldBase::Create(branches[iBranch].name, m_helper -> GetTypeName(iBranch)).Unwrap()
+                  );
+                  continue;
+                }
+                for (std::size_t iElem = 0; iElem < branches[iBranch].size; ++iElem) {
+                  const std::string& var = m_helper -> GetVariables()[branches[iBranch].first + iElem];
+                  model -> AddField( ROOT::Experimental::RFieldBase::Create(var, "float").Unwrap() );
+                }
+              }
+              m_entry.reset();
+              m_reader = ROOT::Experimental::RNTupleReader::Open(std::move(model), m_name, m_path);
+              m_bound  = false;
+            }
+            break;
+
+          case Backend::Cache:
+            break;
+
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_helper -> SetBranchStatus(m_tree);
+            for (const std::string& name : names) {
+              if (m_tree -> GetBranch(name.data())) {
+                m_tree -> SetBranchStatus(name.data(), true);
+              }
+            }
+            break;
+
+        }
+        return;
+
+      }  // end 'SetActiveVariables(std::vector<std::string>&)'
+
+      // ----------------------------------------------------------------------
+      //! Get compressed size of the tree's branches
+      // ----------------------------------------------------------------------
+      /*! Either of every branch or only of the ones that
+       *  are switched on, to see how much reading is
+       *  saved by `SetActiveVariables`. Only meaningful
+       *  for the tree backend (returns 0 otherwise).
+       */
+      inline int64_t GetZipBytes(const bool activeOnly = false) const {
+
+        if (m_backend != Backend::Tree) return 0;
+
+        int64_t    bytes    = 0;
+        TObjArray* branches = m_tree -> GetListOfBranches();
+        for (int iBranch = 0; iBranch < branches -> GetEntriesFast(); ++iBranch) {
+          TBranch* branch = (TBranch*) branches -> At(iBranch);
+          if (activeOnly && !m_tree -> GetBranchStatus(branch -> GetName())) continue;
+          bytes += branch -> GetZipBytes("*");
+        }
+        return bytes;
+
+      }  // end 'GetZipBytes(bool)'
+
+      // ----------------------------------------------------------------------
+      //! Get a TTree holding the tuple
+      // ----------------------------------------------------------------------
+      /*! TMVA's data loader and TTreeFormula both need a
+       *  TTree. With the tree backend this is simply the
+       *  tree on disk. With RNTuple or a cache, a
+       *  memory-resident tree is filled once from it, so
+       *  anything that needs a TTree still works (at the
+       *  cost of holding the tuple in memory).
+       */
+      inline TTree* GetTree() {
+
+        // if tree already exists, return it
+        if (m_tree) return m_tree;
+
+        // otherwise build a transient one through a separate
+        // helper so the caller's buffer isn't tied to it
+        m_bridge = std::make_unique<NTupleHelper>(
+          m_helper -> GetVariables(),
+          m_helper -> GetBranches()
+        );
+        if (!m_projection.empty()) {
+          m_bridge -> SetActive(m_projection);
+        }
+
+        m_tree = new TTree(m_name.data(), "Transient copy of tuple");
+        m_tree -> SetDirectory(nullptr);
+        m_bridge -> CreateBranches(m_tree);
+
+        // cache rows can be copied straight into the bridge
+        if (m_backend == Backend::Cache) {
+          std::span<float> values = m_bridge -> GetValueSpan();
+          for (uint64_t iEntry = 0; iEntry < m_cache -> GetRows(); ++iEntry) {
+            for (std::size_t iVar = 0; iVar < values.size(); ++iVar) {
+              values[iVar] = m_cache -> GetValue(iEntry, m_columns[iVar]);
+            }
+            m_bridge -> Fill(m_tree);
+          }
+          return m_tree;
+        }
+
+        auto entry = m_reader -> GetModel().CreateBareEntry();
+        BindEntry(*m_bridge, *entry, m_reader -> GetDescriptor());
+        for (uint64_t iEntry = 0; iEntry < m_reader -> GetNEntries(); ++iEntry) {
+          m_reader -> LoadEntry(iEntry, *entry);
+          m_bridge -> UnpackValues();
+          m_bridge -> Fill(m_tree);
+        }
+        return m_tree;
+
+      }  // end 'GetTree()'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Reader()  {};
+      ~Reader() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a helper, an input file, and a tuple name
+      // ----------------------------------------------------------------------
+      Reader(
+        NTupleHelper& helper,
+        TFile* file,
+        const std::string& name,
+        const Backend backend = Backend::Tree
+      ) {
+
+        m_backend = backend;
+        m_helper  = &helper;
+        m_name    = name;
+        m_path    = file -> GetName();
+
+        switch (m_backend) {
+          case Backend::RNTuple:
+            m_reader = ROOT::Experimental::RNTupleReader::Open(m_name, m_path);
+            break;
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_tree = (TTree*) file -> Get(m_name.data());
+            if (!m_tree) {
+              std::cerr << "PANIC: couldn't grab tuple '" << m_name << "' from '" << m_path << "'!" << std::endl;
+              assert(m_tree);
+            }
+            break;
+        }
+
+      }  // end ctor(NTupleHelper&, TFile*, std::string&, Backend)'
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a helper, a feature cache, and a tuple name
+      // ----------------------------------------------------------------------
+      /*! Each of the helper's variables has to be a
+       *  column of the cache.
+       */
+      Reader(
+        NTupleHelper& helper,
+        const FeatureCache& cache,
+        const std::string& name
+      ) {
+
+        m_backend = Backend::Cache;
+        m_helper  = &helper;
+        m_cache   = &cache;
+        m_name    = name;
+        m_path    = cache.GetPath();
+
+        // map helper variables onto cache columns
+        const auto& columns = cache.GetVariables();
+        for (const std::string& var : helper.GetVariables()) {
+          const auto column = std::find(columns.begin(), columns.end(), var);
+          if (column == columns.end()) {
+            std::cerr << "PANIC: variable '" << var << "' isn't in cache '" << m_path << "'!" << std::endl;
+            assert(column != columns.end());
+          }
+          m_columns.push_back( std::distance(columns.begin(), column) );
+        }
+        m_bound = true;
+
+      }  // end ctor(NTupleHelper&, FeatureCache&, std::string&)'
+
+  };  // end NTupleIO::Reader
+
+
+
+  // ==========================================================================
+  //! Entry Selector
+  // ==========================================================================
+  /*! Evaluates a TCut on the entry currently loaded by
+   *  a Reader. Trees use a TTreeFormula as before; for
+   *  other backends the cut is translated into a
+   *  TFormula over the helper's buffer, with each
+   *  variable name replaced by 'x[index]'.
+   */
+  class Selector {
+
+    private:
+
+      // data members
+      bool                          m_always = false;
+      NTupleHelper*                 m_helper = nullptr;
+      std::unique_ptr<TTreeFormula> m_tree_formula;
+      std::unique_ptr<TFormula>     m_formula;
+      std::vector<double>           m_args;
+
+      // ----------------------------------------------------------------------
+      //! Translate a cut into a TFormula expression
+      // ----------------------------------------------------------------------
+      inline std::string TranslateCut(const std::string& cut) const {
+
+        std::string translated;
+        std::size_t iChar = 0;
+        while (iChar < cut.size()) {
+
+          // copy anything that can't start an identifier
+          const char start = cut[iChar];
+          if (!std::isalpha(start) && (start != '_')) {
+            translated.push_back(start);
+            ++iChar;
+            continue;
+          }
+
+          // otherwise grab full identifier
+          std::size_t iEnd = iChar;
+          while ((iEnd < cut.size()) && (std::isalnum(cut[iEnd]) || (cut[iEnd] == '_'))) {
+            ++iEnd;
+          }
+          const std::string word = cut.substr(iChar, iEnd - iChar);
+
+          // and swap it for an index if it's a variable
+          const auto& vars = m_helper -> GetVariables();
+          const auto  iVar = std::find(vars.begin(), vars.end(), word);
+          if (iVar != vars.end()) {
+            translated.append( "x[" + std::to_string(std::distance(vars.begin(), iVar)) + "]" );
+          } else {
+            translated.append( word );
+          }
+          iChar = iEnd;
+        }
+        return translated;
+
+      }  // end 'TranslateCut(std::string&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Check if current entry passes the cut
+      // ----------------------------------------------------------------------
+      inline bool Pass() {
+
+        if (m_always) return true;
+        if (m_tree_formula) return m_tree_formula -> EvalInstance();
+
+        const auto values = m_helper -> GetValueSpan();
+        std::copy(values.begin(), values.end(), m_args.begin());
+        return m_formula -> EvalPar(m_args.data());
+
+      }  // end 'Pass()'
+
+      // ----------------------------------------------------------------------
+      //! Check if an entry passes the cut
+      // ----------------------------------------------------------------------
+      /*! For readers that don't load entries into the
+       *  helper (e.g. bulk reads of a tree): the tree
+       *  formula loads the branches it needs itself.
+       *  Other backends still read the helper's buffer.
+       */
+      inline bool Pass(const uint64_t entry) {
+
+        if (m_always) return true;
+        if (!m_tree_formula) return Pass();
+
+        m_tree_formula -> GetTree() -> LoadTree(entry);
+        m_tree_formula -> GetNdata();
+        return m_tree_formula -> EvalInstance();
+
+      }  // end 'Pass(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Selector()  {};
+      ~Selector() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a cut and the reader it applies to
+      // ----------------------------------------------------------------------
+      Selector(const std::string& name, const TCut& cut, Reader& reader) {
+
+        m_helper = reader.GetHelper();
+
+        // empty cuts always pass
+        const std::string expression = cut.GetTitle();
+        if (expression.empty()) {
+          m_always = true;
+          return;
+        }
+
+        switch (reader.GetBackend()) {
+          case Backend::Cache:
+            [[fallthrough]];
+          case Backend::RNTuple:
+            m_args.resize( m_helper -> GetVariables().size() );
+            m_formula = std::make_unique<TFormula>(name.data(), TranslateCut(expression).data(), false);
+            break;
+          case Backend::Tree:
+            [[fallthrough]];
+          default:
+            m_tree_formula = std::make_unique<TTreeFormula>(name.data(), expression.data(), reader.GetTree());
+            break;
+        }
+
+      }  // end ctor(std::string&, TCut&, Reader&)'
+
+  };  // end NTupleIO::Selector
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to write the selected entries of a tuple to a cache
+  // --------------------------------------------------------------------------
+  /*! Writes every entry of `source` passing `cut` as a
+   *  row of a feature cache, with one column per
+   *  variable of the source's helper.
+   */
+  inline bool WriteCache(
+    Reader& source,
+    const TCut& cut,
+    const std::string& path,
+    const uint64_t sourceHash,
+    const FeatureCache::Layout layout = FeatureCache::Layout::Row
+  ) {
+
+    NTupleHelper*         helper = source.GetHelper();
+    Selector              selector("cacheSelector", cut, source);
+    FeatureCache::Builder builder(path, helper -> GetVariables(), sourceHash, cut.GetTitle(), layout);
+    for (uint64_t iEntry = 0; iEntry < source.GetEntries(); ++iEntry) {
+      if (source.GetEntry(iEntry) < 0) {
+        std::cerr << "WARNING error in entry #" << iEntry << "! Not writing cache!" << std::endl;
+        return false;
+      }
+      if (!selector.Pass()) continue;
+      if (!builder.Append( helper -> GetValueSpan() )) {
+        std::cerr << "WARNING couldn't write entry #" << iEntry << " to cache!" << std::endl;
+        return false;
+      }
+    }
+    return builder.Close();
+
+  }  // end 'WriteCache(Reader&, TCut&, std::string&, uint64_t, FeatureCache::Layout)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to open a cache, (re)building it if it's stale
+  // --------------------------------------------------------------------------
+  /*! A cache is reused only if it was made from the
+   *  same file (`sourceHash`, see
+   *  FeatureCache::HashFile), with the same variables
+   *  and the same cut; otherwise it's rebuilt from the
+   *  tuple `name` in `file`. Returns true if the cache
+   *  had to be (re)built. If it couldn't be, a warning
+   *  is printed and the cache is left closed (see
+   *  FeatureCache::IsOpen), so the caller can read the
+   *  tuple directly instead.
+   */
+  inline bool UpdateCache(
+    FeatureCache& cache,
+    NTupleHelper& helper,
+    TFile* file,
+    const std::string& name,
+    const Backend backend,
+    const TCut& cut,
+    const uint64_t sourceHash,
+    const std::string& path,
+    const FeatureCache::Layout layout = FeatureCache::Layout::Row
+  ) {
+
+    cache.Open(path);
+    if (cache.Matches(sourceHash, helper.GetVariables(), cut.GetTitle())) return false;
+
+    // release any stale mapping before rewriting
+    cache.Close();
+    bool isWritten = false;
+    {
+      Reader source(helper, file, name, backend);
+      isWritten = WriteCache(source, cut, path, sourceHash, layout);
+    }
+
+    // never fall back on the stale cache
+    if (!isWritten) {
+      std::remove(path.data());
+      std::remove((path + ".tmp").data());
+    }
+
+    const bool isGood = cache.Open(path) && cache.Matches(sourceHash, helper.GetVariables(), cut.GetTitle());
+    if (!isGood) {
+      std::cerr << "WARNING couldn't build feature cache '" << path << "'!" << std::endl;
+      cache.Close();
+    }
+    return true;
+
+  }  // end 'UpdateCache(FeatureCache&, NTupleHelper&, TFile*, std::string&, Backend, TCut&, uint64_t, std::string&, FeatureCache::Layout)'
+
+}  // end NTupleIO namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,332 @@
+/// ===========================================================================
+/*! \file   NativeForest.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A native evaluator for gradient-boosted regression
+ *  forests (TMVA's BDTG) with a flattened node layout.
+ */
+/// ===========================================================================
+
+#ifndef NativeForest_hxx
+#define NativeForest_hxx
+
+// c++ utilities
+#include <span>
+#include <deque>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+// root libraries
+#include <TXMLEngine.h>
+// analysis utilities
+#include "NativeModel.hxx"
+
+
+
+namespace NativeModel {
+
+  // ==========================================================================
+  //! Native BDTG forest
+  // ==========================================================================
+  /*! Nodes of every tree are stored breadth-first in
+   *  flat arrays (structure-of-arrays):
+   *
+   *    - feature:   variable cut on, or -1 for a leaf,
+   *    - threshold: cut value, or the response of a leaf,
+   *    - child:     index of the first of the two
+   *                 (adjacent) children.
+   *
+   *  Children are stored so that a row goes to the
+   *  second child iff `x >= threshold`, which folds in
+   *  TMVA's cut type. A forest is evaluated tree by tree
+   *  over the whole batch, so one tree stays hot while
+   *  every row walks it.
+   *
+   *  As in TMVA::MethodBDT, the output of a regression
+   *  forest boosted with "Grad" is the sum of the leaf
+   *  responses plus the boost weight of the first tree.
+   */
+  class Forest : public Base {
+
+    private:
+
+      // flattened nodes
+      std::vector<int32_t> m_feature;
+      std::vector<float>   m_threshold;
+      std::vector<int32_t> m_child;
+      std::vector<int32_t> m_roots;
+      double               m_offset = 0.;
+
+      // ----------------------------------------------------------------------
+      //! Flatten a tree from its xml nodes
+      // ----------------------------------------------------------------------
+      inline bool AddTree(TXMLEngine& xml, XMLNodePointer_t top) {
+
+        m_roots.push_back( m_feature.size() );
+
+        // walk tree breadth-first, reserving slots for
+        // both children of a node when it's reached
+        std::deque<std::pair<XMLNodePointer_t, int32_t>> queue = { {top, (int32_t) m_feature.size()} };
+        m_feature.push_back(-1);
+        m_threshold.push_back(0.);
+        m_child.push_back(-1);
+        while (!queue.empty()) {
+
+          auto [node, index] = queue.front();
+          queue.pop_front();
+
+          // find children
+          XMLNodePointer_t left  = nullptr;
+          XMLNodePointer_t right = nullptr;
+          for (XMLNodePointer_t child = xml.GetChild(node); child; child = xml.GetNext(child)) {
+            const std::string pos = GetAttr(xml, child, "pos");
+            if (pos == "l") left  = child;
+            if (pos == "r") right = child;
+          }
+
+          // leaves only keep their response
+          if (!left && !right) {
+            m_threshold[index] = GetFloatAttr(xml, node, "res");
+            continue;
+          }
+          if (!left || !right || (std::atoi(GetAttr(xml, node, "NCoef").data()) > 0)) {
+            std::cerr << "WARNING: forest has incomplete nodes or Fisher cuts!" << std::endl;
+            return false;
+          }
+
+          // TMVA goes right iff (x >= cut) == cType
+          const bool cutType = (std::atoi(GetAttr(xml, node, "cType").data()) != 0);
+          m_feature[index]   = std::atoi(GetAttr(xml, node, "IVar").data());
+          m_threshold[index] = GetFloatAttr(xml, node, "Cut");
+          if ((m_feature[index] < 0) || (m_feature[index] >= (int32_t) m_variables.size())) {
+            std::cerr << "WARNING: forest cuts on unknown variable #" << m_feature[index] << "!" << std::endl;
+            return false;
+          }
+
+          const int32_t first = m_feature.size();
+          m_child[index] = first;
+          for (int32_t iChild = 0; iChild < 2; ++iChild) {
+            m_feature.push_back(-1);
+            m_threshold.push_back(0.);
+            m_child.push_back(-1);
+          }
+          queue.push_back( {cutType ? left : right, first} );
+          queue.push_back( {cutType ? right : left, first + 1} );
+        }
+        return true;
+
+      }  // end 'AddTree(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write a node (and everything below it) as an expression
+      // ----------------------------------------------------------------------
+      inline void WriteNode(std::ostream& out, const int32_t index, const std::vector<std::string>& inputs) const {
+
+        char value[64];
+        std::snprintf(value, sizeof(value), "%a", m_threshold[index]);
+        if (m_feature[index] < 0) {
+          out << "(double) " << value << "f";
+          return;
+        }
+
+        out << "((" << inputs[m_feature[index]] << " >= " << value << "f) ? ";
+        WriteNode(out, m_child[index] + 1, inputs);
+        out << " : ";
+        WriteNode(out, m_child[index], inputs);
+        out << ")";
+        return;
+
+      }  // end 'WriteNode(std::ostream&, int32_t, std::vector<std::string>&)'
+
+    protected:
+
+      // ----------------------------------------------------------------------
+      //! Read forest from <Weights> block
+      // ----------------------------------------------------------------------
+      inline bool ReadWeights(TXMLEngine& xml, XMLNodePointer_t root) override {
+
+        if (GetOption(xml, root, "BoostType") != "Grad") {
+          std::cerr << "WARNING: only forests boosted with 'Grad' can be evaluated natively!" << std::endl;
+          return false;
+        }
+        if (m_targets.size() != 1) {
+          std::cerr << "WARNING: only single-target forests can be evaluated natively!" << std::endl;
+          return false;
+        }
+
+        XMLNodePointer_t weights = FindChild(xml, root, "Weights");
+        if (!weights) return false;
+
+        bool isFirst = true;
+        for (XMLNodePointer_t tree = xml.GetChild(weights); tree; tree = xml.GetNext(tree)) {
+          if (std::string("BinaryTree") != xml.GetNodeName(tree)) continue;
+          if (isFirst) {
+            m_offset = std::strtod(GetAttr(xml, tree, "boostWeight").data(), nullptr);
+            isFirst  = false;
+          }
+
+          XMLNodePointer_t top = FindChild(xml, tree, "Node");
+          if (!top || !AddTree(xml, top)) return false;
+        }
+        return !m_roots.empty();
+
+      }  // end 'ReadWeights(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write flattened forest to a binary stream
+      // ----------------------------------------------------------------------
+      inline void WriteState(std::ostream& out) const override {
+
+        WriteVector(out, m_feature);
+        WriteVector(out, m_threshold);
+        WriteVector(out, m_child);
+        WriteVector(out, m_roots);
+        out.write((const char*) &m_offset, sizeof(m_offset));
+        return;
+
+      }  // end 'WriteState(std::ostream&)'
+
+      // ----------------------------------------------------------------------
+      //! Read flattened forest from a binary stream
+      // ----------------------------------------------------------------------
+      inline bool ReadState(std::istream& in) override {
+
+        return ReadVector(in, m_feature)
+            && ReadVector(in, m_threshold)
+            && ReadVector(in, m_child)
+            && ReadVector(in, m_roots)
+            && in.read((char*) &m_offset, sizeof(m_offset)).good();
+
+      }  // end 'ReadState(std::istream&)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate a batch of rows tree by tree
+      // ----------------------------------------------------------------------
+      inline void EvaluateBatch(
+        std::span<const float* const> inputs,
+        const std::size_t nRows,
+        std::span<float* const> outputs,
+        Context& context
+      ) const override {
+
+        // running sums of the batch
+        std::vector<double>& sums = context.values;
+        sums.assign(nRows, 0.);
+        for (const int32_t root : m_roots) {
+          for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+            int32_t node = root;
+            while (m_feature[node] >= 0) {
+              node = m_child[node] + (inputs[m_feature[node]][iRow] >= m_threshold[node]);
+            }
+            sums[iRow] += m_threshold[node];
+          }
+        }
+
+        for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+          outputs[0][iRow] = sums[iRow] + m_offset;
+        }
+        return;
+
+      }  // end 'EvaluateBatch(std::span<const float* const>, std::size_t, std::span<float* const>, Context&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline std::size_t GetNTrees() const {return m_roots.size();}
+      inline std::size_t GetNNodes() const {return m_feature.size();}
+
+      // ----------------------------------------------------------------------
+      //! Write forest out as a standalone C++ function
+      // ----------------------------------------------------------------------
+      /*! Generates `float <name>(const float* x)`, taking
+       *  the untransformed variables in the order of
+       *  `GetVariables()`, with every tree hard-coded.
+       *  Returns false if the file couldn't be written.
+       */
+      inline bool WriteSource(const std::string& path, const std::string& name) const {
+
+        std::ofstream out(path);
+        if (!out.good()) {
+          std::cerr << "WARNING: couldn't write '" << path << "'!" << std::endl;
+          return false;
+        }
+
+        out << "// generated from '" << m_path << "'\n"
+            << "// inputs:\n";
+        for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+          out << "//   x[" << iVar << "] = " << m_variables[iVar] << "\n";
+        }
+        out << "// output: " << m_targets.front() << "\n\n"
+            << "inline float " << name << "(const float* x) {\n\n";
+
+        // normalize inputs if needed
+        std::vector<std::string> inputs;
+        for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+          if (m_normalize && m_norm_vars[iVar]) {
+            char line[256];
+            std::snprintf(
+              line,
+              sizeof(line),
+              "  const float t%zu = (x[%zu] - %af) * (float) (1.0 / (%af - %af)) * 2 - 1;\n",
+              iVar,
+              iVar,
+              m_var_min[iVar],
+              m_var_max[iVar],
+              m_var_min[iVar]
+            );
+            out << line;
+            inputs.push_back( "t" + std::to_string(iVar) );
+          } else {
+            inputs.push_back( "x[" + std::to_string(iVar) + "]" );
+          }
+        }
+
+        // sum trees
+        out << "  double sum = 0.;\n";
+        for (std::size_t iTree = 0; iTree < m_roots.size(); ++iTree) {
+          out << "  sum += ";
+          WriteNode(out, m_roots[iTree], inputs);
+          out << ";\n";
+        }
+
+        // add offset & transform target back if needed
+        char line[256];
+        std::snprintf(line, sizeof(line), "  const float value = sum + %a;\n", m_offset);
+        out << line;
+        if (m_normalize && m_norm_targets.front()) {
+          std::snprintf(
+            line,
+            sizeof(line),
+            "  const float scale = 1.0 / (%af - %af);\n  return (value + 1) / (scale * 2) + %af;\n",
+            m_target_max.front(),
+            m_target_min.front(),
+            m_target_min.front()
+          );
+          out << line;
+        } else {
+          out << "  return value;\n";
+        }
+        out << "\n}\n";
+        return out.good();
+
+      }  // end 'WriteSource(std::string&, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Forest()  {};
+      ~Forest() {};
+
+  };  // end NativeModel::Forest
+
+}  // end NativeModel namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,634 @@
+/// ===========================================================================
+/*! \file   NativeModel.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Base for evaluating trained TMVA models straight
+ *  from their weight files, without TMVA::Reader.
+ */
+/// ===========================================================================
+
+#ifndef NativeModel_hxx
+#define NativeModel_hxx
+
+// c++ utilities
+#include <map>
+#include <span>
+#include <mutex>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TXMLEngine.h>
+// analysis utilities
+#include "FeatureCache.hxx"
+
+
+
+// ============================================================================
+//! Native Model
+// ============================================================================
+/*! Utilities shared by the native evaluators: reading
+ *  the parts of a TMVA weight file that every method
+ *  writes (variables, targets, transformations), and
+ *  applying the input/target transformation around a
+ *  method's own evaluation, caching parsed models in
+ *  binary files, and sharing loaded models between
+ *  threads.
+ */
+namespace NativeModel {
+
+  // version of the binary cache layout
+  //   - n.b. bump whenever what a model writes changes
+  static constexpr uint32_t CacheVersion = 1;
+
+  // --------------------------------------------------------------------------
+  //! Find first child of a node with a given name
+  // --------------------------------------------------------------------------
+  inline XMLNodePointer_t FindChild(TXMLEngine& xml, XMLNodePointer_t node, const std::string& name) {
+
+    for (XMLNodePointer_t child = xml.GetChild(node); child; child = xml.GetNext(child)) {
+      if (name == xml.GetNodeName(child)) return child;
+    }
+    return nullptr;
+
+  }  // end 'FindChild(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Get an attribute of a node as a string (empty if missing)
+  // --------------------------------------------------------------------------
+  inline std::string GetAttr(TXMLEngine& xml, XMLNodePointer_t node, const std::string& name) {
+
+    const char* value = xml.GetAttr(node, name.data());
+    return value ? std::string(value) : std::string();
+
+  }  // end 'GetAttr(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Get an attribute of a node as a float
+  // --------------------------------------------------------------------------
+  /*! n.b. TMVA reads most of its parameters into
+   *  Float_t, so they're parsed the same way here.
+   */
+  inline float GetFloatAttr(TXMLEngine& xml, XMLNodePointer_t node, const std::string& name) {
+
+    const char* value = xml.GetAttr(node, name.data());
+    return value ? std::strtof(value, nullptr) : 0.;
+
+  }  // end 'GetFloatAttr(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Get the value of a method option from the <Options> block
+  // --------------------------------------------------------------------------
+  inline std::string GetOption(TXMLEngine& xml, XMLNodePointer_t root, const std::string& name) {
+
+    XMLNodePointer_t options = FindChild(xml, root, "Options");
+    if (!options) return "";
+
+    for (XMLNodePointer_t option = xml.GetChild(options); option; option = xml.GetNext(option)) {
+      if (GetAttr(xml, option, "name") == name) {
+        const char* content = xml.GetNodeContent(option);
+        return content ? std::string(content) : std::string();
+      }
+    }
+    return "";
+
+  }  // end 'GetOption(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Get the method type (e.g. "BDT") of a weight file
+  // --------------------------------------------------------------------------
+  /*! Only the start of the file is scanned for the
+   *  `Method` attribute of <MethodSetup>, so this stays
+   *  cheap for large weight files. Returns an empty
+   *  string if it isn't found.
+   */
+  inline std::string GetMethodType(const std::string& path) {
+
+    std::ifstream file(path);
+    std::string   head(4096, '\0');
+    file.read(head.data(), head.size());
+    head.resize(file.gcount());
+
+    const std::size_t start = head.find("Method=\"");
+    if (start == std::string::npos) return "";
+
+    const std::string method = head.substr(start + 8, head.find('"', start + 8) - start - 8);
+    return method.substr(0, method.find("::"));
+
+  }  // end 'GetMethodType(std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Get path of the binary cache of a weight file
+  // --------------------------------------------------------------------------
+  /*! e.g. 'weights/X_BDTG.weights.xml' is cached in
+   *  'weights/X_BDTG.weights.native'.
+   */
+  inline std::string GetCachePath(const std::string& path) {
+
+    const bool isXml = (path.size() > 4) && (path.compare(path.size() - 4, 4, ".xml") == 0);
+    return (isXml ? path.substr(0, path.size() - 4) : path) + ".native";
+
+  }  // end 'GetCachePath(std::string&)'
+
+  // --------------------------------------------------------------------------
+  //! Write a vector of plain values to a binary stream
+  // --------------------------------------------------------------------------
+  template <typename T> inline void WriteVector(std::ostream& out, const std::vector<T>& values) {
+
+    const uint64_t size = values.size();
+    out.write((const char*) &size, sizeof(size));
+    out.write((const char*) values.data(), size * sizeof(T));
+    return;
+
+  }  // end 'WriteVector(std::ostream&, std::vector<T>&)'
+
+  // --------------------------------------------------------------------------
+  //! Read a vector of plain values from a binary stream
+  // --------------------------------------------------------------------------
+  template <typename T> inline bool ReadVector(std::istream& in, std::vector<T>& values) {
+
+    uint64_t size = 0;
+    in.read((char*) &size, sizeof(size));
+    if (!in.good()) return false;
+
+    values.resize(size);
+    in.read((char*) values.data(), size * sizeof(T));
+    return in.good();
+
+  }  // end 'ReadVector(std::istream&, std::vector<T>&)'
+
+  // --------------------------------------------------------------------------
+  //! Write a list of strings to a binary stream
+  // --------------------------------------------------------------------------
+  inline void WriteStrings(std::ostream& out, const std::vector<std::string>& strings) {
+
+    const uint64_t size = strings.size();
+    out.write((const char*) &size, sizeof(size));
+    for (const std::string& string : strings) {
+      WriteVector(out, std::vector<char>(string.begin(), string.end()));
+    }
+    return;
+
+  }  // end 'WriteStrings(std::ostream&, std::vector<std::string>&)'
+
+  // --------------------------------------------------------------------------
+  //! Read a list of strings from a binary stream
+  // --------------------------------------------------------------------------
+  inline bool ReadStrings(std::istream& in, std::vector<std::string>& strings) {
+
+    uint64_t size = 0;
+    in.read((char*) &size, sizeof(size));
+    if (!in.good()) return false;
+
+    strings.clear();
+    for (uint64_t iString = 0; iString < size; ++iString) {
+      std::vector<char> chars;
+      if (!ReadVector(in, chars)) return false;
+      strings.emplace_back(chars.begin(), chars.end());
+    }
+    return true;
+
+  }  // end 'ReadStrings(std::istream&, std::vector<std::string>&)'
+
+
+
+  // ==========================================================================
+  //! Evaluation context
+  // ==========================================================================
+  /*! Scratch space for evaluating models. Models are
+   *  immutable once loaded, so one model can be shared
+   *  by every thread; each thread instead evaluates
+   *  with its own context, which only holds buffers
+   *  sized to a batch. A context can be reused across
+   *  models.
+   */
+  struct Context {
+    std::vector<float>                      inputs;     // transformed inputs
+    std::vector<const float*>               columns;    // columns of (transformed) inputs
+    std::vector<double>                     values;     // running sums, activations
+    std::vector<float>                      query;      // scaled query point (KNN)
+    std::vector<std::pair<float, uint32_t>> neighbors;  // nearest points found (KNN)
+  };
+
+
+
+  // ==========================================================================
+  //! Base evaluator
+  // ==========================================================================
+  /*! Derived classes read their weights in `ReadWeights`
+   *  and evaluate a batch of (already transformed) rows
+   *  in `EvaluateBatch`. Inputs are passed as one array
+   *  per variable, outputs as one array per target, so
+   *  a block of entries can be evaluated in place.
+   *
+   *  Derived classes also write & read everything they
+   *  parsed in `WriteState` and `ReadState`, so a model
+   *  can be cached in a binary file (keyed by the hash
+   *  of its weight file's contents, see
+   *  FeatureCache::HashFile) and loaded from there next
+   *  time instead of parsing the xml again.
+   *
+   *  Evaluation is const & keeps all scratch space in
+   *  a `Context`, so a loaded model is safe to share
+   *  between threads (see `Share`).
+   */
+  class Base {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Outcomes of reading a binary cache
+      // ----------------------------------------------------------------------
+      enum class CacheStatus {Stale, Good, Corrupt};
+
+    protected:
+
+      // data members
+      std::string              m_path;
+      uint64_t                 m_hash = 0;
+      std::vector<std::string> m_variables;
+      std::vector<std::string> m_targets;
+
+      // normalization of variables & targets
+      //   - n.b. a flag is set for each variable/target
+      //     the transformation applies to
+      bool               m_normalize = false;
+      std::vector<bool>  m_norm_vars;
+      std::vector<bool>  m_norm_targets;
+      std::vector<float> m_var_min;
+      std::vector<float> m_var_max;
+      std::vector<float> m_target_min;
+      std::vector<float> m_target_max;
+
+      // ----------------------------------------------------------------------
+      //! Read the method's weights
+      // ----------------------------------------------------------------------
+      /*! Returns false if the weights use something the
+       *  evaluator doesn't support.
+       */
+      virtual bool ReadWeights(TXMLEngine& xml, XMLNodePointer_t root) = 0;
+
+      // ----------------------------------------------------------------------
+      //! Write/read the parsed weights to/from a binary stream
+      // ----------------------------------------------------------------------
+      virtual void WriteState(std::ostream& out) const = 0;
+      virtual bool ReadState(std::istream& in) = 0;
+
+      // ----------------------------------------------------------------------
+      //! Evaluate a batch of rows
+      // ----------------------------------------------------------------------
+      virtual void EvaluateBatch(
+        std::span<const float* const> inputs,
+        const std::size_t nRows,
+        std::span<float* const> outputs,
+        Context& context
+      ) const = 0;
+
+      // ----------------------------------------------------------------------
+      //! Read variables, targets, & transformations
+      // ----------------------------------------------------------------------
+      /*! Only a single Normalize transformation (or none)
+       *  is supported.
+       */
+      inline bool ReadHeader(TXMLEngine& xml, XMLNodePointer_t root) {
+
+        // grab variable & target expressions
+        XMLNodePointer_t variables = FindChild(xml, root, "Variables");
+        XMLNodePointer_t targets   = FindChild(xml, root, "Targets");
+        if (!variables || !targets) return false;
+
+        for (XMLNodePointer_t var = xml.GetChild(variables); var; var = xml.GetNext(var)) {
+          m_variables.push_back( GetAttr(xml, var, "Expression") );
+        }
+        for (XMLNodePointer_t target = xml.GetChild(targets); target; target = xml.GetNext(target)) {
+          m_targets.push_back( GetAttr(xml, target, "Expression") );
+        }
+
+        // check for transformations
+        XMLNodePointer_t transforms = FindChild(xml, root, "Transformations");
+        XMLNodePointer_t transform  = transforms ? xml.GetChild(transforms) : nullptr;
+        if (!transform) return true;
+        if (xml.GetNext(transform) || (GetAttr(xml, transform, "Name") != "Normalize")) {
+          std::cerr << "WARNING: only a single Normalize transformation can be evaluated natively!" << std::endl;
+          return false;
+        }
+
+        // figure out what's being transformed
+        XMLNodePointer_t selection = FindChild(xml, transform, "Selection");
+        XMLNodePointer_t selected  = selection ? FindChild(xml, selection, "Input") : nullptr;
+        if (!selected) return false;
+
+        std::vector<std::pair<bool, std::size_t>> inputs;
+        for (XMLNodePointer_t input = xml.GetChild(selected); input; input = xml.GetNext(input)) {
+          const std::string type       = GetAttr(xml, input, "Type");
+          const std::string expression = GetAttr(xml, input, "Expression");
+          const bool        isTarget   = (type == "Target");
+          const auto&       names      = isTarget ? m_targets : m_variables;
+          const auto        found      = std::find(names.begin(), names.end(), expression);
+          if ((type == "Spectator") || (found == names.end())) return false;
+          inputs.push_back( {isTarget, (std::size_t) std::distance(names.begin(), found)} );
+        }
+
+        // ranges of the last class cover all events
+        XMLNodePointer_t range = nullptr;
+        for (XMLNodePointer_t node = xml.GetChild(transform); node; node = xml.GetNext(node)) {
+          if (std::string("Class") == xml.GetNodeName(node)) range = node;
+        }
+        XMLNodePointer_t ranges = range ? FindChild(xml, range, "Ranges") : nullptr;
+        if (!ranges) return false;
+
+        m_normalize = true;
+        m_norm_vars.assign(m_variables.size(), false);
+        m_norm_targets.assign(m_targets.size(), false);
+        m_var_min.assign(m_variables.size(), 0.);
+        m_var_max.assign(m_variables.size(), 0.);
+        m_target_min.assign(m_targets.size(), 0.);
+        m_target_max.assign(m_targets.size(), 0.);
+        for (XMLNodePointer_t node = xml.GetChild(ranges); node; node = xml.GetNext(node)) {
+          const std::size_t index = std::atoi( GetAttr(xml, node, "Index").data() );
+          if (index >= inputs.size()) return false;
+
+          const auto [isTarget, iInput] = inputs[index];
+          (isTarget ? m_norm_targets : m_norm_vars)[iInput] = true;
+          (isTarget ? m_target_min : m_var_min)[iInput]     = GetFloatAttr(xml, node, "Min");
+          (isTarget ? m_target_max : m_var_max)[iInput]     = GetFloatAttr(xml, node, "Max");
+        }
+        return true;
+
+      }  // end 'ReadHeader(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write model to a binary cache
+      // ----------------------------------------------------------------------
+      inline bool WriteCache(const std::string& path) {
+
+        const std::string temp = path + ".tmp";
+        std::ofstream     out(temp, std::ios::binary | std::ios::trunc);
+
+        const uint64_t hash = GetHash();
+        out.write("BHCMODEL", 8);
+        out.write((const char*) &CacheVersion, sizeof(CacheVersion));
+        out.write((const char*) &hash, sizeof(hash));
+
+        // header
+        const std::vector<uint8_t> normVars(m_norm_vars.begin(), m_norm_vars.end());
+        const std::vector<uint8_t> normTargets(m_norm_targets.begin(), m_norm_targets.end());
+        WriteStrings(out, m_variables);
+        WriteStrings(out, m_targets);
+        out.write((const char*) &m_normalize, sizeof(m_normalize));
+        WriteVector(out, normVars);
+        WriteVector(out, normTargets);
+        WriteVector(out, m_var_min);
+        WriteVector(out, m_var_max);
+        WriteVector(out, m_target_min);
+        WriteVector(out, m_target_max);
+
+        // and weights
+        WriteState(out);
+        out.close();
+
+        const bool isGood = out.good() && (std::rename(temp.data(), path.data()) == 0);
+        if (!isGood) {
+          std::cerr << "WARNING couldn't write model cache '" << path << "'!" << std::endl;
+          std::remove(temp.data());
+        }
+        return isGood;
+
+      }  // end 'WriteCache(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Read model from a binary cache
+      // ----------------------------------------------------------------------
+      /*! Returns `Stale` if there's no cache, or if it was
+       *  written from a different weight file or by a
+       *  different version of the evaluators. A cache that
+       *  can't be read past its header is `Corrupt`, and
+       *  is removed.
+       */
+      inline CacheStatus ReadCache(const std::string& path) {
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in.good()) return CacheStatus::Stale;
+
+        char     magic[8];
+        uint32_t version = 0;
+        uint64_t hash    = 0;
+        in.read(magic, sizeof(magic));
+        in.read((char*) &version, sizeof(version));
+        in.read((char*) &hash, sizeof(hash));
+        if (
+          !in.good()                                     ||
+          (std::memcmp(magic, "BHCMODEL", 8) != 0)       ||
+          (version != CacheVersion)                      ||
+          (hash != GetHash())
+        ) {
+          return CacheStatus::Stale;
+        }
+
+        // header
+        std::vector<uint8_t> normVars;
+        std::vector<uint8_t> normTargets;
+        bool isGood = ReadStrings(in, m_variables)
+                   && ReadStrings(in, m_targets)
+                   && in.read((char*) &m_normalize, sizeof(m_normalize)).good()
+                   && ReadVector(in, normVars)
+                   && ReadVector(in, normTargets)
+                   && ReadVector(in, m_var_min)
+                   && ReadVector(in, m_var_max)
+                   && ReadVector(in, m_target_min)
+                   && ReadVector(in, m_target_max);
+        m_norm_vars.assign(normVars.begin(), normVars.end());
+        m_norm_targets.assign(normTargets.begin(), normTargets.end());
+
+        // and weights
+        isGood = isGood && ReadState(in);
+        if (!isGood) {
+          std::cerr << "WARNING: model cache '" << path << "' is corrupt! Removing it." << std::endl;
+          std::remove(path.data());
+        }
+        return isGood ? CacheStatus::Good : CacheStatus::Corrupt;
+
+      }  // end 'ReadCache(std::string&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline const std::string&              GetPath()      const {return m_path;}
+      inline const std::vector<std::string>& GetVariables() const {return m_variables;}
+      inline const std::vector<std::string>& GetTargets()   const {return m_targets;}
+
+      // ----------------------------------------------------------------------
+      //! Get hash of the weight file's contents (computed on first call)
+      // ----------------------------------------------------------------------
+      inline uint64_t GetHash() {
+
+        if (m_hash == 0) m_hash = FeatureCache::HashFile(m_path, true);
+        return m_hash;
+
+      }  // end 'GetHash()'
+
+      // ----------------------------------------------------------------------
+      //! Load a weight file
+      // ----------------------------------------------------------------------
+      /*! Returns false (with a warning) if the file can't
+       *  be read or can't be evaluated natively. If
+       *  `useCache` is set, the model is loaded from its
+       *  binary cache when that's up to date, and the
+       *  cache is (re)written otherwise. Pass the hash of
+       *  the file if it's already known.
+       */
+      inline bool Load(const std::string& path, const bool useCache = false, const uint64_t hash = 0) {
+
+        m_path = path;
+        m_hash = hash;
+
+        // a corrupt cache may have left the model half
+        // read, so give up on it for this job
+        const std::string cache = GetCachePath(path);
+        if (useCache) {
+          const CacheStatus status = ReadCache(cache);
+          if (status == CacheStatus::Good)    return true;
+          if (status == CacheStatus::Corrupt) return false;
+        }
+
+        TXMLEngine      xml;
+        XMLDocPointer_t doc = xml.ParseFile(path.data());
+        if (!doc) {
+          std::cerr << "WARNING: couldn't parse weight file '" << path << "'!" << std::endl;
+          return false;
+        }
+
+        XMLNodePointer_t root   = xml.DocGetRootElement(doc);
+        const bool       isGood = ReadHeader(xml, root) && ReadWeights(xml, root);
+        xml.FreeDoc(doc);
+        if (!isGood) {
+          std::cerr << "WARNING: can't evaluate '" << path << "' natively!" << std::endl;
+        } else if (useCache) {
+          WriteCache(cache);
+        }
+        return isGood;
+
+      }  // end 'Load(std::string&, bool, uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate a batch of rows
+      // ----------------------------------------------------------------------
+      /*! `inputs[iVar][iRow]` are untransformed values of
+       *  the variables in the order of `GetVariables()`;
+       *  `outputs[iTarget][iRow]` receive the regression
+       *  outputs, as TMVA::Reader would return them.
+       */
+      inline void Evaluate(
+        std::span<const float* const> inputs,
+        const std::size_t nRows,
+        std::span<float* const> outputs,
+        Context& context
+      ) const {
+
+        if (!m_normalize) {
+          EvaluateBatch(inputs, nRows, outputs, context);
+          return;
+        }
+
+        // normalize inputs to [-1, 1]
+        //   - n.b. arithmetic is done in single precision,
+        //     like TMVA's NormalizeTransform
+        context.inputs.resize(m_variables.size() * nRows);
+        context.columns.resize(m_variables.size());
+        for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+          if (!m_norm_vars[iVar]) {
+            context.columns[iVar] = inputs[iVar];
+            continue;
+          }
+
+          float*      column = context.inputs.data() + (iVar * nRows);
+          const float offset = m_var_min[iVar];
+          const float scale  = 1.0 / (m_var_max[iVar] - m_var_min[iVar]);
+          for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+            column[iRow] = (inputs[iVar][iRow] - offset) * scale * 2 - 1;
+          }
+          context.columns[iVar] = column;
+        }
+        EvaluateBatch(context.columns, nRows, outputs, context);
+
+        // and transform targets back
+        for (std::size_t iTarget = 0; iTarget < m_targets.size(); ++iTarget) {
+          if (!m_norm_targets[iTarget]) continue;
+
+          const float offset = m_target_min[iTarget];
+          const float scale  = 1.0 / (m_target_max[iTarget] - m_target_min[iTarget]);
+          for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+            outputs[iTarget][iRow] = (outputs[iTarget][iRow] + 1) / (scale * 2) + offset;
+          }
+        }
+        return;
+
+      }  // end 'Evaluate(std::span<const float* const>, std::size_t, std::span<float* const>, Context&)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Base()  {};
+      virtual ~Base() {};
+
+  };  // end NativeModel::Base
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get a key identifying a weight file as it is now
+  // --------------------------------------------------------------------------
+  /*! See FeatureCache::GetFileKey: cheap to get, and
+   *  changes whenever the file is rewritten. Returns an
+   *  empty key if the file can't be found.
+   */
+  inline std::string GetFileKey(const std::string& path) {
+
+    return FeatureCache::GetFileKey(path);
+
+  }  // end 'GetFileKey(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get a model already loaded from a weight file, if any
+  // --------------------------------------------------------------------------
+  /*! Models are registered by the key of their weight
+   *  file (see `GetFileKey`), so every reader (e.g. one
+   *  per thread) that books the same file shares one
+   *  read-only model without re-reading the file. Pass
+   *  a model to register it; the registered one (which
+   *  may be an older one) is returned. Models are
+   *  dropped once nothing holds them.
+   */
+  inline std::shared_ptr<const Base> Share(const std::string& key, std::shared_ptr<const Base> model = nullptr) {
+
+    static std::mutex                                        mutex;
+    static std::map<std::string, std::weak_ptr<const Base>>  models;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const Base> shared = models[key].lock();
+    if (!shared && model) {
+      models[key] = model;
+      shared      = model;
+    }
+    return shared;
+
+  }  // end 'Share(std::string&, std::shared_ptr<const Base>)'
+
+}  // end NativeModel namespace
+
+#endif
+
+// end ========================================================================
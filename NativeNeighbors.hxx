@@ -0,0 +1,552 @@
+/// ===========================================================================
+/*! \file   NativeNeighbors.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A native evaluator for TMVA's k-nearest neighbor
+ *  (KNN) regression, backed by a kd-tree.
+ */
+/// ===========================================================================
+
+#ifndef NativeNeighbors_hxx
+#define NativeNeighbors_hxx
+
+// c++ utilities
+#include <span>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TXMLEngine.h>
+// analysis utilities
+#include "NativeModel.hxx"
+
+
+
+namespace NativeModel {
+
+  // ==========================================================================
+  //! KD-Tree
+  // ==========================================================================
+  /*! An immutable index over the (scaled) training
+   *  points of a KNN weight file. Points, targets, and
+   *  weights are stored in tree order so that each leaf
+   *  is a contiguous run. Once built, a tree is only
+   *  ever read, so it's safe to search from any
+   *  number of threads at once.
+   */
+  class KDTree {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Node of the tree
+      // ----------------------------------------------------------------------
+      /*! Leaves have `split < 0` and cover points
+       *  [first, first + count); points of the left child
+       *  of a node have `x[split] <= value`, those of the
+       *  right `x[split] >= value`.
+       */
+      struct Node {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        int32_t  split = -1;
+        float    value = 0.;
+        uint32_t left  = 0;
+        uint32_t right = 0;
+      };
+
+      // neighbors found by a search: (distance, point)
+      typedef std::vector<std::pair<float, uint32_t>> Neighbors;
+
+      // max no. of points in a leaf
+      static constexpr uint32_t LeafSize = 8;
+
+    private:
+
+      // data members
+      uint32_t              m_dim     = 0;
+      uint32_t              m_targets = 0;
+      uint64_t              m_hash    = 0;
+      std::vector<double>   m_scales;
+      std::vector<float>    m_points;
+      std::vector<float>    m_values;
+      std::vector<double>   m_weights;
+      std::vector<Node>     m_nodes;
+
+      // ----------------------------------------------------------------------
+      //! Split points [first, first + count) of `order`
+      // ----------------------------------------------------------------------
+      inline uint32_t Split(std::vector<uint32_t>& order, const uint32_t first, const uint32_t count) {
+
+        const uint32_t iNode = m_nodes.size();
+        m_nodes.emplace_back();
+        m_nodes[iNode].first = first;
+        m_nodes[iNode].count = count;
+        if (count <= LeafSize) return iNode;
+
+        // split on variable with the largest spread
+        int32_t split  = 0;
+        float   spread = -1.;
+        for (uint32_t iDim = 0; iDim < m_dim; ++iDim) {
+          float lo = m_points[(order[first] * m_dim) + iDim];
+          float hi = lo;
+          for (uint32_t iPoint = first; iPoint < first + count; ++iPoint) {
+            const float value = m_points[(order[iPoint] * m_dim) + iDim];
+            lo = std::min(lo, value);
+            hi = std::max(hi, value);
+          }
+          if (hi - lo > spread) {
+            spread = hi - lo;
+            split  = iDim;
+          }
+        }
+
+        // and at the median
+        const uint32_t middle = first + (count / 2);
+        std::nth_element(
+          order.begin() + first,
+          order.begin() + middle,
+          order.begin() + first + count,
+          [&](const uint32_t lhs, const uint32_t rhs) {
+            return m_points[(lhs * m_dim) + split] < m_points[(rhs * m_dim) + split];
+          }
+        );
+
+        const float    value = m_points[(order[middle] * m_dim) + split];
+        const uint32_t left  = Split(order, first, middle - first);
+        const uint32_t right = Split(order, middle, first + count - middle);
+        m_nodes[iNode].split = split;
+        m_nodes[iNode].value = value;
+        m_nodes[iNode].left  = left;
+        m_nodes[iNode].right = right;
+        return iNode;
+
+      }  // end 'Split(std::vector<uint32_t>&, uint32_t, uint32_t)'
+
+      // ----------------------------------------------------------------------
+      //! Search a node (and below) for the k nearest points
+      // ----------------------------------------------------------------------
+      /*! `found` is kept as a max-heap on distance. Far
+       *  children are skipped unless they could hold a
+       *  point closer than the current k-th nearest.
+       */
+      inline void Visit(const uint32_t iNode, const float* query, const std::size_t k, Neighbors& found) const {
+
+        const Node& node = m_nodes[iNode];
+        if (node.split < 0) {
+          for (uint32_t iPoint = node.first; iPoint < node.first + node.count; ++iPoint) {
+            const float distance = GetDistance(query, iPoint);
+            if (found.size() < k) {
+              found.push_back( {distance, iPoint} );
+              std::push_heap(found.begin(), found.end());
+            } else if (distance < found.front().first) {
+              std::pop_heap(found.begin(), found.end());
+              found.back() = {distance, iPoint};
+              std::push_heap(found.begin(), found.end());
+            }
+          }
+          return;
+        }
+
+        const float diff = query[node.split] - node.value;
+        Visit((diff < 0.) ? node.left : node.right, query, k, found);
+        if ((found.size() < k) || (diff * diff < found.front().first)) {
+          Visit((diff < 0.) ? node.right : node.left, query, k, found);
+        }
+        return;
+
+      }  // end 'Visit(uint32_t, float*, std::size_t, Neighbors&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline uint32_t                   GetNDim()     const {return m_dim;}
+      inline uint32_t                   GetNTargets() const {return m_targets;}
+      inline uint64_t                   GetHash()     const {return m_hash;}
+      inline std::size_t                GetNPoints()  const {return m_weights.size();}
+      inline std::size_t                GetNNodes()   const {return m_nodes.size();}
+      inline const std::vector<double>& GetScales()   const {return m_scales;}
+      inline double                     GetWeight(const uint32_t iPoint) const {return m_weights[iPoint];}
+      inline const float*               GetTargets(const uint32_t iPoint) const {return m_values.data() + (iPoint * m_targets);}
+
+      // ----------------------------------------------------------------------
+      //! Squared distance between a query & a stored point
+      // ----------------------------------------------------------------------
+      /*! n.b. summed in single precision, in variable
+       *  order, like TMVA::kNN::Event::GetDist.
+       */
+      inline float GetDistance(const float* query, const uint32_t iPoint) const {
+
+        const float* point = m_points.data() + (iPoint * m_dim);
+        float        sum   = 0.;
+        for (uint32_t iDim = 0; iDim < m_dim; ++iDim) {
+          sum += (query[iDim] - point[iDim]) * (query[iDim] - point[iDim]);
+        }
+        return sum;
+
+      }  // end 'GetDistance(float*, uint32_t)'
+
+      // ----------------------------------------------------------------------
+      //! Find the k nearest points to a query
+      // ----------------------------------------------------------------------
+      /*! On return, `found` holds the neighbors sorted by
+       *  increasing distance.
+       */
+      inline void Search(const float* query, const std::size_t k, Neighbors& found) const {
+
+        found.clear();
+        if (!m_nodes.empty()) Visit(0, query, k, found);
+        std::sort_heap(found.begin(), found.end());
+        return;
+
+      }  // end 'Search(float*, std::size_t, Neighbors&)'
+
+      // ----------------------------------------------------------------------
+      //! Write tree to a binary stream
+      // ----------------------------------------------------------------------
+      inline void Write(std::ostream& out) const {
+
+        out.write((const char*) &m_dim, sizeof(m_dim));
+        out.write((const char*) &m_targets, sizeof(m_targets));
+        out.write((const char*) &m_hash, sizeof(m_hash));
+        WriteVector(out, m_scales);
+        WriteVector(out, m_points);
+        WriteVector(out, m_values);
+        WriteVector(out, m_weights);
+        WriteVector(out, m_nodes);
+        return;
+
+      }  // end 'Write(std::ostream&)'
+
+      // ----------------------------------------------------------------------
+      //! Read tree from a binary stream
+      // ----------------------------------------------------------------------
+      inline bool Read(std::istream& in) {
+
+        in.read((char*) &m_dim, sizeof(m_dim));
+        in.read((char*) &m_targets, sizeof(m_targets));
+        in.read((char*) &m_hash, sizeof(m_hash));
+        return in.good()
+            && ReadVector(in, m_scales)
+            && ReadVector(in, m_points)
+            && ReadVector(in, m_values)
+            && ReadVector(in, m_weights)
+            && ReadVector(in, m_nodes)
+            && (m_points.size() == m_weights.size() * m_dim)
+            && (m_values.size() == m_weights.size() * m_targets);
+
+      }  // end 'Read(std::istream&)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      KDTree()  {};
+      ~KDTree() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting scaled points, targets, weights, & scales
+      // ----------------------------------------------------------------------
+      /*! Points & targets are row-major, one row per
+       *  training event. `hash` identifies the weight
+       *  file the tree was built from.
+       */
+      KDTree(
+        const uint32_t dim,
+        const uint32_t targets,
+        std::vector<float> points,
+        std::vector<float> values,
+        std::vector<double> weights,
+        std::vector<double> scales,
+        const uint64_t hash
+      ) {
+
+        m_dim     = dim;
+        m_targets = targets;
+        m_hash    = hash;
+        m_scales  = std::move(scales);
+        m_points  = std::move(points);
+
+        // build tree over point indices
+        std::vector<uint32_t> order(weights.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (!order.empty()) Split(order, 0, order.size());
+
+        // then store everything in tree order
+        std::vector<float> sorted(m_points.size());
+        m_values.resize(values.size());
+        m_weights.resize(weights.size());
+        for (std::size_t iPoint = 0; iPoint < order.size(); ++iPoint) {
+          std::copy_n(m_points.begin() + (order[iPoint] * m_dim), m_dim, sorted.begin() + (iPoint * m_dim));
+          std::copy_n(values.begin() + (order[iPoint] * m_targets), m_targets, m_values.begin() + (iPoint * m_targets));
+          m_weights[iPoint] = weights[order[iPoint]];
+        }
+        m_points = std::move(sorted);
+
+      }  // end ctor(uint32_t, uint32_t, std::vector<float>, std::vector<float>, std::vector<double>, std::vector<double>, uint64_t)'
+
+  };  // end NativeModel::KDTree
+
+
+
+
+
+
+  // ==========================================================================
+  //! Native KNN regression
+  // ==========================================================================
+  /*! Follows TMVA::MethodKNN:
+   *
+   *    - with ScaleFrac > 0, each variable is divided by
+   *      the width of the central ScaleFrac of its
+   *      training distribution (ModulekNN::ComputeMetric),
+   *    - the output is the (optionally event-weighted)
+   *      mean of the targets of the nkNN nearest points.
+   *
+   *  n.b. TMVA doesn't apply the kernel to regression
+   *  (only to classification), so neither is it here.
+   *  Neighbors at exactly the same distance may be
+   *  picked in a different order than TMVA's tree.
+   */
+  class NearestNeighbors : public Base {
+
+    private:
+
+      // data members
+      bool                          m_use_weight = true;
+      std::size_t                   m_knn        = 20;
+      std::shared_ptr<const KDTree> m_tree;
+
+      // ----------------------------------------------------------------------
+      //! Check if an option is true
+      // ----------------------------------------------------------------------
+      static inline bool IsTrue(const std::string& value) {
+
+        return (value == "T") || (value == "True") || (value == "true") || (value == "1");
+
+      }  // end 'IsTrue(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Build a tree from the training events
+      // ----------------------------------------------------------------------
+      inline std::shared_ptr<const KDTree> BuildTree(
+        TXMLEngine& xml,
+        XMLNodePointer_t weights,
+        const double scaleFrac,
+        const uint64_t hash
+      ) const {
+
+        const uint32_t nVars    = m_variables.size();
+        const uint32_t nTargets = m_targets.size();
+
+        // read events
+        std::vector<float>  points;
+        std::vector<float>  values;
+        std::vector<double> eventWeights;
+        for (XMLNodePointer_t event = xml.GetChild(weights); event; event = xml.GetNext(event)) {
+
+          const char*        content = xml.GetNodeContent(event);
+          std::istringstream stream(content ? content : "");
+          for (uint32_t iVar = 0; iVar < nVars + nTargets; ++iVar) {
+            float value = 0.;
+            if (!(stream >> value)) return nullptr;
+            (iVar < nVars ? points : values).push_back(value);
+          }
+          eventWeights.push_back( std::strtod(GetAttr(xml, event, "Weight").data(), nullptr) );
+        }
+        if (eventWeights.size() < m_knn + 2) {
+          std::cerr << "WARNING: KNN weights hold fewer events than neighbors to find!" << std::endl;
+          return nullptr;
+        }
+
+        // compute widths of each variable & scale points
+        const std::size_t   nEvents = eventWeights.size();
+        std::vector<double> scales;
+        if (scaleFrac > 0.) {
+          const uint32_t percent = 100.0 * scaleFrac;
+          const double   lfrac   = (1.0 - (0.01 * percent)) / 2.0;
+          const double   rfrac   = 1.0 - lfrac;
+
+          // TMVA takes the last entry with i/n below each fraction
+          auto getBin = [nEvents](const double frac) -> std::optional<std::size_t> {
+            std::optional<std::size_t> bin;
+            for (std::size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+              if ((static_cast<double>(iEvent) / nEvents) < frac) bin = iEvent;
+            }
+            return bin;
+          };
+          const std::optional<std::size_t> lbin = getBin(lfrac);
+          const std::optional<std::size_t> rbin = getBin(rfrac);
+          if (!lbin || !rbin) {
+            std::cerr << "WARNING: ScaleFrac = " << scaleFrac << " leaves no range to scale by!" << std::endl;
+            return nullptr;
+          }
+
+          for (uint32_t iVar = 0; iVar < nVars; ++iVar) {
+            std::vector<double> sorted(nEvents);
+            for (std::size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+              sorted[iEvent] = points[(iEvent * nVars) + iVar];
+            }
+            std::sort(sorted.begin(), sorted.end());
+
+            const double width = sorted[*rbin] - sorted[*lbin];
+            if (!(width > 0.)) {
+              std::cerr << "WARNING: variable '" << m_variables[iVar] << "' has no width to scale by!" << std::endl;
+              return nullptr;
+            }
+            scales.push_back(width);
+          }
+
+          for (std::size_t iEvent = 0; iEvent < nEvents; ++iEvent) {
+            for (uint32_t iVar = 0; iVar < nVars; ++iVar) {
+              float& point = points[(iEvent * nVars) + iVar];
+              point = point / scales[iVar];
+            }
+          }
+        }
+
+        return std::make_shared<const KDTree>(
+          nVars,
+          nTargets,
+          std::move(points),
+          std::move(values),
+          std::move(eventWeights),
+          std::move(scales),
+          hash
+        );
+
+      }  // end 'BuildTree(TXMLEngine&, XMLNodePointer_t, double, uint64_t)'
+
+    protected:
+
+      // ----------------------------------------------------------------------
+      //! Read options & get (or build) the tree
+      // ----------------------------------------------------------------------
+      inline bool ReadWeights(TXMLEngine& xml, XMLNodePointer_t root) override {
+
+        // check options
+        m_knn        = std::atoi(GetOption(xml, root, "nkNN").data());
+        m_use_weight = IsTrue(GetOption(xml, root, "UseWeight"));
+        if (IsTrue(GetOption(xml, root, "Trim")) || (m_knn == 0)) {
+          std::cerr << "WARNING: KNN with trimming (or no neighbors) can't be evaluated natively!" << std::endl;
+          return false;
+        }
+        const double scaleFrac = std::strtod(GetOption(xml, root, "ScaleFrac").data(), nullptr);
+
+        XMLNodePointer_t weights = FindChild(xml, root, "Weights");
+        if (!weights) return false;
+
+        m_tree = BuildTree(xml, weights, scaleFrac, GetHash());
+        return m_tree && (m_tree -> GetNDim() == m_variables.size()) && (m_tree -> GetNTargets() == m_targets.size());
+
+      }  // end 'ReadWeights(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write options & tree to a binary stream
+      // ----------------------------------------------------------------------
+      inline void WriteState(std::ostream& out) const override {
+
+        const uint64_t knn = m_knn;
+        out.write((const char*) &knn, sizeof(knn));
+        out.write((const char*) &m_use_weight, sizeof(m_use_weight));
+        m_tree -> Write(out);
+        return;
+
+      }  // end 'WriteState(std::ostream&)'
+
+      // ----------------------------------------------------------------------
+      //! Read options & tree from a binary stream
+      // ----------------------------------------------------------------------
+      inline bool ReadState(std::istream& in) override {
+
+        uint64_t knn = 0;
+        in.read((char*) &knn, sizeof(knn));
+        in.read((char*) &m_use_weight, sizeof(m_use_weight));
+        if (!in.good()) return false;
+        m_knn = knn;
+
+        auto tree = std::make_shared<KDTree>();
+        if (!tree -> Read(in)) return false;
+
+        m_tree = tree;
+        return (m_tree -> GetNDim() == m_variables.size()) && (m_tree -> GetNTargets() == m_targets.size());
+
+      }  // end 'ReadState(std::istream&)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate a batch of rows
+      // ----------------------------------------------------------------------
+      inline void EvaluateBatch(
+        std::span<const float* const> inputs,
+        const std::size_t nRows,
+        std::span<float* const> outputs,
+        Context& context
+      ) const override {
+
+        const std::vector<double>& scales   = m_tree -> GetScales();
+        const std::size_t          nVars    = m_variables.size();
+        const std::size_t          nTargets = m_targets.size();
+        context.query.resize(nVars);
+
+        std::vector<float> sums(nTargets);
+        for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+
+          // scale query like the training points
+          for (std::size_t iVar = 0; iVar < nVars; ++iVar) {
+            context.query[iVar] = scales.empty() ? inputs[iVar][iRow] : inputs[iVar][iRow] / scales[iVar];
+          }
+          m_tree -> Search(context.query.data(), m_knn, context.neighbors);
+
+          // average targets of neighbors, nearest first
+          //   - n.b. sums are single precision, as in
+          //     MethodKNN::GetRegressionValues
+          double total = 0.;
+          std::fill(sums.begin(), sums.end(), 0.);
+          for (const auto& [distance, iPoint] : context.neighbors) {
+            const double weight  = m_use_weight ? m_tree -> GetWeight(iPoint) : 1.0;
+            const float* targets = m_tree -> GetTargets(iPoint);
+            for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+              sums[iTarget] += targets[iTarget] * weight;
+            }
+            total += weight;
+          }
+          for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+            outputs[iTarget][iRow] = (total > 0.) ? sums[iTarget] / total : 0.;
+          }
+        }  // end row loop
+        return;
+
+      }  // end 'EvaluateBatch(std::span<const float* const>, std::size_t, std::span<float* const>, Context&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline std::size_t                   GetNNeighbors() const {return m_knn;}
+      inline std::shared_ptr<const KDTree> GetTree()       const {return m_tree;}
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      NearestNeighbors()  {};
+      ~NearestNeighbors() {};
+
+  };  // end NativeModel::NearestNeighbors
+
+}  // end NativeModel namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,335 @@
+/// ===========================================================================
+/*! \file   NativeNetwork.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A native evaluator for TMVA's multilayer
+ *  perceptron (MLP) with batched, vectorizable
+ *  inference.
+ */
+/// ===========================================================================
+
+#ifndef NativeNetwork_hxx
+#define NativeNetwork_hxx
+
+// c++ utilities
+#include <span>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TXMLEngine.h>
+// analysis utilities
+#include "NativeModel.hxx"
+
+
+
+namespace NativeModel {
+
+  // ==========================================================================
+  //! Native MLP
+  // ==========================================================================
+  /*! Each layer is stored as a dense, row-major matrix
+   *  of weights (one row per neuron of the layer, one
+   *  column per neuron of the previous layer, bias
+   *  last), and activations are stored neuron-major
+   *  over a tile of rows (in the evaluation context,
+   *  one layer after another). Every loop over a tile is
+   *  contiguous and branch-free, so the compiler can
+   *  vectorize both the multiply-adds and the
+   *  activation.
+   *
+   *  Sums are accumulated in double precision in the
+   *  same order as TMVA::TNeuronInputSum (bias last),
+   *  and tanh uses the same rational approximation as
+   *  TMVA::TActivationTanh, so outputs match TMVA's up
+   *  to rounding.
+   */
+  class Network : public Base {
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Supported activations of hidden neurons
+      // ----------------------------------------------------------------------
+      enum Activation {Tanh, Sigmoid, Linear, Radial, ReLU};
+
+      // no. of rows evaluated at a time
+      static constexpr std::size_t Tile = 256;
+
+    private:
+
+      // data members
+      Activation                       m_activation = Activation::Tanh;
+      std::vector<std::size_t>         m_sizes;
+      std::vector<std::vector<double>> m_weights;
+      std::vector<std::size_t>         m_offsets;
+
+      // ----------------------------------------------------------------------
+      //! Apply activation to a tile of values
+      // ----------------------------------------------------------------------
+      /*! n.b. tanh follows TActivationTanh::fast_tanh,
+       *  including its single-precision intermediates.
+       */
+      inline void Activate(double* values, const std::size_t nRows) const {
+
+        switch (m_activation) {
+          case Activation::Sigmoid:
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              values[iRow] = 1. / (1. + std::exp(-values[iRow]));
+            }
+            break;
+          case Activation::Radial:
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              values[iRow] = std::exp(-values[iRow] * values[iRow] / 2.);
+            }
+            break;
+          case Activation::ReLU:
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              values[iRow] = (values[iRow] > 0.) ? values[iRow] : 0.;
+            }
+            break;
+          case Activation::Linear:
+            break;
+          case Activation::Tanh:
+            [[fallthrough]];
+          default:
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              const double arg  = values[iRow];
+              const float  arg2 = arg * arg;
+              const float  num  = arg * (135135.0f + arg2 * (17325.0f + arg2 * (378.0f + arg2)));
+              const float  den  = 135135.0f + arg2 * (62370.0f + arg2 * (3150.0f + arg2 * 28.0f));
+              values[iRow] = (arg > 4.97) ? 1. : ((arg < -4.97) ? -1. : (double) (num / den));
+            }
+            break;
+        }
+        return;
+
+      }  // end 'Activate(double*, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Propagate a tile through one layer
+      // ----------------------------------------------------------------------
+      inline void Propagate(const std::size_t iLayer, const std::size_t nRows, double* values) const {
+
+        const std::size_t nIn     = m_sizes[iLayer - 1];
+        const std::size_t nOut    = m_sizes[iLayer];
+        const bool        isLast  = (iLayer + 1 == m_sizes.size());
+        const double*     weights = m_weights[iLayer].data();
+        const double*     in      = values + m_offsets[iLayer - 1];
+        double*           out     = values + m_offsets[iLayer];
+
+        for (std::size_t iOut = 0; iOut < nOut; ++iOut) {
+
+          const double* row = weights + (iOut * (nIn + 1));
+          double*       sum = out + (iOut * Tile);
+          std::fill(sum, sum + nRows, 0.);
+
+          // weighted inputs, then bias
+          for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+            const double  weight = row[iIn];
+            const double* value  = in + (iIn * Tile);
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              sum[iRow] += weight * value[iRow];
+            }
+          }
+          const double bias = row[nIn];
+          for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+            sum[iRow] += bias;
+          }
+
+          // output neurons are linear for regression
+          if (!isLast) Activate(sum, nRows);
+        }
+        return;
+
+      }  // end 'Propagate(std::size_t, std::size_t, double*)'
+
+      // ----------------------------------------------------------------------
+      //! Locate activations of each layer in a context
+      // ----------------------------------------------------------------------
+      inline void SetOffsets() {
+
+        m_offsets.assign(1, 0);
+        for (const std::size_t size : m_sizes) {
+          m_offsets.push_back( m_offsets.back() + (size * Tile) );
+        }
+        return;
+
+      }  // end 'SetOffsets()'
+
+    protected:
+
+      // ----------------------------------------------------------------------
+      //! Read layout & synapse weights from <Weights> block
+      // ----------------------------------------------------------------------
+      /*! Every layer but the last ends with a bias neuron,
+       *  and each neuron lists the weights of its synapses
+       *  to the (non-bias) neurons of the next layer.
+       */
+      inline bool ReadWeights(TXMLEngine& xml, XMLNodePointer_t root) override {
+
+        // check options
+        const std::string neuron = GetOption(xml, root, "NeuronType");
+        if      (neuron == "tanh")    m_activation = Activation::Tanh;
+        else if (neuron == "sigmoid") m_activation = Activation::Sigmoid;
+        else if (neuron == "linear")  m_activation = Activation::Linear;
+        else if (neuron == "radial")  m_activation = Activation::Radial;
+        else if (neuron == "ReLU")    m_activation = Activation::ReLU;
+        else {
+          std::cerr << "WARNING: neuron type '" << neuron << "' can't be evaluated natively!" << std::endl;
+          return false;
+        }
+
+        const std::string input     = GetOption(xml, root, "NeuronInputType");
+        const std::string estimator = GetOption(xml, root, "EstimatorType");
+        if ((!input.empty() && (input != "sum")) || (estimator == "CE")) {
+          std::cerr << "WARNING: only summed inputs and linear outputs can be evaluated natively!" << std::endl;
+          return false;
+        }
+
+        // grab layers
+        XMLNodePointer_t weights = FindChild(xml, root, "Weights");
+        XMLNodePointer_t layout  = weights ? FindChild(xml, weights, "Layout") : nullptr;
+        if (!layout) return false;
+
+        std::vector<XMLNodePointer_t> layers;
+        for (XMLNodePointer_t layer = xml.GetChild(layout); layer; layer = xml.GetNext(layer)) {
+          layers.push_back(layer);
+        }
+        if (layers.size() < 2) return false;
+
+        // figure out no. of neurons per layer, excluding biases
+        for (std::size_t iLayer = 0; iLayer < layers.size(); ++iLayer) {
+          const bool isLast   = (iLayer + 1 == layers.size());
+          const int  nNeurons = std::atoi(GetAttr(xml, layers[iLayer], "NNeurons").data());
+          m_sizes.push_back( nNeurons - (isLast ? 0 : 1) );
+        }
+        if ((m_sizes.front() != m_variables.size()) || (m_sizes.back() != m_targets.size())) {
+          std::cerr << "WARNING: network layout doesn't match its variables & targets!" << std::endl;
+          return false;
+        }
+
+        // read synapses into per-layer matrices
+        SetOffsets();
+        m_weights.resize(layers.size());
+        for (std::size_t iLayer = 0; iLayer + 1 < layers.size(); ++iLayer) {
+
+          const std::size_t nIn  = m_sizes[iLayer];
+          const std::size_t nOut = m_sizes[iLayer + 1];
+          std::vector<double>& matrix = m_weights[iLayer + 1];
+          matrix.resize(nOut * (nIn + 1));
+
+          std::size_t iIn = 0;
+          for (XMLNodePointer_t neuron = xml.GetChild(layers[iLayer]); neuron; neuron = xml.GetNext(neuron), ++iIn) {
+            if (iIn > nIn) return false;
+
+            const char*        content = xml.GetNodeContent(neuron);
+            std::istringstream synapses(content ? content : "");
+            for (std::size_t iOut = 0; iOut < nOut; ++iOut) {
+              if (!(synapses >> matrix[(iOut * (nIn + 1)) + iIn])) return false;
+            }
+          }
+          if (iIn != nIn + 1) return false;
+        }
+        return true;
+
+      }  // end 'ReadWeights(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write layout & weights to a binary stream
+      // ----------------------------------------------------------------------
+      inline void WriteState(std::ostream& out) const override {
+
+        out.write((const char*) &m_activation, sizeof(m_activation));
+        WriteVector(out, m_sizes);
+        for (const std::vector<double>& matrix : m_weights) {
+          WriteVector(out, matrix);
+        }
+        return;
+
+      }  // end 'WriteState(std::ostream&)'
+
+      // ----------------------------------------------------------------------
+      //! Read layout & weights from a binary stream
+      // ----------------------------------------------------------------------
+      inline bool ReadState(std::istream& in) override {
+
+        in.read((char*) &m_activation, sizeof(m_activation));
+        if (!ReadVector(in, m_sizes) || (m_sizes.size() < 2)) return false;
+
+        SetOffsets();
+        m_weights.resize(m_sizes.size());
+        for (std::size_t iLayer = 0; iLayer < m_sizes.size(); ++iLayer) {
+          if (!ReadVector(in, m_weights[iLayer])) return false;
+        }
+        return true;
+
+      }  // end 'ReadState(std::istream&)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate a batch of rows a tile at a time
+      // ----------------------------------------------------------------------
+      inline void EvaluateBatch(
+        std::span<const float* const> inputs,
+        const std::size_t nRows,
+        std::span<float* const> outputs,
+        Context& context
+      ) const override {
+
+        context.values.resize(m_offsets.back());
+        double* activations = context.values.data();
+        for (std::size_t first = 0; first < nRows; first += Tile) {
+
+          const std::size_t nTile = std::min(Tile, nRows - first);
+
+          // load inputs
+          for (std::size_t iVar = 0; iVar < m_sizes.front(); ++iVar) {
+            double*      values = activations + (iVar * Tile);
+            const float* column = inputs[iVar] + first;
+            for (std::size_t iRow = 0; iRow < nTile; ++iRow) {
+              values[iRow] = column[iRow];
+            }
+          }
+
+          // propagate through network
+          for (std::size_t iLayer = 1; iLayer < m_sizes.size(); ++iLayer) {
+            Propagate(iLayer, nTile, activations);
+          }
+
+          // and collect outputs
+          for (std::size_t iTarget = 0; iTarget < m_sizes.back(); ++iTarget) {
+            const double* values = activations + m_offsets[m_sizes.size() - 1] + (iTarget * Tile);
+            for (std::size_t iRow = 0; iRow < nTile; ++iRow) {
+              outputs[iTarget][first + iRow] = values[iRow];
+            }
+          }
+        }  // end tile loop
+        return;
+
+      }  // end 'EvaluateBatch(std::span<const float* const>, std::size_t, std::span<float* const>, Context&)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline Activation                      GetActivation() const {return m_activation;}
+      inline const std::vector<std::size_t>& GetLayerSizes() const {return m_sizes;}
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Network()  {};
+      ~Network() {};
+
+  };  // end NativeModel::Network
+
+}  // end NativeModel namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,363 @@
+/// ===========================================================================
+/*! \file   ParallelApply.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to apply trained TMVA models to a tuple
+ *  on several threads at once.
+ */
+/// ===========================================================================
+
+#ifndef ParallelApply_hxx
+#define ParallelApply_hxx
+
+// c++ utilities
+#include <map>
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <stdexcept>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+// root libraries
+#include <TCut.h>
+#include <TFile.h>
+#include <TROOT.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "TMVAHelper.hxx"
+#include "FeatureCache.hxx"
+#include "NTupleHelper.hxx"
+#include "NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Parallel Apply
+// ============================================================================
+/*! The entry range is cut into chunks which worker
+ *  threads pick up in order. Each worker owns its own
+ *  input file, NTupleHelper, selector, block reader,
+ *  and TMVA::Reader. Methods evaluated natively are
+ *  loaded once and shared (read-only) by every worker,
+ *  so only their small evaluation contexts are per
+ *  thread. Finished chunks are handed back to the
+ *  calling thread strictly in entry order, which
+ *  fills the output exactly as the serial loop would.
+ */
+namespace ParallelApply {
+
+  // --------------------------------------------------------------------------
+  //! Where to read entries from
+  // --------------------------------------------------------------------------
+  struct Source {
+    std::string              file;                              // path to input file
+    std::string              tuple;                             // name of input tuple
+    NTupleIO::Backend        backend = NTupleIO::Backend::Tree; // backend of input tuple
+    std::string              cache   = "";                      // path to a feature cache to read instead (optional)
+    std::vector<std::string> active;                            // variables to read (empty to read all)
+    TCut                     cut     = "";                      // entries failing this are skipped
+  };
+
+  // --------------------------------------------------------------------------
+  //! Where to find trained models
+  // --------------------------------------------------------------------------
+  struct Models {
+    std::string directory;  // tmva output directory
+    std::string name;       // name of tmva process
+  };
+
+  // --------------------------------------------------------------------------
+  //! How to split up the work
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::size_t threads    = 4;      // number of worker threads
+    std::size_t block_size = 4096;   // entries per block read by a worker
+    std::size_t chunk_size = 65536;  // entries per unit of work
+    std::size_t max_chunks = 0;      // max chunks done but not yet written (0 = 2 per thread)
+  };
+
+  // --------------------------------------------------------------------------
+  //! What came out of applying
+  // --------------------------------------------------------------------------
+  struct Result {
+    uint64_t    written = 0;  // number of entries passed to the sink
+    std::string error;        // why applying stopped early (empty if it didn't)
+  };
+
+  // receives each selected entry's outputs, in entry order
+  typedef std::function<void(std::span<const float>)> Sink;
+
+
+
+  // --------------------------------------------------------------------------
+  //! State shared between workers and the writing thread
+  // --------------------------------------------------------------------------
+  struct State {
+    std::atomic<std::size_t>                  next    = 0;
+    std::size_t                               written = 0;
+    bool                                      failed  = false;
+    std::string                               error;
+    std::map<std::size_t, std::vector<float>> done;
+    std::mutex                                mutex;
+    std::mutex                                setup;
+    std::condition_variable                   ready;
+  };
+
+
+
+  // --------------------------------------------------------------------------
+  //! Stop every thread waiting on shared state
+  // --------------------------------------------------------------------------
+  /*! Only the first error is kept. */
+  inline void Fail(State& state, const std::string& error) {
+
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (!state.failed) state.error = error;
+      state.failed = true;
+    }
+    state.ready.notify_all();
+    return;
+
+  }  // end 'Fail(State&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Work through chunks on one thread
+  // --------------------------------------------------------------------------
+  /*! Setting up and tearing down ROOT & TMVA objects
+   *  is serialized, only reading and evaluating run
+   *  concurrently.
+   */
+  inline void RunWorker(
+    State& state,
+    const Source& source,
+    const Models& models,
+    const TMVAHelper::Reader& prototype,
+    const NTupleHelper& input,
+    const uint64_t nEntries,
+    const Settings& settings
+  ) {
+
+    const std::size_t nChunks   = (nEntries + settings.chunk_size - 1) / settings.chunk_size;
+    const std::size_t maxChunks = (settings.max_chunks > 0) ? settings.max_chunks : 2 * settings.threads;
+    const bool        useCut    = !std::string(source.cut.GetTitle()).empty();
+
+    // per-worker helpers
+    NTupleHelper       in_helper( input.GetVariables(), input.GetBranches() );
+    TMVAHelper::Reader read_helper = prototype;
+
+    // open input, set up selector & reader
+    //   - n.b. any failure stops every thread, since the
+    //     chunks of this one would never be written
+    TFile*                              file   = nullptr;
+    TMVA::Reader*                       reader = nullptr;
+    FeatureCache                        cache;
+    std::unique_ptr<NTupleIO::Reader>   tuple;
+    std::unique_ptr<NTupleIO::Selector> selector;
+    std::unique_ptr<NTupleBlockReader>  blocks;
+    try {
+      {
+        std::lock_guard<std::mutex> lock(state.setup);
+        if (source.cache.empty()) {
+          file = TFile::Open(source.file.data(), "read");
+          if (!file || file -> IsZombie()) {
+            throw std::runtime_error("couldn't open input file '" + source.file + "'");
+          }
+          tuple = std::make_unique<NTupleIO::Reader>(in_helper, file, source.tuple, source.backend);
+        } else {
+          if (!cache.Open(source.cache)) {
+            throw std::runtime_error("couldn't open feature cache '" + source.cache + "'");
+          }
+          tuple = std::make_unique<NTupleIO::Reader>(in_helper, cache, source.tuple);
+        }
+        if (!source.active.empty()) {
+          tuple -> SetActiveVariables(source.active);
+        }
+        selector = std::make_unique<NTupleIO::Selector>("selector", source.cut, *tuple);
+        blocks   = std::make_unique<NTupleBlockReader>(*tuple, settings.block_size);
+        blocks -> SetSelector(*selector);
+
+        reader = new TMVA::Reader(read_helper.CompressOptions().data());
+        read_helper.ReadVariables(reader, in_helper);
+        read_helper.BookMethodsToRead(reader, models.directory, models.name);
+      }
+
+      // loop over chunks
+      const std::size_t nOutputs = read_helper.GetOutputs().size();
+      for (std::size_t iChunk = state.next++; iChunk < nChunks; iChunk = state.next++) {
+
+        // don't get too far ahead of the writer
+        {
+          std::unique_lock<std::mutex> lock(state.mutex);
+          state.ready.wait(lock, [&]() {return state.failed || (iChunk < state.written + maxChunks);});
+          if (state.failed) break;
+        }
+
+        // evaluate each block of the chunk
+        std::vector<float> rows;
+        blocks -> SetRange(iChunk * settings.chunk_size, (iChunk + 1) * settings.chunk_size);
+        while (blocks -> Next()) {
+
+          read_helper.EvaluateMethods(reader, in_helper, *blocks, useCut);
+
+          std::span<const uint8_t> isInCut = blocks -> GetMask();
+          for (std::size_t iRow = 0; iRow < blocks -> GetSize(); ++iRow) {
+            if (useCut && !isInCut[iRow]) continue;
+            for (std::size_t iOut = 0; iOut < nOutputs; ++iOut) {
+              rows.push_back( read_helper.GetColumn(iOut)[iRow] );
+            }
+          }
+        }  // end block loop
+
+        // a chunk cut short can't be written as if complete
+        if (blocks -> HasError()) {
+          Fail(state, "couldn't read every entry of chunk " + std::to_string(iChunk));
+          break;
+        }
+
+        // hand chunk over to writer
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          state.done[iChunk] = std::move(rows);
+        }
+        state.ready.notify_all();
+
+      }  // end chunk loop
+    } catch (const std::exception& error) {
+      Fail(state, error.what());
+    }
+
+    // clean up
+    {
+      std::lock_guard<std::mutex> lock(state.setup);
+      blocks.reset();
+      selector.reset();
+      tuple.reset();
+      delete reader;
+      if (file) file -> Close();
+      delete file;
+    }
+    return;
+
+  }  // end 'RunWorker(State&, Source&, Models&, TMVAHelper::Reader&, NTupleHelper&, uint64_t, Settings&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Apply models to every entry of a source
+  // --------------------------------------------------------------------------
+  /*! Spawns the workers, then passes each selected
+   *  entry's outputs (ordered as `prototype.GetOutputs()`)
+   *  to `sink` on the calling thread, in entry order.
+   *  `prototype` and `input` are only copied, so they
+   *  can be ones set up for a serial pass. Returns the
+   *  number of entries passed to the sink, and an error
+   *  if any worker failed (the rest then stop too).
+   */
+  inline Result Run(
+    const Source& source,
+    const Models& models,
+    const TMVAHelper::Reader& prototype,
+    const NTupleHelper& input,
+    const uint64_t nEntries,
+    const Settings& settings,
+    const Sink& sink,
+    const bool doProgress = false
+  ) {
+
+    if ((settings.threads == 0) || (settings.chunk_size == 0)) {
+      std::cerr << "PANIC: parallel apply needs at least one thread and a non-zero chunk size!" << std::endl;
+      assert((settings.threads > 0) && (settings.chunk_size > 0));
+    }
+
+    // make sure root & tmva are ready for threads
+    ROOT::EnableThreadSafety();
+    TMVA::Tools::Instance();
+
+    // spin up workers
+    State                    state;
+    std::vector<std::thread> workers;
+    for (std::size_t iThread = 0; iThread < settings.threads; ++iThread) {
+      workers.emplace_back(
+        RunWorker,
+        std::ref(state),
+        std::cref(source),
+        std::cref(models),
+        std::cref(prototype),
+        std::cref(input),
+        nEntries,
+        std::cref(settings)
+      );
+    }
+
+    // write chunks out in order as they finish
+    const std::size_t nChunks  = (nEntries + settings.chunk_size - 1) / settings.chunk_size;
+    const std::size_t nOutputs = prototype.GetOutputs().size();
+    uint64_t          nWritten = 0;
+    for (std::size_t iChunk = 0; iChunk < nChunks; ++iChunk) {
+
+      // wait for next chunk
+      std::vector<float> rows;
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.ready.wait(lock, [&]() {return state.failed || (state.done.count(iChunk) > 0);});
+        if (state.failed) break;
+        rows = std::move(state.done[iChunk]);
+        state.done.erase(iChunk);
+      }
+
+      // pass each entry to sink
+      for (std::size_t iRow = 0; iRow < rows.size(); iRow += nOutputs) {
+        sink( std::span<const float>(rows.data() + iRow, nOutputs) );
+        ++nWritten;
+      }
+
+      // let workers move ahead
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        ++state.written;
+      }
+      state.ready.notify_all();
+
+      // announce progress
+      if (doProgress) {
+        const uint64_t nRead = std::min((iChunk + 1) * settings.chunk_size, nEntries);
+        std::cout << "      Processing entry " << nRead << "/" << nEntries << "...";
+        if (nRead < nEntries) {
+          std::cout << "\r" << std::flush;
+        } else {
+          std::cout << std::endl;
+        }
+      }
+    }  // end chunk loop
+
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    if (state.failed) {
+      std::cerr << "WARNING: applying stopped after " << nWritten << " entries: " << state.error << "!" << std::endl;
+    }
+    return {nWritten, state.error};
+
+  }  // end 'Run(Source&, Models&, TMVAHelper::Reader&, NTupleHelper&, uint64_t, Settings&, Sink&, bool)'
+
+}  // end ParallelApply namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,488 @@
+/// ===========================================================================
+/*! \file   ParallelTrain.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to train each TMVA method in its own
+ *  process, and to merge their outputs back into a
+ *  single file.
+ */
+/// ===========================================================================
+
+#ifndef ParallelTrain_hxx
+#define ParallelTrain_hxx
+
+// c++ utilities
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <functional>
+// system utilities
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+// root libraries
+#include <TCut.h>
+#include <TKey.h>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TList.h>
+#include <TROOT.h>
+#include <TTree.h>
+#include <TClass.h>
+#include <TBranch.h>
+#include <TSystem.h>
+#include <TDirectory.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Types.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "TMVAHelper.hxx"
+
+
+
+// ============================================================================
+//! Parallel Train
+// ============================================================================
+/*! TMVA::Factory trains its methods one after another
+ *  and isn't thread-safe, so here every method gets a
+ *  factory of its own in a forked process. Each job
+ *  prepares the same dataset with the same split, so
+ *  the jobs train & test on identical events, and
+ *  each writes the usual weight file
+ *  ('<directory>/weights/<name>_<method>.weights.xml')
+ *  plus its own output file. Wall-clock time is then
+ *  set by the slowest method rather than the sum.
+ */
+namespace ParallelTrain {
+
+  // --------------------------------------------------------------------------
+  //! What to train on
+  // --------------------------------------------------------------------------
+  /*! n.b. `tree` is called inside each job, so a tree
+   *  read from disk should be opened there (forked
+   *  processes share file offsets); a memory-resident
+   *  tree can simply be returned. If `test` is set,
+   *  the events are already split (see
+   *  PreparedDataset.hxx): `tree` gives the training and
+   *  `test` the testing events.
+   */
+  struct Dataset {
+    std::function<TTree*()> tree;                     // gets tree to train on
+    std::function<TTree*()> test;                     // gets tree to test on (optional)
+    TCut                    cut            = "";      // training cuts
+    float                   weight         = 1.0;     // weight of tree
+    bool                    add_spectators = false;   // whether or not to add spectators
+  };
+
+  // --------------------------------------------------------------------------
+  //! How to run the jobs
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;       // name of TMVA process
+    std::string directory;  // tmva directory (name of data loader)
+    std::string stem;       // prefix of per-method output & log files
+    std::size_t jobs = 0;   // max no. of methods trained at once (0 = all)
+  };
+
+  // --------------------------------------------------------------------------
+  //! What became of a job
+  // --------------------------------------------------------------------------
+  enum class Outcome {Started, Done, Failed, Skipped, TimedOut};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Wait for one of a set of jobs to finish
+  // --------------------------------------------------------------------------
+  /*! Only the jobs in `running` are waited on, so
+   *  other children of the process (e.g. ones started
+   *  by ROOT) are never reaped by mistake. Returns the
+   *  pid of the finished job & sets its `status`,
+   *  returns 0 if none finished before `until`, or
+   *  returns -1 if nothing is running. A job that
+   *  can't be waited on is returned with a `status`
+   *  of -1, i.e. as failed.
+   */
+  inline pid_t WaitForJob(
+    const std::map<pid_t, std::size_t>& running,
+    int& status,
+    const std::chrono::steady_clock::time_point until
+  ) {
+
+    while (!running.empty()) {
+      for (const auto& [pid, job] : running) {
+        const pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done == pid) return pid;
+        if (done < 0) {
+          status = -1;
+          return pid;
+        }
+      }
+      if (std::chrono::steady_clock::now() >= until) return 0;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return -1;
+
+  }  // end 'WaitForJob(std::map<pid_t, std::size_t>&, int&, time_point)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Run a set of jobs, each in its own process
+  // --------------------------------------------------------------------------
+  /*! Job i runs `job(i)` in a forked process, whose
+   *  exit status is what it returns, with its printout
+   *  going to `logOf(i)`. At most `maxJobs` run at
+   *  once, and jobs are only started before
+   *  `deadline`: the ones left then are skipped and
+   *  the ones still running are killed. `report` is
+   *  told when a job starts & how it ended, with the
+   *  seconds it ran for. Returns the outcome of each
+   *  job.
+   */
+  inline std::vector<Outcome> RunJobs(
+    const std::size_t nJobs,
+    const std::size_t maxJobs,
+    const std::function<std::string(std::size_t)>& logOf,
+    const std::function<int(std::size_t)>& job,
+    const std::function<void(std::size_t, Outcome, double)>& report,
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()
+  ) {
+
+    std::vector<Outcome>                                outcomes(nJobs, Outcome::Skipped);
+    std::vector<std::chrono::steady_clock::time_point>  starts(nJobs);
+    std::map<pid_t, std::size_t>                        running;
+    std::size_t                                         next     = 0;
+    bool                                                isKilled = false;
+    while ((next < nJobs) || !running.empty()) {
+
+      const bool isOver = (std::chrono::steady_clock::now() >= deadline);
+
+      // launch next job if there's room & time
+      if ((next < nJobs) && (running.size() < std::max<std::size_t>(maxJobs, 1)) && !isOver) {
+
+        const std::string log = logOf(next);
+
+        std::cout.flush();
+        std::fflush(nullptr);
+        const pid_t pid = fork();
+        if (pid == 0) {
+          gSystem -> RedirectOutput(log.data(), "w");
+
+          // forget files opened by the parent, so
+          // nothing in the job ever writes to them
+          gROOT -> GetListOfFiles() -> Clear("nodelete");
+          _exit( job(next) );
+        }
+        if (pid < 0) {
+          outcomes[next] = Outcome::Failed;
+          report(next, Outcome::Failed, 0.);
+        } else {
+          outcomes[next] = Outcome::Started;
+          starts[next]   = std::chrono::steady_clock::now();
+          running[pid]   = next;
+          report(next, Outcome::Started, 0.);
+        }
+        ++next;
+        continue;
+      }
+
+      // out of time: skip what's left & stop what's running
+      if (isOver && !isKilled) {
+        for (; next < nJobs; ++next) {
+          report(next, Outcome::Skipped, 0.);
+        }
+        for (const auto& [pid, iJob] : running) {
+          kill(pid, SIGKILL);
+        }
+        isKilled = true;
+      }
+
+      // otherwise wait for one to finish, or for
+      // the deadline to pass
+      int         status = 0;
+      const pid_t pid    = WaitForJob(running, status, isKilled ? std::chrono::steady_clock::time_point::max() : deadline);
+      if (pid == 0) continue;
+      if (pid < 0) break;
+
+      const std::size_t iJob = running[pid];
+      const double      time = std::chrono::duration<double>(std::chrono::steady_clock::now() - starts[iJob]).count();
+      running.erase(pid);
+
+      if (isKilled && WIFSIGNALED(status)) {
+        outcomes[iJob] = Outcome::TimedOut;
+      } else if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+        outcomes[iJob] = Outcome::Done;
+      } else {
+        outcomes[iJob] = Outcome::Failed;
+      }
+      report(iJob, outcomes[iJob], time);
+    }  // end job loop
+    return outcomes;
+
+  }  // end 'RunJobs(std::size_t, std::size_t, std::function<...>&, std::function<...>&, std::function<...>&, time_point)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Add variables & events of a dataset to a data loader
+  // --------------------------------------------------------------------------
+  inline void LoadDataset(
+    TMVAHelper::Trainer& helper,
+    const Dataset& data,
+    TMVA::DataLoader* loader
+  ) {
+
+    helper.LoadVariables(loader, data.add_spectators);
+    if (data.test) {
+      loader -> AddRegressionTree(data.tree(), data.weight, TMVA::Types::kTraining);
+      loader -> AddRegressionTree(data.test(), data.weight, TMVA::Types::kTesting);
+    } else {
+      loader -> AddRegressionTree(data.tree(), data.weight);
+    }
+    loader -> PrepareTrainingAndTestTree(data.cut, helper.CompressTrainingOptions().data());
+    return;
+
+  }  // end 'LoadDataset(TMVAHelper::Trainer&, Dataset&, TMVA::DataLoader*)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train, test, & evaluate a single method
+  // --------------------------------------------------------------------------
+  /*! Runs inside a job; returns the exit status of
+   *  the job.
+   */
+  inline int TrainMethod(
+    TMVAHelper::Trainer& helper,
+    const Dataset& data,
+    const Settings& settings,
+    const std::string& method,
+    const std::string& path
+  ) {
+
+    TFile* output = TFile::Open(path.data(), "recreate");
+    if (!output || output -> IsZombie()) return 1;
+
+    TMVA::Tools::Instance();
+    TMVA::Factory*    factory = new TMVA::Factory(settings.name.data(), output, helper.CompressFactoryOptions().data());
+    TMVA::DataLoader* loader  = new TMVA::DataLoader(settings.directory.data());
+    bool              isGood  = true;
+    try {
+      LoadDataset(helper, data, loader);
+      helper.BookMethodToTrain(factory, loader, method);
+
+      factory -> TrainAllMethods();
+      factory -> TestAllMethods();
+      factory -> EvaluateAllMethods();
+    } catch (const std::exception& error) {
+      std::cerr << "PANIC: training '" << method << "' failed: " << error.what() << std::endl;
+      isGood = false;
+    }
+
+    output -> Close();
+    delete factory;
+    delete loader;
+    return isGood ? 0 : 1;
+
+  }  // end 'TrainMethod(TMVAHelper::Trainer&, Dataset&, Settings&, std::string&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train every method of a helper in separate processes
+  // --------------------------------------------------------------------------
+  /*! Output of the job for method X goes to
+   *  '<stem>.X.root' and its printout to '<stem>.X.log'.
+   *  Returns the output files of the jobs that
+   *  succeeded, in the order of the helper's methods.
+   */
+  inline std::vector<std::string> Run(
+    TMVAHelper::Trainer& helper,
+    const Dataset& data,
+    const Settings& settings
+  ) {
+
+    const std::vector<std::string> methods = helper.GetMethods();
+    const std::size_t              maxJobs = (settings.jobs > 0) ? settings.jobs : methods.size();
+
+    // make sure weights directory exists before
+    // jobs race to create it
+    gSystem -> mkdir((settings.directory + "/weights").data(), true);
+
+    // output & printout of the job for each method
+    auto pathOf = [&](const std::size_t iMethod) {return settings.stem + "." + methods[iMethod] + ".root";};
+    auto logOf  = [&](const std::size_t iMethod) {return settings.stem + "." + methods[iMethod] + ".log";};
+
+    const std::vector<Outcome> outcomes = RunJobs(
+      methods.size(),
+      maxJobs,
+      logOf,
+      [&](const std::size_t iMethod) {
+        return TrainMethod(helper, data, settings, methods[iMethod], pathOf(iMethod));
+      },
+      [&](const std::size_t iMethod, const Outcome outcome, const double time) {
+        if (outcome == Outcome::Started) {
+          std::cout << "      Started training '" << methods[iMethod] << "' (log: " << logOf(iMethod) << ")" << std::endl;
+        } else if (outcome == Outcome::Done) {
+          std::cout << "      Finished training '" << methods[iMethod] << "' in " << time << " s" << std::endl;
+        } else {
+          std::cerr << "WARNING: training '" << methods[iMethod] << "' failed! See " << logOf(iMethod) << std::endl;
+        }
+      }
+    );
+
+    std::vector<std::string> files;
+    for (std::size_t iMethod = 0; iMethod < methods.size(); ++iMethod) {
+      if (outcomes[iMethod] == Outcome::Done) files.push_back( pathOf(iMethod) );
+    }
+    return files;
+
+  }  // end 'Run(TMVAHelper::Trainer&, Dataset&, Settings&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Add branches of one tree missing from another
+  // --------------------------------------------------------------------------
+  /*! Both trees must hold the same events in the same
+   *  order (e.g. the test trees of two jobs). Only
+   *  single-value float branches (like the outputs of
+   *  a single-target regression) are copied.
+   */
+  inline bool AppendBranches(TTree* source, TTree* target) {
+
+    const Long64_t nEntries = source -> GetEntries();
+    if (nEntries != target -> GetEntries()) {
+      std::cerr << "WARNING: can't merge tree '" << source -> GetName() << "', no. of entries differ!" << std::endl;
+      return false;
+    }
+
+    bool isGood = true;
+    for (TObject* object : *(source -> GetListOfBranches())) {
+
+      const std::string name = object -> GetName();
+      if (target -> GetBranch(name.data())) continue;
+
+      TLeaf* leaf = source -> GetLeaf(name.data());
+      if (!leaf || (leaf -> GetLen() != 1) || (std::string(leaf -> GetTypeName()) != "Float_t")) {
+        std::cerr << "WARNING: can't merge branch '" << name << "' of tree '" << source -> GetName() << "'!" << std::endl;
+        isGood = false;
+        continue;
+      }
+
+      // read only this branch & fill its copy
+      Float_t value = 0.;
+      source -> SetBranchStatus("*", false);
+      source -> SetBranchStatus(name.data(), true);
+      source -> SetBranchAddress(name.data(), &value);
+
+      TBranch* branch = target -> Branch(name.data(), &value, (name + "/F").data());
+      for (Long64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+        source -> GetEntry(iEntry);
+        branch -> Fill();
+      }
+      branch -> ResetAddress();
+      source -> ResetBranchAddresses();
+    }
+    source -> SetBranchStatus("*", true);
+    return isGood;
+
+  }  // end 'AppendBranches(TTree*, TTree*)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Copy the contents of one directory into another
+  // --------------------------------------------------------------------------
+  /*! Objects already in the target are kept as is,
+   *  except for trees: branches they're missing are
+   *  appended from the source.
+   */
+  inline bool CopyDirectory(TDirectory* source, TDirectory* target) {
+
+    bool isGood = true;
+    for (TObject* object : *(source -> GetListOfKeys())) {
+
+      // only take latest cycle of each key
+      TKey*             key  = (TKey*) object;
+      const std::string name = key -> GetName();
+      if (source -> GetKey(name.data()) != key) continue;
+
+      TClass* type = TClass::GetClass(key -> GetClassName());
+      if (type && type -> InheritsFrom(TDirectory::Class())) {
+        TDirectory* from = source -> GetDirectory(name.data());
+        TDirectory* to   = target -> GetDirectory(name.data());
+        if (!to) to = target -> mkdir(name.data());
+        isGood &= CopyDirectory(from, to);
+        continue;
+      }
+
+      if (type && type -> InheritsFrom(TTree::Class())) {
+        TTree* from = (TTree*) source -> Get(name.data());
+        TTree* to   = (TTree*) target -> Get(name.data());
+        target -> cd();
+        if (!to) {
+          to = from -> CloneTree(-1, "fast");
+        } else {
+          isGood &= AppendBranches(from, to);
+        }
+        to -> Write("", TObject::kOverwrite);
+        continue;
+      }
+
+      if (!target -> GetKey(name.data())) {
+        TObject* copy = key -> ReadObj();
+        target -> WriteTObject(copy, name.data());
+        delete copy;
+      }
+    }  // end key loop
+    return isGood;
+
+  }  // end 'CopyDirectory(TDirectory*, TDirectory*)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Merge outputs of several jobs into one file
+  // --------------------------------------------------------------------------
+  /*! Everything the jobs have in common (e.g. plots of
+   *  the input variables) is taken from the first file;
+   *  each method's own directory from its job; and the
+   *  per-method output branches of the train & test
+   *  trees are appended as columns, so the result looks
+   *  like the output of a single factory.
+   */
+  inline bool Merge(const std::vector<std::string>& files, TDirectory* output) {
+
+    bool isGood = true;
+    for (const std::string& path : files) {
+      TFile* input = TFile::Open(path.data(), "read");
+      if (!input || input -> IsZombie()) {
+        std::cerr << "WARNING: couldn't open '" << path << "' to merge!" << std::endl;
+        isGood = false;
+        continue;
+      }
+      isGood &= CopyDirectory(input, output);
+      input -> Close();
+      delete input;
+    }
+    return isGood;
+
+  }  // end 'Merge(std::vector<std::string>&, TDirectory*)'
+
+}  // end ParallelTrain namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,582 @@
+/// ===========================================================================
+/*! \file   PreparedDataset.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Classes to persist the train/test split TMVA
+ *  prepares (cut-selected rows, chosen variables,
+ *  split) so later trainings can skip straight to
+ *  training.
+ */
+/// ===========================================================================
+
+#ifndef PreparedDataset_hxx
+#define PreparedDataset_hxx
+
+// c++ utilities
+#include <span>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+// root libraries
+#include <TCut.h>
+#include <TTree.h>
+// tmva components
+#include <TMVA/Types.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "TMVAHelper.hxx"
+#include "FeatureCache.hxx"
+#include "NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! Prepared Caches
+// ============================================================================
+/*! A set of feature caches, each holding some of the
+ *  events passing a cut with only the columns TMVA is
+ *  given (targets, training variables, and spectators
+ *  if they're added), and a reader presenting each
+ *  one as a tuple. Which event goes to which cache is
+ *  up to the owner: a PreparedDataset splits them into
+ *  training & testing events, and CrossValidate::Folds
+ *  deals them out into folds.
+ */
+class PreparedCaches {
+
+  private:
+
+    // data members
+    std::vector<std::string>                       m_variables;
+    std::vector<std::unique_ptr<FeatureCache>>     m_caches;
+    std::vector<std::unique_ptr<NTupleIO::Reader>> m_readers;
+    std::unique_ptr<NTupleHelper>                  m_helper;
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Getters
+    // ------------------------------------------------------------------------
+    inline std::size_t                     GetNCaches()   const {return m_caches.size();}
+    inline const std::vector<std::string>& GetVariables() const {return m_variables;}
+    inline const FeatureCache&             GetCache(const std::size_t index) const {return *m_caches.at(index);}
+    inline NTupleHelper&                   GetHelper()          {return *m_helper;}
+    inline NTupleIO::Reader&               GetSource(const std::size_t index) {return *m_readers.at(index);}
+
+    // ------------------------------------------------------------------------
+    //! Get memory-resident tree of a cache
+    // ------------------------------------------------------------------------
+    /*! n.b. the trees point at buffers owned by the
+     *  caches, so they have to outlive them.
+     */
+    inline TTree* GetTree(const std::size_t index) {
+
+      return (index < m_readers.size()) ? m_readers[index] -> GetTree() : nullptr;
+
+    }  // end 'GetTree(std::size_t)'
+
+    // ------------------------------------------------------------------------
+    //! Count events passing a cut
+    // ------------------------------------------------------------------------
+    /*! Returns false if an entry can't be read.
+     */
+    static inline bool Count(NTupleIO::Reader& source, const TCut& cut, uint64_t& nRows) {
+
+      NTupleIO::Selector selector("countSelector", cut, source);
+      nRows = 0;
+      for (uint64_t iEntry = 0; iEntry < source.GetEntries(); ++iEntry) {
+        if (source.GetEntry(iEntry) < 0) {
+          std::cerr << "WARNING error in entry #" << iEntry << "! Not writing prepared caches!" << std::endl;
+          return false;
+        }
+        if (selector.Pass()) ++nRows;
+      }
+      return true;
+
+    }  // end 'Count(NTupleIO::Reader&, TCut&, uint64_t&)'
+
+    // ------------------------------------------------------------------------
+    //! Write events passing a cut to the caches
+    // ------------------------------------------------------------------------
+    /*! `pick` is called for each selected event, in
+     *  order, and gives the index of the cache it goes
+     *  to (or one past the last cache to drop it). Each
+     *  event goes straight to its cache, so nothing but
+     *  the current entry is held in memory.
+     */
+    inline bool Write(
+      NTupleIO::Reader& source,
+      const TCut& cut,
+      const uint64_t key,
+      const std::vector<std::string>& paths,
+      const std::function<std::size_t()>& pick
+    ) {
+
+      // map variables onto columns of the source
+      NTupleHelper*            helper = source.GetHelper();
+      std::vector<std::size_t> columns;
+      for (const std::string& var : m_variables) {
+        columns.push_back( helper -> GetIndex(var) );
+      }
+
+      std::vector<std::unique_ptr<FeatureCache::Builder>> builders;
+      for (const std::string& path : paths) {
+        builders.push_back( std::make_unique<FeatureCache::Builder>(path, m_variables, key, cut.GetTitle()) );
+      }
+
+      NTupleIO::Selector selector("prepareSelector", cut, source);
+      std::vector<float> row(m_variables.size());
+      for (uint64_t iEntry = 0; iEntry < source.GetEntries(); ++iEntry) {
+        if (source.GetEntry(iEntry) < 0) {
+          std::cerr << "WARNING error in entry #" << iEntry << "! Not writing prepared caches!" << std::endl;
+          return false;
+        }
+        if (!selector.Pass()) continue;
+
+        const std::size_t index = pick();
+        if (index >= builders.size()) continue;
+
+        std::span<const float> values = helper -> GetValueSpan();
+        for (std::size_t iCol = 0; iCol < columns.size(); ++iCol) {
+          row[iCol] = values[ columns[iCol] ];
+        }
+        if (!builders[index] -> Append(row)) {
+          std::cerr << "WARNING couldn't write entry #" << iEntry << " to '" << paths[index] << "'!" << std::endl;
+          return false;
+        }
+      }
+
+      bool isGood = true;
+      for (auto& builder : builders) {
+        isGood &= builder -> Close();
+      }
+      return isGood;
+
+    }  // end 'Write(NTupleIO::Reader&, TCut&, uint64_t, std::vector<std::string>&, std::function<std::size_t()>&)'
+
+    // ------------------------------------------------------------------------
+    //! Open caches, (re)building them if they're stale
+    // ------------------------------------------------------------------------
+    /*! Cache i is read from `paths[i]` into a tree named
+     *  `names[i]`. If any cache doesn't match `key`, the
+     *  variables, & the cut, all are closed & rebuilt by
+     *  `write` (e.g. with Write()), and removed if that
+     *  fails so they're never fallen back on. Returns
+     *  true if the caches had to be (re)built.
+     */
+    inline bool Update(
+      const std::vector<std::string>& paths,
+      const std::vector<std::string>& names,
+      const TCut& cut,
+      const uint64_t key,
+      const std::function<bool()>& write
+    ) {
+
+      m_readers.clear();
+      m_caches.resize(paths.size());
+
+      bool isStale = false;
+      for (std::size_t iCache = 0; iCache < paths.size(); ++iCache) {
+        if (!m_caches[iCache]) m_caches[iCache] = std::make_unique<FeatureCache>();
+        m_caches[iCache] -> Open(paths[iCache]);
+        isStale |= !m_caches[iCache] -> Matches(key, m_variables, cut.GetTitle());
+      }
+
+      if (isStale) {
+
+        // release any stale mappings before rewriting
+        for (auto& cache : m_caches) {
+          cache -> Close();
+        }
+
+        // & never fall back on them if that fails
+        if (!write()) {
+          for (const std::string& path : paths) {
+            std::remove(path.data());
+            std::remove((path + ".tmp").data());
+          }
+        }
+
+        for (std::size_t iCache = 0; iCache < paths.size(); ++iCache) {
+          const bool isGood = m_caches[iCache] -> Open(paths[iCache])
+                           && m_caches[iCache] -> Matches(key, m_variables, cut.GetTitle());
+          if (!isGood) {
+            std::cerr << "PANIC: couldn't build prepared cache '" << paths[iCache] << "'!" << std::endl;
+            assert(isGood);
+          }
+        }
+      }
+
+      for (std::size_t iCache = 0; iCache < paths.size(); ++iCache) {
+        m_readers.push_back( std::make_unique<NTupleIO::Reader>(*m_helper, *m_caches[iCache], names.at(iCache)) );
+      }
+      return isStale;
+
+    }  // end 'Update(std::vector<std::string>&, std::vector<std::string>&, TCut&, uint64_t, std::function<bool()>&)'
+
+    // ------------------------------------------------------------------------
+    //! Default ctor/dtor
+    // ------------------------------------------------------------------------
+    PreparedCaches()  {};
+    ~PreparedCaches() {};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a trainer & a no. of caches
+    // ------------------------------------------------------------------------
+    /*! Takes the variables of the trainer; spectators
+     *  are only kept if they're added to the data
+     *  loader. Caches stay closed until Update().
+     */
+    PreparedCaches(const TMVAHelper::Trainer& trainer, const std::size_t nCaches, const bool add_spectators = false) {
+
+      m_variables = trainer.GetTargets();
+      for (const std::string& train : trainer.GetTrainers()) {
+        m_variables.push_back(train);
+      }
+      if (add_spectators) {
+        for (const std::string& spec : trainer.GetSpectators()) {
+          m_variables.push_back(spec);
+        }
+      }
+      m_helper = std::make_unique<NTupleHelper>(m_variables);
+      for (std::size_t iCache = 0; iCache < nCaches; ++iCache) {
+        m_caches.push_back( std::make_unique<FeatureCache>() );
+      }
+
+    }  // end ctor(TMVAHelper::Trainer&, std::size_t, bool)'
+
+};  // end PreparedCaches
+
+
+
+// ============================================================================
+//! Prepared Dataset
+// ============================================================================
+/*! Holds two feature caches, one with the training
+ *  and one with the testing events, each with only
+ *  the columns TMVA is given (targets, training
+ *  variables, and spectators if they're added). The
+ *  caches are keyed on the hash of the input file,
+ *  the variables, the cut, and the split options, and
+ *  are only rebuilt when one of those changes.
+ *
+ *  The split follows TMVA's nTrain_Regression,
+ *  nTest_Regression, SplitMode, and SplitSeed options
+ *  (including the meaning of zero counts), but draws
+ *  its own random subsets: the events picked for
+ *  training differ from what TMVA would pick, though
+ *  they're the same from one run to the next. Events
+ *  are streamed into the caches in input order.
+ */
+class PreparedDataset {
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! How to split selected events
+    // ------------------------------------------------------------------------
+    struct Split {
+      uint64_t                 train  = 0;         // no. of training events (0 = rest or half)
+      uint64_t                 test   = 0;         // no. of testing events (0 = rest or half)
+      std::string              mode   = "Random";  // "Random", "Alternate", or "Block"
+      uint64_t                 seed   = 100;       // seed of random split
+      std::vector<std::string> others;             // remaining (non-split) options
+    };
+
+  private:
+
+    // data members
+    Split          m_split;
+    PreparedCaches m_caches;
+
+    // ------------------------------------------------------------------------
+    //! Assigns selected events to training or testing as they're read
+    // ------------------------------------------------------------------------
+    /*! Events are numbered in the order they pass the
+     *  cut; each one goes to exactly one of training,
+     *  testing, or neither, with exactly `nTrain` &
+     *  `nTest` events in the first two.
+     */
+    class Assigner {
+
+      private:
+
+        // data members
+        std::string     m_mode;
+        uint64_t        m_rows       = 0;
+        uint64_t        m_train      = 0;
+        uint64_t        m_test       = 0;
+        uint64_t        m_seen       = 0;
+        uint64_t        m_need_train = 0;
+        uint64_t        m_need_test  = 0;
+        std::mt19937_64 m_engine;
+
+      public:
+
+        // possible assignments
+        enum class Type {Train, Test, None};
+
+        // --------------------------------------------------------------------
+        //! Assign the next event
+        // --------------------------------------------------------------------
+        /*! Random splits use selection sampling, so every
+         *  subset of the right size is equally likely;
+         *  alternate splits give the even events first
+         *  pick, like TMVA.
+         */
+        inline Type Next() {
+
+          const uint64_t row = m_seen++;
+          if (m_mode == "Block" || m_mode == "Alternate") {
+            const uint64_t nEven    = (m_rows + 1) / 2;
+            const uint64_t position = (m_mode == "Block") ? row : (((row % 2) == 0) ? row / 2 : nEven + (row / 2));
+            if (position < m_train)          return Type::Train;
+            if (position < m_train + m_test) return Type::Test;
+            return Type::None;
+          }
+
+          const uint64_t pick = m_engine() % (m_rows - row);
+          if (pick < m_need_train) {
+            --m_need_train;
+            return Type::Train;
+          }
+          if (pick < m_need_train + m_need_test) {
+            --m_need_test;
+            return Type::Test;
+          }
+          return Type::None;
+
+        }  // end 'Next()'
+
+        // --------------------------------------------------------------------
+        //! ctor accepting a split & the no. of events to assign
+        // --------------------------------------------------------------------
+        Assigner(const Split& split, const uint64_t nRows, const uint64_t nTrain, const uint64_t nTest) {
+
+          m_mode       = split.mode;
+          m_rows       = nRows;
+          m_train      = nTrain;
+          m_test       = nTest;
+          m_need_train = nTrain;
+          m_need_test  = nTest;
+          m_engine.seed(split.seed);
+
+        }  // end ctor(Split&, uint64_t, uint64_t, uint64_t)'
+
+    };  // end PreparedDataset::Assigner
+
+    // ------------------------------------------------------------------------
+    //! Split selected events & write caches
+    // ------------------------------------------------------------------------
+    /*! Reads the source twice: once to count the events
+     *  passing the cut, & once to write each one straight
+     *  to the training or testing cache.
+     */
+    inline bool Write(
+      NTupleIO::Reader& source,
+      const TCut& cut,
+      const uint64_t key,
+      const std::string& stem
+    ) {
+
+      uint64_t nRows = 0;
+      if (!PreparedCaches::Count(source, cut, nRows)) return false;
+
+      // figure out no. of events of each type
+      uint64_t nTrain = m_split.train;
+      uint64_t nTest  = m_split.test;
+      if ((nTrain == 0) && (nTest == 0)) {
+        nTrain = nRows / 2;
+        nTest  = nRows - nTrain;
+      } else if (nTest == 0) {
+        nTrain = std::min(nTrain, nRows);
+        nTest  = nRows - nTrain;
+      } else if (nTrain == 0) {
+        nTest  = std::min(nTest, nRows);
+        nTrain = nRows - nTest;
+      }
+      if (nTrain + nTest > nRows) {
+        std::cerr << "WARNING: asked for " << nTrain << " training & " << nTest << " testing events, but only "
+                  << nRows << " pass the cut! Using fewer testing events." << std::endl;
+        nTrain = std::min(nTrain, nRows);
+        nTest  = nRows - nTrain;
+      }
+
+      // and write them out
+      Assigner assigner(m_split, nRows, nTrain, nTest);
+      return m_caches.Write(source, cut, key, GetPaths(stem), [&]() -> std::size_t {
+        switch (assigner.Next()) {
+          case Assigner::Type::Train: return 0;
+          case Assigner::Type::Test:  return 1;
+          default:                    return 2;
+        }
+      });
+
+    }  // end 'Write(NTupleIO::Reader&, TCut&, uint64_t, std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Get paths to the training & testing caches
+    // ------------------------------------------------------------------------
+    static inline std::vector<std::string> GetPaths(const std::string& stem) {
+
+      return {stem + ".train.fcache", stem + ".test.fcache"};
+
+    }  // end 'GetPaths(std::string&)'
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Parse split out of TMVA training options
+    // ------------------------------------------------------------------------
+    static inline Split ParseSplit(const std::vector<std::string>& options) {
+
+      Split split;
+      for (const std::string& option : options) {
+        std::istringstream tokens(option);
+        std::string        token;
+        while (std::getline(tokens, token, ':')) {
+          if (token.empty()) continue;
+
+          const std::size_t equals = token.find('=');
+          const std::string key    = token.substr(0, equals);
+          const std::string value  = (equals == std::string::npos) ? "" : token.substr(equals + 1);
+          if      (key == "nTrain_Regression") split.train = std::stoull(value);
+          else if (key == "nTest_Regression")  split.test  = std::stoull(value);
+          else if (key == "SplitMode")         split.mode  = value;
+          else if (key == "SplitSeed")         split.seed  = std::stoull(value);
+          else                                 split.others.push_back(token);
+        }
+      }
+      return split;
+
+    }  // end 'ParseSplit(std::vector<std::string>&)'
+
+    // ------------------------------------------------------------------------
+    //! Getters
+    // ------------------------------------------------------------------------
+    inline const Split&                    GetSplit()     const {return m_split;}
+    inline const std::vector<std::string>& GetVariables() const {return m_caches.GetVariables();}
+    inline const FeatureCache&             GetTrain()     const {return m_caches.GetCache(0);}
+    inline const FeatureCache&             GetTest()      const {return m_caches.GetCache(1);}
+    inline NTupleHelper&                   GetHelper()          {return m_caches.GetHelper();}
+    inline NTupleIO::Reader&               GetTrainSource()     {return m_caches.GetSource(0);}
+    inline NTupleIO::Reader&               GetTestSource()      {return m_caches.GetSource(1);}
+
+    // ------------------------------------------------------------------------
+    //! Get a string identifying the split
+    // ------------------------------------------------------------------------
+    inline std::string GetSplitKey() const {
+
+      return "nTrain_Regression=" + std::to_string(m_split.train)
+        + ":nTest_Regression=" + std::to_string(m_split.test)
+        + ":SplitMode=" + m_split.mode
+        + ":SplitSeed=" + std::to_string(m_split.seed);
+
+    }  // end 'GetSplitKey()'
+
+    // ------------------------------------------------------------------------
+    //! Get training options to use with prepared trees
+    // ------------------------------------------------------------------------
+    /*! Events are already split, so TMVA is told to
+     *  take all of them in the order given, or `nTrain`
+     *  training events picked at random.
+     */
+    inline std::vector<std::string> GetTrainingOptions(const uint64_t nTrain = 0) const {
+
+      std::vector<std::string> options = m_split.others;
+      options.push_back(
+        "nTrain_Regression=" + std::to_string(nTrain) + ":nTest_Regression=0:"
+        + ((nTrain > 0) ? "SplitMode=Random:SplitSeed=" + std::to_string(m_split.seed) : std::string("SplitMode=Block"))
+      );
+      return options;
+
+    }  // end 'GetTrainingOptions(uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Open caches, (re)building them if they're stale
+    // ------------------------------------------------------------------------
+    /*! Caches go to '<stem>.train.fcache' and
+     *  '<stem>.test.fcache'. `hash` is the hash of the
+     *  input file (see FeatureCache::HashFile), and
+     *  `source` has to provide every variable of the
+     *  dataset and of the cut. Returns true if the caches
+     *  had to be (re)built.
+     */
+    inline bool Update(
+      NTupleIO::Reader& source,
+      const TCut& cut,
+      const uint64_t hash,
+      const std::string& stem
+    ) {
+
+      // key on input, split, variables, & cut
+      const std::string split = GetSplitKey();
+      const uint64_t    key   = FeatureCache::Hash(split.data(), split.size(), hash);
+
+      return m_caches.Update(GetPaths(stem), {"prepTrain", "prepTest"}, cut, key, [&]() {
+        return Write(source, cut, key, stem);
+      });
+
+    }  // end 'Update(NTupleIO::Reader&, TCut&, uint64_t, std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Get memory-resident trees of training & testing events
+    // ------------------------------------------------------------------------
+    /*! n.b. the trees point at buffers owned by the
+     *  dataset, so it has to outlive them.
+     */
+    inline TTree* GetTrainTree() {return m_caches.GetTree(0);}
+    inline TTree* GetTestTree()  {return m_caches.GetTree(1);}
+
+    // ------------------------------------------------------------------------
+    //! Add prepared trees to a data loader
+    // ------------------------------------------------------------------------
+    /*! Replaces AddRegressionTree() and
+     *  PrepareTrainingAndTestTree(); the cut has already
+     *  been applied. Set `nTrain` to train on only part
+     *  of the training events, which TMVA then picks at
+     *  random (the caches keep the order of the input).
+     */
+    inline void LoadTrees(TMVA::DataLoader* loader, const float weight, const uint64_t nTrain = 0) {
+
+      loader -> AddRegressionTree(GetTrainTree(), weight, TMVA::Types::kTraining);
+      loader -> AddRegressionTree(GetTestTree(), weight, TMVA::Types::kTesting);
+      loader -> PrepareTrainingAndTestTree("", TMVAHelper::CompressList(GetTrainingOptions(nTrain)).data());
+      return;
+
+    }  // end 'LoadTrees(TMVA::DataLoader*, float, uint64_t)'
+
+    // ------------------------------------------------------------------------
+    //! Default ctor/dtor
+    // ------------------------------------------------------------------------
+    PreparedDataset()  {};
+    ~PreparedDataset() {};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a trainer
+    // ------------------------------------------------------------------------
+    /*! Takes the variables & training options of the
+     *  trainer; spectators are only kept if they're
+     *  added to the data loader.
+     */
+    PreparedDataset(const TMVAHelper::Trainer& trainer, const bool add_spectators = false) : m_caches(trainer, 2, add_spectators) {
+
+      m_split = ParseSplit( trainer.GetTrainingOptions() );
+
+    }  // end ctor(TMVAHelper::Trainer&, bool)'
+
+};  // end PreparedDataset
+
+#endif
+
+// end ========================================================================
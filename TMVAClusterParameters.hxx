@@ -22,6 +22,7 @@
 #include <TMVA/Types.h>
 // analysis utilities
 #include "TMVAHelper.hxx"
+#include "NTupleClusterSchema.hxx"
 
 
 
@@ -32,59 +33,29 @@
  */ 
 namespace TMVAClusterParameters {
 
-  // input variables & usage
-  const std::vector<std::pair<TMVAHelper::Use, std::string>> vecUseAndVar = {
-    {TMVAHelper::Use::Target, "ePar"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBEMC"},
-    {TMVAHelper::Use::Watch, "fracLeadBHCalVsBEMC"},
-    {TMVAHelper::Use::Watch, "fracSumBHCalVsBEMC"},
-    {TMVAHelper::Use::Train, "eLeadBHCal"},
-    {TMVAHelper::Use::Train, "eLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eSumBHCal"},
-    {TMVAHelper::Use::Watch, "eSumBEMC"},
-    {TMVAHelper::Use::Watch, "diffLeadBHCal"},
-    {TMVAHelper::Use::Watch, "diffLeadBEMC"},
-    {TMVAHelper::Use::Watch, "diffSumBHCal"},
-    {TMVAHelper::Use::Watch, "diffSumBEMC"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "nClustBHCal"},
-    {TMVAHelper::Use::Watch, "nClustBEMC"},
-    {TMVAHelper::Use::Watch, "hLeadBHCal"},
-    {TMVAHelper::Use::Watch, "hLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eLeadImage"},
-    {TMVAHelper::Use::Watch, "eSumImage"},
-    {TMVAHelper::Use::Watch, "eLeadScFi"},
-    {TMVAHelper::Use::Watch, "eSumScFi"},
-    {TMVAHelper::Use::Watch, "nClustImage"},
-    {TMVAHelper::Use::Watch, "nClustScFi"},
-    {TMVAHelper::Use::Watch, "hLeadImage"},
-    {TMVAHelper::Use::Watch, "hLeadScFi"},
-    {TMVAHelper::Use::Watch, "fLeadImage"},
-    {TMVAHelper::Use::Watch, "fLeadScFi"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer1"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer2"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer3"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer4"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer5"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer6"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer7"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer8"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer9"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer10"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer11"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer12"},
-    {TMVAHelper::Use::Train, "eSumImageLayer1"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer2"},
-    {TMVAHelper::Use::Train, "eSumImageLayer3"},
-    {TMVAHelper::Use::Train, "eSumImageLayer4"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer5"},
-    {TMVAHelper::Use::Train, "eSumImageLayer6"}
+  // input variables that aren't just watched
+  //   - every other variable in the tuple schema is
+  //     treated as a TMVAHelper::Use::Watch variable
+  const std::map<NTupleClusterSchema::Var, TMVAHelper::Use> mapVarToUse = {
+    {NTupleClusterSchema::ePar,            TMVAHelper::Use::Target},
+    {NTupleClusterSchema::eLeadBHCal,      TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eLeadBEMC,       TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer1,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer2,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer3,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer4,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer5,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer6,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer7,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer8,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer9,  TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer10, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer11, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumScFiLayer12, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumImageLayer1, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumImageLayer3, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumImageLayer4, TMVAHelper::Use::Train},
+    {NTupleClusterSchema::eSumImageLayer6, TMVAHelper::Use::Train}
   };
 
   // methods to use and options
@@ -138,13 +109,30 @@ namespace TMVAClusterParameters {
 
 
 
+  // --------------------------------------------------------------------------
+  //! Pair every variable in the tuple schema with its usage
+  // --------------------------------------------------------------------------
+  inline std::vector<std::pair<TMVAHelper::Use, std::string>> GetUseAndVar() {
+
+    std::vector<std::pair<TMVAHelper::Use, std::string>> useAndVar;
+    for (std::size_t iVar = 0; iVar < NTupleClusterSchema::NVars; ++iVar) {
+      const auto var = static_cast<NTupleClusterSchema::Var>(iVar);
+      const auto use = mapVarToUse.count(var) ? mapVarToUse.at(var) : TMVAHelper::Use::Watch;
+      useAndVar.push_back( {use, NTupleClusterSchema::GetName(var)} );
+    }
+    return useAndVar;
+
+  }  // end 'GetUseAndVar()'
+
+
+
   // --------------------------------------------------------------------------
   //! Collect options into parameter struct
   // --------------------------------------------------------------------------
   TMVAHelper::Parameters GetParameters() {
 
     TMVAHelper::Parameters param {
-      .variables      = vecUseAndVar,
+      .variables      = GetUseAndVar(),
       .methods        = vecMethodAndOpt,
       .opts_factory   = vecFactoryOpts,
       .opts_training  = vecTrainOpts,
@@ -12,8 +12,12 @@
 
 // c++ utilities
 #include <map>
+#include <span>
+#include <memory>
+#include <limits>
 #include <string>
 #include <vector>
+#include <cctype>
 #include <stdio.h>
 #include <cassert>
 #include <utility>
@@ -26,10 +30,16 @@
 #include <TMVA/Tools.h>
 #include <TMVA/Types.h>
 #include <TMVA/Reader.h>
+#include <TMVA/MethodBase.h>
 #include <TMVA/Factory.h>
 #include <TMVA/DataLoader.h>
 // analysis utilities
 #include "NTupleHelper.hxx"
+#include "NTupleBlockReader.hxx"
+#include "NativeForest.hxx"
+#include "NativeModel.hxx"
+#include "NativeNetwork.hxx"
+#include "NativeNeighbors.hxx"
 
 
 
@@ -65,6 +75,7 @@ namespace TMVAHelper {
       {"FDA_GAMT", TMVA::Types::EMVA::kFDA},
       {"FDA_MC",   TMVA::Types::EMVA::kFDA},
       {"FDA_MT",   TMVA::Types::EMVA::kFDA},
+      {"HistBDTG", TMVA::Types::EMVA::kBDT},
       {"KNN",      TMVA::Types::EMVA::kKNN},
       {"LD",       TMVA::Types::EMVA::kLD},
       {"MLP",      TMVA::Types::EMVA::kMLP},
@@ -76,6 +87,18 @@ namespace TMVAHelper {
 
   }  // end 'MapNameToType()'
 
+  // ------------------------------------------------------------------------
+  //! Check if a method is trained natively rather than by TMVA
+  // ------------------------------------------------------------------------
+  /*! HistBDTG is trained by HistBoost.hxx but writes
+   *  a BDT weight file, so it's read like any other.
+   */
+  inline bool IsNative(const std::string& method) {
+
+    return method == "HistBDTG";
+
+  }  // end 'IsNative(std::string&)'
+
 
 
   // --------------------------------------------------------------------------
@@ -112,6 +135,74 @@ namespace TMVAHelper {
 
 
 
+  // --------------------------------------------------------------------------
+  //! Helper method to set an option in a colon-separated list
+  // --------------------------------------------------------------------------
+  /*! Replaces every "<key>=..." entry (e.g. the doubled
+   *  MaxDepth of the BDTG options) with a single
+   *  "<key>=<value>", or appends it if the key isn't
+   *  there yet.
+   */
+  inline std::string SetOption(
+    const std::string& options,
+    const std::string& key,
+    const std::string& value
+  ) {
+
+    std::vector<std::string> entries;
+    bool                     isSet = false;
+    std::size_t              start = 0;
+    while (start <= options.size()) {
+      const std::size_t stop  = std::min(options.find(':', start), options.size());
+      const std::string entry = options.substr(start, stop - start);
+      start = stop + 1;
+      if (entry.empty()) continue;
+
+      if (entry.substr(0, entry.find('=')) == key) {
+        if (!isSet) entries.push_back(key + "=" + value);
+        isSet = true;
+      } else {
+        entries.push_back(entry);
+      }
+    }
+    if (!isSet) entries.push_back(key + "=" + value);
+    return CompressList(entries);
+
+  }  // end 'SetOption(std::string&, std::string&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to get an option from a colon-separated list
+  // --------------------------------------------------------------------------
+  /*! Returns the value of the last "<key>=..." entry
+   *  (the one TMVA would use), or `fallback` if there's
+   *  none.
+   */
+  inline std::string GetOption(
+    const std::string& options,
+    const std::string& key,
+    const std::string& fallback = ""
+  ) {
+
+    std::string value = fallback;
+    std::size_t start = 0;
+    while (start <= options.size()) {
+      const std::size_t stop  = std::min(options.find(':', start), options.size());
+      const std::string entry = options.substr(start, stop - start);
+      start = stop + 1;
+
+      const std::size_t equals = entry.find('=');
+      if ((equals != std::string::npos) && (entry.substr(0, equals) == key)) {
+        value = entry.substr(equals + 1);
+      }
+    }
+    return value;
+
+  }  // end 'GetOption(std::string&, std::string&, std::string&)'
+
+
+
   // ==========================================================================
   //! TMVA Parameters
   // ==========================================================================
@@ -139,6 +230,75 @@ namespace TMVAHelper {
 
 
 
+  // --------------------------------------------------------------------------
+  //! Helper method to list the identifiers in a cut
+  // --------------------------------------------------------------------------
+  /*! Returns every word in the cut that could name a
+   *  branch or variable (i.e. starts with a letter or
+   *  an underscore), including function names like
+   *  'abs'. Those don't match any variable, so they're
+   *  harmless when the list is used to pick branches.
+   */
+  inline std::vector<std::string> GetCutIdentifiers(const TCut& cut) {
+
+    const std::string expression = cut.GetTitle();
+
+    std::vector<std::string> identifiers;
+    std::size_t iChar = 0;
+    while (iChar < expression.size()) {
+
+      // skip anything that can't start an identifier
+      if (!std::isalpha(expression[iChar]) && (expression[iChar] != '_')) {
+        ++iChar;
+        continue;
+      }
+
+      // otherwise grab full identifier
+      std::size_t iEnd = iChar;
+      while ((iEnd < expression.size()) && (std::isalnum(expression[iEnd]) || (expression[iEnd] == '_'))) {
+        ++iEnd;
+      }
+
+      const std::string word = expression.substr(iChar, iEnd - iChar);
+      if (std::find(identifiers.begin(), identifiers.end(), word) == identifiers.end()) {
+        identifiers.push_back(word);
+      }
+      iChar = iEnd;
+    }
+    return identifiers;
+
+  }  // end 'GetCutIdentifiers(TCut&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to list the variables needed when applying models
+  // --------------------------------------------------------------------------
+  /*! i.e. the training variables (read by TMVA::Reader),
+   *  the targets (copied into the output), and anything
+   *  used in the reading cuts. Watch variables aren't
+   *  needed at application time.
+   */
+  inline std::vector<std::string> GetVariablesToRead(const Parameters& param) {
+
+    std::vector<std::string> variables;
+    for (const auto& [use, variable] : param.variables) {
+      if ((use == Use::Train) || (use == Use::Target)) {
+        variables.push_back(variable);
+      }
+    }
+
+    for (const std::string& identifier : GetCutIdentifiers(param.reading_cuts)) {
+      if (std::find(variables.begin(), variables.end(), identifier) == variables.end()) {
+        variables.push_back(identifier);
+      }
+    }
+    return variables;
+
+  }  // end 'GetVariablesToRead(Parameters&)'
+
+
+
   // ==========================================================================
   //! Base Helper
   // ==========================================================================
@@ -205,6 +365,23 @@ namespace TMVAHelper {
       inline std::vector<std::string> GetTrainers()   const {return m_trainers;}
       inline std::vector<std::string> GetTargets()    const {return m_targets;}
 
+      // ----------------------------------------------------------------------
+      //! Get/set options of a method
+      // ----------------------------------------------------------------------
+      inline std::string GetMethodOptions(const std::string& method) const {return m_opts_method.count(method) ? m_opts_method.at(method) : "";}
+      inline void        SetMethodOptions(const std::string& method, const std::string& options) {m_opts_method[method] = options;}
+
+      // ----------------------------------------------------------------------
+      //! Stop using a method
+      // ----------------------------------------------------------------------
+      inline void RemoveMethod(const std::string& method) {
+
+        m_methods.erase(std::remove(m_methods.begin(), m_methods.end(), method), m_methods.end());
+        m_opts_method.erase(method);
+        return;
+
+      }  // end 'RemoveMethod(std::string&)'
+
       // ----------------------------------------------------------------------
       //! Default ctor/dtor
       // ----------------------------------------------------------------------
@@ -226,6 +403,7 @@ namespace TMVAHelper {
     private:
 
       // data members
+      bool                     m_incremental = false;
       std::vector<std::string> m_opts_factory;
       std::vector<std::string> m_opts_train;
 
@@ -240,15 +418,41 @@ namespace TMVAHelper {
       // ----------------------------------------------------------------------
       //! Getters
       // ----------------------------------------------------------------------
+      inline bool                     GetIncremental()     const {return m_incremental;}
       inline std::vector<std::string> GetFactoryOptions()  const {return m_opts_factory;}
       inline std::vector<std::string> GetTrainingOptions() const {return m_opts_train;}
 
       // ----------------------------------------------------------------------
       //! Setters
       // ----------------------------------------------------------------------
+      inline void SetIncremental(const bool incremental)                     {m_incremental  = incremental;}
       inline void SetTrainOptions(const std::vector<std::string>& options)   {m_opts_train   = options;}
       inline void SetFactoryOptions(const std::vector<std::string>& options) {m_opts_factory = options;}
 
+      // ----------------------------------------------------------------------
+      //! Check if a method continues from its earlier weights
+      // ----------------------------------------------------------------------
+      /*! In incremental mode, gradient-boosted forests,
+       *  MLPs, & LDs are trained on top of what they
+       *  already learned (see WarmStart.hxx) rather than
+       *  from scratch.
+       */
+      inline bool IsIncremental(const std::string& method) const {
+
+        if (!m_incremental || IsNative(method)) return false;
+        switch (MapNameToType()[method]) {
+          case TMVA::Types::kBDT:
+            return GetOption(GetMethodOptions(method), "BoostType", "AdaBoost") == "Grad";
+          case TMVA::Types::kMLP:
+            [[fallthrough]];
+          case TMVA::Types::kLD:
+            return true;
+          default:
+            return false;
+        }
+
+      }  // end 'IsIncremental(std::string&)'
+
       // ----------------------------------------------------------------------
       //! Add variables to data loader
       // ----------------------------------------------------------------------
@@ -274,19 +478,37 @@ namespace TMVAHelper {
 
       }  // end 'LoadVariables(TMVA::DataLoader*, bool)'
 
+      // ------------------------------------------------------------------------
+      //! Book a single method to train
+      // ------------------------------------------------------------------------
+      /*! Returns the booked method, or nullptr if the
+       *  method isn't trained by TMVA.
+       */
+      inline TMVA::MethodBase* BookMethodToTrain(TMVA::Factory* factory, TMVA::DataLoader* loader, const std::string& method) {
+
+        if (IsNative(method)) {
+          std::cerr << "WARNING: method '" << method << "' is trained natively, not booking it!" << std::endl;
+          return nullptr;
+        }
+        return factory -> BookMethod(
+          loader,
+          MapNameToType()[method],
+          method.data(),
+          m_opts_method[method].data()
+        );
+
+      }  // end 'BookMethodToTrain(TMVA::Factory*, TMVA::DataLoader*, std::string&)'
+
       // ------------------------------------------------------------------------
       //! Book methods to train
       // ------------------------------------------------------------------------
       inline void BookMethodsToTrain(TMVA::Factory* factory, TMVA::DataLoader* loader) {
 
-        // book each method currently set
+        // book each method currently set (natives are
+        // trained separately)
         for (const std::string& method : m_methods) {
-          factory -> BookMethod(
-            loader,
-            MapNameToType()[method],
-            method.data(),
-            m_opts_method[method].data()
-          );
+          if (IsNative(method)) continue;
+          BookMethodToTrain(factory, loader, method);
         }
         return;
 
@@ -332,6 +554,98 @@ namespace TMVAHelper {
       std::vector<std::string>           m_options;
       std::map<std::string, std::size_t> m_outdex;
 
+      // handles resolved at booking, used per event
+      std::vector<TMVA::MethodBase*> m_handles;
+      std::vector<std::size_t>       m_method_slots;
+      std::vector<std::size_t>       m_target_slots;
+      std::vector<std::size_t>       m_target_index;
+      std::vector<std::size_t>       m_trainer_index;
+
+      // per-output columns for block evaluation
+      std::vector<float> m_block_values;
+      std::size_t        m_block_capacity = 0;
+      std::size_t        m_block_size     = 0;
+
+      // native evaluators, used in place of tmva where possible
+      //   - n.b. models are shared by every reader that
+      //     books the same weight file (e.g. copies made
+      //     for other threads), but each keeps its own
+      //     evaluation context
+      bool                                                  m_use_native = false;
+      bool                                                  m_use_cache  = false;
+      std::vector<std::shared_ptr<const NativeModel::Base>> m_native;
+      NativeModel::Context                                  m_context;
+      std::vector<const float*>                             m_native_inputs;
+      std::vector<const float*>                             m_block_inputs;
+      std::vector<float*>                                   m_native_outputs;
+
+      // ----------------------------------------------------------------------
+      //! Try to load a native evaluator for a method
+      // ----------------------------------------------------------------------
+      /*! Returns false if there's no native evaluator for
+       *  the method type, or if the weight file uses
+       *  something it doesn't support. If caching, the
+       *  parsed model is loaded from (or saved to) a binary
+       *  file next to its weights instead of parsing the
+       *  xml every time. A model already loaded from the
+       *  same file (by any reader) is reused as is; the
+       *  file is only hashed (to check the binary file)
+       *  when it has to be loaded.
+       */
+      inline bool LoadNative(const std::size_t iMethod, const std::string& path) {
+
+        const std::string key = NativeModel::GetFileKey(path);
+        if (key.empty()) return false;
+
+        std::shared_ptr<const NativeModel::Base> model = NativeModel::Share(key);
+        if (!model) {
+          const std::string type = NativeModel::GetMethodType(path);
+
+          std::shared_ptr<NativeModel::Base> loaded;
+          if (type == "BDT") {
+            loaded = std::make_shared<NativeModel::Forest>();
+          } else if (type == "MLP") {
+            loaded = std::make_shared<NativeModel::Network>();
+          } else if (type == "KNN") {
+            loaded = std::make_shared<NativeModel::NearestNeighbors>();
+          }
+          if (!loaded || !loaded -> Load(path, m_use_cache)) return false;
+          model = NativeModel::Share(key, loaded);
+        }
+
+        // make sure inputs & outputs line up
+        if ((model -> GetVariables() != m_trainers) || (m_trainer_index.size() != m_trainers.size())) {
+          std::cerr << "WARNING: variables of '" << path << "' don't match the reader's! Using TMVA instead." << std::endl;
+          return false;
+        }
+        if (model -> GetTargets().size() != m_targets.size()) {
+          std::cerr << "WARNING: targets of '" << path << "' don't match the reader's! Using TMVA instead." << std::endl;
+          return false;
+        }
+
+        m_native.at(iMethod) = model;
+        return true;
+
+      }  // end 'LoadNative(std::size_t, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Book a method & keep its handle
+      // ----------------------------------------------------------------------
+      inline void BookMethod(TMVA::Reader* reader, const std::size_t iMethod, const std::string& path) {
+
+        // use native evaluator if requested & possible
+        if (m_use_native && LoadNative(iMethod, path)) return;
+
+        const std::string title = m_methods[iMethod] + " method";
+        m_handles.at(iMethod) = dynamic_cast<TMVA::MethodBase*>( reader -> BookMVA(title, path) );
+        if (!m_handles[iMethod]) {
+          std::cerr << "WARNING: couldn't get handle to method '" << m_methods[iMethod] << "'! Not evaluating it!" << std::endl;
+          m_read.at(iMethod) = false;
+        }
+        return;
+
+      }  // end 'BookMethod(TMVA::Reader*, std::size_t, std::string&)'
+
       // ----------------------------------------------------------------------
       //! Generate list of regression outputs
       // ----------------------------------------------------------------------
@@ -346,11 +660,15 @@ namespace TMVAHelper {
         for (const std::string& target : m_targets) {
           m_outvars.push_back( target );
           m_outdex[ m_outvars.back() ] = iOut;
+          m_target_slots.push_back( iOut );
           ++iOut;
         }
 
         // then generate list of regression outputs
+        //   - n.b. each method's outputs are contiguous,
+        //     so only the first slot needs to be kept
         for (const std::string& method : m_methods) {
+          m_method_slots.push_back( iOut );
           for (const std::string& target : m_targets) {
             m_outvars.push_back( target + "_" + method );
             m_outdex[ m_outvars.back() ] = iOut;
@@ -375,12 +693,93 @@ namespace TMVAHelper {
       //! Setters
       // ------------------------------------------------------------------------
       inline void SetOptions(const std::vector<std::string>& options) {m_options = options;}
+      inline void SetUseNative(const bool use)                        {m_use_native = use;}
+      inline void SetUseCache(const bool use)                         {m_use_cache = use;}
 
       // ----------------------------------------------------------------------
       //! Getters
       // ----------------------------------------------------------------------
-      inline std::vector<std::string> GetOptions() const {return m_options;}
-      inline std::vector<std::string> GetOutputs() const {return m_outvars;}
+      inline std::vector<std::string>        GetOptions() const {return m_options;}
+      inline const std::vector<std::string>& GetOutputs() const {return m_outvars;}
+      inline const std::vector<float>&       GetValues()  const {return m_outvals;}
+      inline bool                            GetUseNative() const {return m_use_native;}
+      inline bool                            GetUseCache()  const {return m_use_cache;}
+
+      // ----------------------------------------------------------------------
+      //! Only evaluate the methods needed for a set of outputs
+      // ----------------------------------------------------------------------
+      /*! Outputs are named as in `GetOutputs()`, e.g.
+       *  "ePar_BDTG". Methods none of the requested outputs
+       *  need are dropped: their weight files are never
+       *  loaded, they're never evaluated, and their
+       *  columns are left out of `GetOutputs()`. Targets,
+       *  and every target of a kept method, are always
+       *  kept. Must be called before booking; an empty
+       *  list keeps every method. Stops with a PANIC if an
+       *  output isn't known, or if no method is left.
+       */
+      inline void SelectOutputs(const std::vector<std::string>& outputs) {
+
+        if (outputs.empty()) return;
+
+        // check for outputs that don't exist
+        for (const std::string& output : outputs) {
+          const bool isKnown = m_outdex.count(output);
+          if (!isKnown) {
+            std::cerr << "PANIC: requested output '" << output << "' isn't produced by any method!" << std::endl;
+            assert(isKnown);
+          }
+        }
+
+        // keep only methods with a requested output
+        std::vector<std::string> methods;
+        for (const std::string& method : m_methods) {
+          bool isNeeded = false;
+          for (const std::string& target : m_targets) {
+            isNeeded |= (std::find(outputs.begin(), outputs.end(), target + "_" + method) != outputs.end());
+          }
+          if (isNeeded) methods.push_back(method);
+        }
+
+        const bool isAnyLeft = !methods.empty();
+        if (!isAnyLeft) {
+          std::cerr << "PANIC: none of the requested outputs is produced by a method!" << std::endl;
+          assert(isAnyLeft);
+        }
+        m_methods = methods;
+
+        // and regenerate outputs
+        m_outvars.clear();
+        m_outdex.clear();
+        m_method_slots.clear();
+        m_target_slots.clear();
+        m_block_capacity = 0;
+        GenerateRegressionOutputs();
+        return;
+
+      }  // end 'SelectOutputs(std::vector<std::string>&)'
+
+      // ----------------------------------------------------------------------
+      //! Get native evaluator of a method (null if evaluated by TMVA)
+      // ----------------------------------------------------------------------
+      inline std::shared_ptr<const NativeModel::Base> GetNative(const std::size_t iMethod) const {
+
+        return (iMethod < m_native.size()) ? m_native[iMethod] : nullptr;
+
+      }  // end 'GetNative(std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Get values of an output over the last evaluated block
+      // ----------------------------------------------------------------------
+      /*! Indices follow the order of `GetOutputs()`. Each
+       *  method's outputs sit in adjacent columns.
+       */
+      inline std::span<const float> GetColumn(const std::size_t index) const {
+
+        assert(index < m_outvals.size());
+        return std::span<const float>(m_block_values.data() + (index * m_block_capacity), m_block_size);
+
+      }  // end 'GetColumn(std::size_t)'
 
       // ----------------------------------------------------------------------
       //! Get a specific output variable
@@ -397,6 +796,19 @@ namespace TMVAHelper {
 
       }  // end 'GetVariable(std::string&)'
 
+      // ----------------------------------------------------------------------
+      //! Get a specific output variable by index
+      // ----------------------------------------------------------------------
+      /*! Indices follow the order of `GetOutputs()`, so an
+       *  NTupleHelper built from that list shares them.
+       */
+      inline float GetVariable(const std::size_t index) const {
+
+        assert(index < m_outvals.size());
+        return m_outvals[index];
+
+      }  // end 'GetVariable(std::size_t)'
+
       // ----------------------------------------------------------------------
       //! Reset output values
       // ----------------------------------------------------------------------
@@ -414,16 +826,37 @@ namespace TMVAHelper {
       // ----------------------------------------------------------------------
       //! Add NTuple variables to reader
       // ----------------------------------------------------------------------
-      inline void ReadVariables(TMVA::Reader* reader, NTupleHelper& helper) const {
+      /*! Also looks up where the targets sit in the helper,
+       *  so they can be copied into the output by index.
+       */
+      inline void ReadVariables(TMVA::Reader* reader, NTupleHelper& helper) {
 
+        m_trainer_index.clear();
         for (const std::string& train : m_trainers) {
           if (!helper.m_index.count(train)) {
             std::cerr << "WARNING: trying to add variable '" << train << "' which is not in input NTuple!" << std::endl;
             continue;
           } else {
             reader -> AddVariable(train.data(), &helper.m_values.at(helper.m_index[train]));
+            m_trainer_index.push_back( helper.m_index[train] );
           }
         }
+
+        // native evaluators read straight from the helper
+        m_native_inputs.clear();
+        for (const std::size_t index : m_trainer_index) {
+          m_native_inputs.push_back( &helper.m_values[index] );
+        }
+        m_block_inputs.resize( m_trainer_index.size() );
+        m_native_outputs.resize( m_targets.size() );
+
+        m_target_index.clear();
+        for (const std::string& target : m_targets) {
+          if (!helper.m_index.count(target)) {
+            std::cerr << "WARNING: target '" << target << "' is not in input NTuple! It won't be copied to the output!" << std::endl;
+          }
+          m_target_index.push_back( helper.m_index.count(target) ? helper.m_index[target] : helper.m_values.size() );
+        }
         return;
 
       }  // end 'ReadVariables(TMVA::Reader*, NTupleHelper&)'
@@ -443,7 +876,11 @@ namespace TMVAHelper {
       ) {
 
         // reserve space for each method
-        m_read.resize( m_methods.size(), true );
+        //   - n.b. a copy of a booked helper can be
+        //     booked again on another reader
+        m_read.assign( m_methods.size(), true );
+        m_handles.assign( m_methods.size(), nullptr );
+        m_native.assign( m_methods.size(), nullptr );
 
         // loop over all methods
         for (std::size_t iMethod = 0; iMethod < m_methods.size(); ++iMethod) {
@@ -458,9 +895,8 @@ namespace TMVAHelper {
             continue;
           }
 
-          // otherwise, construct title and book method
-          const std::string title = m_methods[iMethod] + " method";
-          reader -> BookMVA(title, path);
+          // otherwise, book method
+          BookMethod(reader, iMethod, path);
 
         }  // end method loop
         return;
@@ -481,7 +917,11 @@ namespace TMVAHelper {
       ) {
 
         // reserve space for each method
-        m_read.resize( m_methods.size(), true );
+        //   - n.b. a copy of a booked helper can be
+        //     booked again on another reader
+        m_read.assign( m_methods.size(), true );
+        m_handles.assign( m_methods.size(), nullptr );
+        m_native.assign( m_methods.size(), nullptr );
 
         // make sure input list has same dimension as method list
         if (files.size() != m_methods.size()) {
@@ -498,9 +938,8 @@ namespace TMVAHelper {
             continue;
           }
 
-          // otherwise, construct title and book method
-          const std::string title = m_methods.at(iFile) + " method";
-          reader -> BookMVA(title, files[iFile]);
+          // otherwise, book method
+          BookMethod(reader, iFile, files[iFile]);
 
         }  // end file loop
         return;
@@ -510,9 +949,14 @@ namespace TMVAHelper {
       // ----------------------------------------------------------------------
       //! Evaluate all booked methods
       // ----------------------------------------------------------------------
+      /*! Method handles and output slots are resolved when
+       *  booking/adding variables, so this only indexes into
+       *  flat arrays and never allocates.
+       */
       inline void EvaluateMethods(TMVA::Reader* reader, NTupleHelper& helper) {
 
         // loop over all methods
+        const std::size_t nTargets = m_targets.size();
         for (std::size_t iMethod = 0; iMethod < m_methods.size(); ++iMethod) {
 
           // if not evaluating method, continue
@@ -520,25 +964,123 @@ namespace TMVAHelper {
             continue;
           }
 
-          // construct title & run evaluation
-          const std::string        title   = m_methods[iMethod] + " method";
-          const std::vector<float> targets = reader -> EvaluateRegression(title);
+          // evaluate natively if possible
+          if (m_native[iMethod]) {
+            for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+              m_native_outputs[iTarget] = &m_outvals[m_method_slots[iMethod] + iTarget];
+            }
+            m_native[iMethod] -> Evaluate(m_native_inputs, 1, m_native_outputs, m_context);
+            continue;
+          }
 
-          // collect regression output
-          for (std::size_t iTarget = 0; iTarget < m_targets.size(); ++iTarget) {
-            const std::string output = m_targets[iTarget] + "_" + m_methods[iMethod];
-            m_outvals.at(m_outdex[output]) = targets.at(iTarget);
+          // otherwise run tmva evaluation & collect regression output
+          const std::vector<float>& targets = reader -> EvaluateRegression( m_handles[iMethod] );
+          for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+            m_outvals[m_method_slots[iMethod] + iTarget] = targets[iTarget];
           }
         }  // end method loop
 
         // then collect training targets in output
-        for (const std::string& target : m_targets) {
-          m_outvals.at(m_outdex[target]) = helper.GetVariable( target );
+        for (std::size_t iTarget = 0; iTarget < m_target_index.size(); ++iTarget) {
+          if (m_target_index[iTarget] >= helper.m_values.size()) continue;
+          m_outvals[m_target_slots[iTarget]] = helper.m_values[m_target_index[iTarget]];
         }
         return;
 
       }  // end 'EvaluateMethods(TMVA::Reader*, NTupleHelper&)'
 
+      // ----------------------------------------------------------------------
+      //! Evaluate all booked methods over a block of entries
+      // ----------------------------------------------------------------------
+      /*! Runs each method over every row of the block before
+       *  moving on to the next one, so only one model is hot
+       *  at a time. Results land in per-output columns (see
+       *  `GetColumn`). The block must come from a reader on
+       *  `helper`, whose training variables are overwritten
+       *  row by row. If `onlyPassing` is set, rows failing
+       *  the block's selection are skipped and their outputs
+       *  are left reset.
+       */
+      inline void EvaluateMethods(
+        TMVA::Reader* reader,
+        NTupleHelper& helper,
+        const NTupleBlockReader& block,
+        const bool onlyPassing = false
+      ) {
+
+        // make sure there's room for the block
+        const std::size_t nTargets = m_targets.size();
+        if (block.GetCapacity() != m_block_capacity) {
+          m_block_capacity = block.GetCapacity();
+          m_block_values.resize(m_outvals.size() * m_block_capacity);
+        }
+        m_block_size = block.GetSize();
+        std::fill(
+          m_block_values.begin(),
+          m_block_values.end(),
+          -1. * std::numeric_limits<float>::max()
+        );
+
+        // grab columns of training variables
+        for (std::size_t iTrain = 0; iTrain < m_trainer_index.size(); ++iTrain) {
+          m_block_inputs[iTrain] = block.GetColumn(m_trainer_index[iTrain]).data();
+        }
+        std::span<const uint8_t> mask = block.GetMask();
+
+        // loop over methods, then rows
+        for (std::size_t iMethod = 0; iMethod < m_methods.size(); ++iMethod) {
+
+          if (!m_read[iMethod]) continue;
+
+          TMVA::MethodBase* handle = m_handles[iMethod];
+          float*            output = m_block_values.data() + (m_method_slots[iMethod] * m_block_capacity);
+
+          // native evaluators take the whole block at once
+          if (m_native[iMethod]) {
+            for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+              m_native_outputs[iTarget] = output + (iTarget * m_block_capacity);
+            }
+            m_native[iMethod] -> Evaluate(m_block_inputs, m_block_size, m_native_outputs, m_context);
+
+            // keep failing rows reset
+            for (std::size_t iRow = 0; onlyPassing && (iRow < m_block_size); ++iRow) {
+              if (mask[iRow]) continue;
+              for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+                output[(iTarget * m_block_capacity) + iRow] = -1. * std::numeric_limits<float>::max();
+              }
+            }
+            continue;
+          }
+          for (std::size_t iRow = 0; iRow < m_block_size; ++iRow) {
+
+            if (onlyPassing && !mask[iRow]) continue;
+
+            // point tmva at this row & evaluate
+            for (std::size_t iTrain = 0; iTrain < m_block_inputs.size(); ++iTrain) {
+              helper.m_values[m_trainer_index[iTrain]] = m_block_inputs[iTrain][iRow];
+            }
+            const std::vector<float>& targets = reader -> EvaluateRegression(handle);
+            for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+              output[(iTarget * m_block_capacity) + iRow] = targets[iTarget];
+            }
+          }  // end row loop
+        }  // end method loop
+
+        // then copy training targets
+        for (std::size_t iTarget = 0; iTarget < m_target_index.size(); ++iTarget) {
+          if (m_target_index[iTarget] >= helper.m_values.size()) continue;
+
+          std::span<const float> column = block.GetColumn(m_target_index[iTarget]);
+          std::copy(
+            column.begin(),
+            column.end(),
+            m_block_values.begin() + (m_target_slots[iTarget] * m_block_capacity)
+          );
+        }
+        return;
+
+      }  // end 'EvaluateMethods(TMVA::Reader*, NTupleHelper&, NTupleBlockReader&, bool)'
+
       // ----------------------------------------------------------------------
       //! Default ctor/dtor
       // ----------------------------------------------------------------------
@@ -0,0 +1,87 @@
+/// ===========================================================================
+/*! \file   TestChecks.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A small class to tally the checks made by the
+ *  self-checking test macros.
+ */
+/// ===========================================================================
+
+#ifndef TestChecks_hxx
+#define TestChecks_hxx
+
+// c++ utilities
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+
+
+// ============================================================================
+//! Test Checks
+// ============================================================================
+/*! Prints whether each check passed and counts the
+ *  ones that didn't. The test macros return that
+ *  count, so whoever runs them decides what a
+ *  failure means.
+ */
+class TestChecks {
+
+  private:
+
+    // data members
+    std::string m_name;
+    std::size_t m_checks = 0;
+    std::size_t m_failed = 0;
+
+  public:
+
+    // ------------------------------------------------------------------------
+    //! Getters
+    // ------------------------------------------------------------------------
+    inline std::size_t GetNChecks() const {return m_checks;}
+    inline std::size_t GetNFailed() const {return m_failed;}
+
+    // ------------------------------------------------------------------------
+    //! Record a check
+    // ------------------------------------------------------------------------
+    inline void Check(const bool isGood, const std::string& what) {
+
+      std::cout << "    " << (isGood ? "PASSED" : "FAILED") << ": " << what << std::endl;
+      ++m_checks;
+      if (!isGood) ++m_failed;
+      return;
+
+    }  // end 'Check(bool, std::string&)'
+
+    // ------------------------------------------------------------------------
+    //! Print a summary & return the no. of failed checks
+    // ------------------------------------------------------------------------
+    inline std::size_t Report() const {
+
+      if (m_failed > 0) {
+        std::cerr << "WARNING: " << m_failed << " of " << m_checks << " " << m_name << " checks failed!" << std::endl;
+      } else {
+        std::cout << "    All " << m_checks << " " << m_name << " checks passed." << std::endl;
+      }
+      return m_failed;
+
+    }  // end 'Report()'
+
+    // ------------------------------------------------------------------------
+    //! Default ctor/dtor
+    // ------------------------------------------------------------------------
+    TestChecks()  {};
+    ~TestChecks() {};
+
+    // ------------------------------------------------------------------------
+    //! ctor accepting a name for the set of checks
+    // ------------------------------------------------------------------------
+    TestChecks(const std::string& name) : m_name(name) {};
+
+};  // end TestChecks
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,118 @@
+/// ===========================================================================
+/*! \file   TestEvents.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A small namespace to make the random events used
+ *  by the self-checking test macros.
+ */
+/// ===========================================================================
+
+#ifndef TestEvents_hxx
+#define TestEvents_hxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cstdint>
+// root libraries
+#include <TRandom3.h>
+// analysis utilities
+#include "FeatureCache.hxx"
+
+
+
+// ============================================================================
+//! Test Events
+// ============================================================================
+/*! Events are rows of a target followed by three
+ *  variables (see `Columns`), drawn with a fixed
+ *  seed so a test sees the same events every run.
+ */
+namespace TestEvents {
+
+  // --------------------------------------------------------------------------
+  //! Names of the columns: the target, then the variables
+  // --------------------------------------------------------------------------
+  inline const std::vector<std::string> Columns = {"y", "x0", "x1", "x2"};
+
+  // --------------------------------------------------------------------------
+  //! Available targets
+  // --------------------------------------------------------------------------
+  /*! - Nonlinear: y = 10 + 3 x0 + x1^2 - 2 x0 x2 + noise,
+   *               with x0, x1, x2 uniform in [0, 2),
+   *               [-1, 1), & [0, 1)
+   *  - Linear:    y = 5 + 2 x0 - x1 + 0.5 x2 + noise,
+   *               with x0, x1 uniform in [0, 2) &
+   *               [-1, 1), & x2 a unit gaussian
+   */
+  enum class Model {Nonlinear, Linear};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get random events
+  // --------------------------------------------------------------------------
+  /*! `shift` moves the range of x0, so samples made
+   *  with different shifts cover different inputs.
+   */
+  inline std::vector<std::vector<float>> Make(
+    const std::size_t nRows,
+    const uint64_t seed,
+    const Model model = Model::Nonlinear,
+    const double shift = 0.
+  ) {
+
+    TRandom3                        random(seed);
+    std::vector<std::vector<float>> rows(nRows, std::vector<float>(Columns.size()));
+    for (std::vector<float>& row : rows) {
+      switch (model) {
+        case Model::Linear:
+          row[1] = random.Uniform(0., 2.) + shift;
+          row[2] = random.Uniform(-1., 1.);
+          row[3] = random.Gaus(0., 1.);
+          row[0] = 5. + (2. * row[1]) - row[2] + (0.5 * row[3]) + random.Gaus(0., 0.2);
+          break;
+        case Model::Nonlinear:
+          [[fallthrough]];
+        default:
+          row[1] = random.Uniform(0., 2.) + shift;
+          row[2] = random.Uniform(-1., 1.);
+          row[3] = random.Uniform(0., 1.);
+          row[0] = 10. + (3. * row[1]) + (row[2] * row[2]) - (2. * row[1] * row[3]) + random.Gaus(0., 0.1);
+          break;
+      }
+    }
+    return rows;
+
+  }  // end 'Make(std::size_t, uint64_t, Model, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write random events to a feature cache
+  // --------------------------------------------------------------------------
+  /*! The seed doubles as the cache's source hash.
+   *  Returns false if the cache couldn't be written.
+   */
+  inline bool Write(
+    const std::string& path,
+    const std::size_t nRows,
+    const uint64_t seed,
+    const Model model = Model::Nonlinear,
+    const double shift = 0.
+  ) {
+
+    FeatureCache::Builder builder(path, Columns, seed, "");
+    for (const std::vector<float>& row : Make(nRows, seed, model, shift)) {
+      if (!builder.Append(row)) return false;
+    }
+    return builder.Close();
+
+  }  // end 'Write(std::string&, std::size_t, uint64_t, Model, double)'
+
+}  // end TestEvents namespace
+
+#endif
+
+// end ========================================================================
@@ -5,7 +5,7 @@
  *
  *  A ROOT macro to train and apply a TMVA model to
  *  calibrate the energy of clusters in the BHCal
- *  and BIC. Ingests the TNtuple produced by
+ *  and BIC. Ingests the tuple produced by
  *  'FillBHCalClusterCalibrationTuple.cxx'
  */
 /// ===========================================================================
@@ -13,10 +13,12 @@
 #define TrainAndApplyBHCalClusterCalibration_cxx
 
 // c++ utilities
+#include <span>
 #include <string>
 #include <vector>
 #include <cassert>
 #include <utility>
+#include <memory>
 #include <iostream>
 // root libraries
 #include <TCut.h>
@@ -31,8 +33,17 @@
 #include <TMVA/DataLoader.h>
 // analysis utilities
 #include "TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
 #include "../../utility/TMVAHelper.hxx"
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/ParallelApply.hxx"
+#include "../../utility/ParallelTrain.hxx"
+#include "../../utility/PreparedDataset.hxx"
+#include "../../utility/HistBoost.hxx"
+#include "../../utility/WarmStart.hxx"
+#include "../../utility/CheckpointTrain.hxx"
 
 
 
@@ -40,20 +51,56 @@
 //! Struct to consolidate user options
 // ============================================================================
 struct Options {
-  std::string in_file;      // input file
-  std::string in_tuple;     // input ntuple
-  std::string out_file;     // output file
-  std::string out_tmva;     // output tmva directory
-  std::string name_tmva;    // name of TMVA process
-  bool        do_progress;  // print progress through entry loop
-  bool        do_read_cut;  // apply cuts while reading ntuple
+  std::string in_file;                  // input file
+  std::string in_tuple;                 // input ntuple
+  std::string out_file;                 // output file
+  std::string out_tmva;                 // output tmva directory
+  std::string name_tmva;                // name of TMVA process
+  std::string in_backend;               // input tuple backend ("tree" or "rntuple")
+  std::size_t block_size;               // number of entries to read at a time when applying
+  std::size_t n_threads;                // number of threads to apply models with (1 = serial)
+  std::size_t n_train_jobs;             // number of methods to train at once in separate processes (1 = all in one factory)
+  std::string cache_dir;                // directory for feature caches (leave empty to read tuple directly)
+  std::string prep_dir;                 // directory for prepared train/test datasets (leave empty to let TMVA split)
+  std::string ckpt_dir;                 // directory for MLP checkpoints (leave empty to train without checkpoints)
+  std::size_t ckpt_interval;            // number of MLP training cycles between checkpoints
+  std::size_t ckpt_keep;                // max number of checkpoints to keep per method (0 = all)
+  std::size_t warm_trees;               // number of trees to add to a continued BDTG
+  std::size_t warm_cycles;              // number of cycles to train a continued MLP for
+  std::string out_policy;               // output writer preset ("default", "fastwrite", "smallfile", "fastread")
+  std::vector<std::string> out_select;  // outputs to evaluate, e.g. {"ePar_BDTG"} (empty = all)
+  bool        do_project;               // only read variables needed when applying models
+  bool        do_reduce;                // store regression outputs with reduced precision
+  bool        do_native;                // evaluate supported methods (BDTG, MLP, KNN) without TMVA::Reader
+  bool        do_cache;                 // cache native models in binary files next to their weights
+  bool        do_progress;              // print progress through entry loop
+  bool        do_read_cut;              // apply cuts while reading ntuple
+  bool        do_warm;                  // continue BDTG, MLP, and LD from their earlier weights (needs prep_dir)
 }  DefaultOptions = {
   "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
   "ntForCalib",
   "test.root",
   "tmva_test",
   "TMVARegression",
+  "tree",
+  4096,
+  1,
+  1,
+  "",
+  "",
+  "",
+  1000,
+  3,
+  200,
+  2000,
+  "default",
+  {},
   true,
+  false,
+  false,
+  false,
+  true,
+  false,
   false
 };
 
@@ -93,23 +140,6 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
             << "      output file = " << opt.out_file
             << std::endl;
 
-  // grab input tuple
-  TNtuple* ntToTrain = (TNtuple*) inToTrain -> Get(opt.in_tuple.data());
-  TNtuple* ntToApply = (TNtuple*) inToApply -> Get(opt.in_tuple.data());
-  if (!ntToTrain || !ntToApply) {
-    std::cerr << "PANIC: couldn't grab input tuple!\n"
-              << "       name  = " << opt.in_tuple << "\n"
-              << "       train = " << ntToTrain    << "\n"
-              << "       apply = " << ntToApply
-              << std::endl;
-    assert(ntToTrain && ntToApply);
-  }
-
-  // print input tuples
-  std::cout << "    Grabbed input tuples:\n"
-            << "      tuple = " << opt.in_tuple
-            << std::endl;
-
   // --------------------------------------------------------------------------
   // Set up helpers
   // --------------------------------------------------------------------------
@@ -120,6 +150,9 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   train_helper.SetFactoryOptions(param.opts_factory);
   train_helper.SetTrainOptions(param.opts_training);
   read_helper.SetOptions(param.opts_reading);
+  read_helper.SetUseNative(opt.do_native);
+  read_helper.SetUseCache(opt.do_cache);
+  read_helper.SelectOutputs(opt.out_select);
   std::cout << "    Create TMVA helpers." << std::endl;
 
   // collect input leaves into a single vector
@@ -129,13 +162,110 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   }
 
   // create input/output helpers
-  NTupleHelper in_helper( inputs );
-  NTupleHelper out_helper( read_helper.GetOutputs() );
+  //   - n.b. inputs follow the schema, so counts and
+  //     per-layer sums are read as ints and arrays
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+  NTupleHelper out_helper(
+    read_helper.GetOutputs(),
+    NTupleClusterSchema::GetOutputBranches(read_helper.GetOutputs(), opt.do_reduce)
+  );
+
+  // grab input tuples
+  //   - n.b. with the RNTuple backend or a cache, the tuple
+  //     to train on is copied into a memory-resident tree
+  //     for TMVA
+  const NTupleIO::Backend backend = NTupleIO::ParseBackend(opt.in_backend);
+  std::unique_ptr<NTupleIO::Reader> toTrain;
+  std::unique_ptr<NTupleIO::Reader> toApply;
+  FeatureCache trainCache;
+  FeatureCache applyCache;
+  const uint64_t hash = FeatureCache::HashFile(opt.in_file);
+  if (!opt.cache_dir.empty()) {
+
+    // caches already have their cuts applied, and are
+    // only rebuilt when the input or its selection changes
+    //   - n.b. if either can't be built, the tuple is
+    //     read directly instead
+    const std::string stem = opt.cache_dir + "/" + opt.in_tuple;
+    gSystem -> mkdir(opt.cache_dir.data(), true);
+
+    const bool newTrain = NTupleIO::UpdateCache(
+      trainCache,
+      in_helper,
+      inToTrain,
+      opt.in_tuple,
+      backend,
+      param.training_cuts,
+      hash,
+      stem + ".train.fcache"
+    );
+    const bool newApply = NTupleIO::UpdateCache(
+      applyCache,
+      in_helper,
+      inToApply,
+      opt.in_tuple,
+      backend,
+      opt.do_read_cut ? param.reading_cuts : TCut(""),
+      hash,
+      stem + ".apply.fcache"
+    );
+    if (trainCache.IsOpen() && applyCache.IsOpen()) {
+      toTrain = std::make_unique<NTupleIO::Reader>(in_helper, trainCache, opt.in_tuple);
+      toApply = std::make_unique<NTupleIO::Reader>(in_helper, applyCache, opt.in_tuple);
+      std::cout << "    " << (newTrain || newApply ? "Built" : "Reusing") << " feature caches:\n"
+                << "      training = " << trainCache.GetPath() << " (" << trainCache.GetRows() << " rows)\n"
+                << "      applying = " << applyCache.GetPath() << " (" << applyCache.GetRows() << " rows)"
+                << std::endl;
+    } else {
+      std::cerr << "WARNING: couldn't build feature caches! Reading tuple directly instead." << std::endl;
+      trainCache.Close();
+      applyCache.Close();
+    }
+  }
+  if (!toTrain) {
+    toTrain = std::make_unique<NTupleIO::Reader>(in_helper, inToTrain, opt.in_tuple, backend);
+    toApply = std::make_unique<NTupleIO::Reader>(in_helper, inToApply, opt.in_tuple, backend);
+  }
+
+  // prepared datasets already have their cuts & split
+  // applied, so TMVA can go straight to training
+  //   - n.b. the split options are taken from (and
+  //     then replaced in) the training options
+  std::unique_ptr<PreparedDataset> prepared;
+  if (!opt.prep_dir.empty()) {
+    gSystem -> mkdir(opt.prep_dir.data(), true);
+    prepared = std::make_unique<PreparedDataset>(train_helper, param.add_spectators);
+
+    const bool newPrep = prepared -> Update(
+      *toTrain,
+      param.training_cuts,
+      hash,
+      opt.prep_dir + "/" + opt.in_tuple + ".prep"
+    );
+    train_helper.SetTrainOptions( prepared -> GetTrainingOptions() );
+    std::cout << "    " << (newPrep ? "Built" : "Reusing") << " prepared dataset:\n"
+              << "      split   = " << prepared -> GetSplitKey() << "\n"
+              << "      train   = " << prepared -> GetTrain().GetPath() << " (" << prepared -> GetTrain().GetRows() << " rows)\n"
+              << "      test    = " << prepared -> GetTest().GetPath() << " (" << prepared -> GetTest().GetRows() << " rows)"
+              << std::endl;
+  }
+  TTree* ntToTrain = prepared ? prepared -> GetTrainTree() : toTrain -> GetTree();
+  TTree* ntToTest  = prepared ? prepared -> GetTestTree()  : nullptr;
+  std::cout << "    Grabbed input tuples:\n"
+            << "      tuple   = " << opt.in_tuple << "\n"
+            << "      backend = " << opt.in_backend
+            << std::endl;
 
-  // set input/output tuple branches
-  TNtuple* ntOutput = new TNtuple("ntTmvaOutput", "Output of TMVA regression", out_helper.CompressVariables().data());
-  in_helper.SetBranches(ntToApply);
-  std::cout << "    Set input/output tuple branches." << std::endl;
+  // create output tuple
+  NTupleIO::Writer toOutput(
+    out_helper,
+    output,
+    "ntTmvaOutput",
+    "Output of TMVA regression",
+    NTupleIO::Backend::Tree,
+    NTupleIO::ParsePolicy(opt.out_policy)
+  );
+  std::cout << "    Set input/output tuples." << std::endl;
 
 
   // --------------------------------------------------------------------------
@@ -146,93 +276,304 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   TMVA::Tools::Instance();
   std::cout << "    Begin training calibration models:" << std::endl;
 
-  // create tmva factory & load data
-  TMVA::Factory*    factory = new TMVA::Factory(opt.name_tmva.data(), output, train_helper.CompressFactoryOptions().data());
-  TMVA::DataLoader* loader  = new TMVA::DataLoader(opt.out_tmva.data());
-  std::cout << "      Created factory and data loader..." << std::endl;
+  // split off methods trained natively
+  //   - n.b. without a prepared dataset, these train
+  //     on every event passing the training cuts
+  TMVAHelper::Trainer      main_helper = train_helper;
+  std::vector<std::string> toNative;
+  for (const std::string& method : train_helper.GetMethods()) {
+    if (!TMVAHelper::IsNative(method)) continue;
+    toNative.push_back(method);
+    main_helper.RemoveMethod(method);
+  }
 
-  // now load variables
-  train_helper.LoadVariables(loader, param.add_spectators);
-  std::cout << "      Loaded variables..." << std::endl;
+  // split off methods continued from their earlier
+  // weights
+  //   - n.b. residuals & sums are computed on the
+  //     prepared dataset
+  if (opt.do_warm && !prepared) {
+    std::cerr << "WARNING: continuing methods needs a prepared dataset (prep_dir), training them in full." << std::endl;
+  }
+  train_helper.SetIncremental(opt.do_warm && prepared);
 
-  // add tree & prepare for training
-  loader -> AddRegressionTree(ntToTrain, param.tree_weight);
-  loader -> PrepareTrainingAndTestTree(param.training_cuts, train_helper.CompressTrainingOptions().data());
-  std::cout << "      Added tree, prepared training..." << std::endl;
+  std::vector<std::string> toWarm;
+  for (const std::string& method : main_helper.GetMethods()) {
+    if (!train_helper.IsIncremental(method)) continue;
+    toWarm.push_back(method);
+    main_helper.RemoveMethod(method);
+  }
 
-  // book methods
-  train_helper.BookMethodsToTrain(factory, loader);
-  std::cout << "      Booked methods for training..." << std::endl;
+  // split off methods trained in segments with
+  // checkpoints
+  //   - n.b. only an MLP can be restarted from its
+  //     weights
+  std::vector<std::string> toCheckpoint;
+  if (!opt.ckpt_dir.empty()) {
+    for (const std::string& method : main_helper.GetMethods()) {
+      if (TMVAHelper::MapNameToType()[method] != TMVA::Types::kMLP) continue;
+      toCheckpoint.push_back(method);
+      main_helper.RemoveMethod(method);
+    }
+  }
 
-  // train, test, & evaluate
-  factory -> TrainAllMethods();
-  factory -> TestAllMethods();
-  factory -> EvaluateAllMethods();
-  std::cout << "      Trained models.\n"
-            << "    Finished training calibration models!"
-            << endl;
+  // a tree on disk is reopened in each training job, a
+  // memory-resident one is shared with them
+  const bool inMemory = prepared || trainCache.IsOpen() || (backend != NTupleIO::Backend::Tree);
+
+  ParallelTrain::Dataset data;
+  data.tree = [&]() -> TTree* {
+    if (inMemory) return ntToTrain;
+    TFile* file = TFile::Open(opt.in_file.data(), "read");
+    return file ? (TTree*) file -> Get(opt.in_tuple.data()) : nullptr;
+  };
+  if (prepared) {
+    data.test = [&]() -> TTree* {return ntToTest;};
+  }
+  data.cut            = prepared ? TCut("") : param.training_cuts;
+  data.weight         = param.tree_weight;
+  data.add_spectators = param.add_spectators;
+
+  const std::string        stem = opt.out_file.substr(0, opt.out_file.rfind(".root"));
+  std::vector<std::string> files;
+
+  TMVA::Factory*    factory = nullptr;
+  TMVA::DataLoader* loader  = nullptr;
+  if (main_helper.GetMethods().empty()) {
+    std::cout << "      No methods to train in one go..." << std::endl;
+  } else if (opt.n_train_jobs > 1) {
+
+    ParallelTrain::Settings settings;
+    settings.name      = opt.name_tmva;
+    settings.directory = opt.out_tmva;
+    settings.stem      = stem;
+    settings.jobs      = opt.n_train_jobs;
+
+    // train each method in its own process, their outputs
+    // are merged into the output file below
+    files = ParallelTrain::Run(main_helper, data, settings);
+
+  } else {
+
+    // create tmva factory & load data
+    factory = new TMVA::Factory(opt.name_tmva.data(), output, main_helper.CompressFactoryOptions().data());
+    loader  = new TMVA::DataLoader(opt.out_tmva.data());
+    std::cout << "      Created factory and data loader..." << std::endl;
+
+    // now load variables
+    main_helper.LoadVariables(loader, param.add_spectators);
+    std::cout << "      Loaded variables..." << std::endl;
+
+    // add tree(s) & prepare for training
+    if (prepared) {
+      prepared -> LoadTrees(loader, param.tree_weight);
+    } else {
+      loader -> AddRegressionTree(ntToTrain, param.tree_weight);
+      loader -> PrepareTrainingAndTestTree(param.training_cuts, main_helper.CompressTrainingOptions().data());
+    }
+    std::cout << "      Added tree, prepared training..." << std::endl;
 
-  // --------------------------------------------------------------------------
-  // Apply tmva models
-  // --------------------------------------------------------------------------
+    // book methods
+    main_helper.BookMethodsToTrain(factory, loader);
+    std::cout << "      Booked methods for training..." << std::endl;
 
-  // instantiate formula object for applying ntuple cuts
-  TTreeFormula* selector = new TTreeFormula("selector", param.reading_cuts, ntToApply);
+    // train, test, & evaluate
+    factory -> TrainAllMethods();
+    factory -> TestAllMethods();
+    factory -> EvaluateAllMethods();
+    std::cout << "      Trained models." << std::endl;
+  }
 
-  // instantiate reader
-  TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
-  std::cout << "    Begin applying calibration models:" << std::endl;
+  // train checkpointed methods segment by segment,
+  // resuming from earlier checkpoints if possible
+  if (!toCheckpoint.empty()) {
+
+    ParallelTrain::Dataset local = data;
+    local.tree = [&]() -> TTree* {return ntToTrain;};
+
+    CheckpointTrain::Settings settings;
+    settings.name        = opt.name_tmva;
+    settings.directory   = opt.out_tmva;
+    settings.stem        = stem;
+    settings.checkpoints = opt.ckpt_dir;
+    settings.key         = opt.in_file + ":" + opt.in_tuple + ":" + std::to_string(hash);
+    settings.interval    = opt.ckpt_interval;
+    settings.keep        = opt.ckpt_keep;
+
+    for (const std::string& method : toCheckpoint) {
+      const std::string path = CheckpointTrain::Run(train_helper, local, settings, method);
+      if (path.empty()) {
+        std::cerr << "WARNING: training '" << method << "' failed! Rerun to resume from its last checkpoint." << std::endl;
+        continue;
+      }
+      files.push_back(path);
+    }
+  }
 
-  // add input variables to reader, book methods
-  read_helper.ReadVariables(reader, in_helper);
-  read_helper.BookMethodsToRead(reader, opt.out_tmva, opt.name_tmva);
-  std::cout << "      Added variables and methods to read." << std::endl;
+  // continue methods on the new sample
+  //   - n.b. only methods trained in full write an
+  //     output to merge
+  if (!toWarm.empty()) {
+
+    ParallelTrain::Dataset local = data;
+    local.tree = [&]() -> TTree* {return ntToTrain;};
+
+    WarmStart::Settings settings;
+    settings.name      = opt.name_tmva;
+    settings.directory = opt.out_tmva;
+    settings.stem      = stem;
+    settings.key       = opt.in_tuple + ":" + std::to_string(hash);
+    settings.trees     = opt.warm_trees;
+    settings.cycles    = opt.warm_cycles;
+
+    for (const std::string& method : toWarm) {
+      const std::string path = WarmStart::Run(train_helper, *prepared, local, settings, method);
+      if (!path.empty()) files.push_back(path);
+    }
+  }
 
-  // get number of events for application
-  const uint64_t nEntries = ntToApply -> GetEntries();
-  cout << "    Processing: " << nEntries << " events" << endl;
+  // train native methods, their weights are read
+  // like any other BDT's
+  if (!toNative.empty()) {
 
-  uint64_t nBytes = 0;
-  for (uint64_t iEntry = 0; iEntry < nEntries; iEntry++) {
+    HistBoost::Settings settings;
+    settings.name       = opt.name_tmva;
+    settings.directory  = opt.out_tmva;
+    settings.block_size = opt.block_size;
 
-    // announce progress
-    if (opt.do_progress) {
-      std::cout << "      Processing entry " << iEntry + 1 << "/" << nEntries << "...";
-      if (iEntry + 1 < nEntries) {
-        std::cout << "\r" << std::flush;
-      } else {
-        std::cout << std::endl;
+    NTupleIO::Reader& source = prepared ? prepared -> GetTrainSource() : *toTrain;
+    const TCut        cut    = prepared ? TCut("") : param.training_cuts;
+    for (const std::string& method : toNative) {
+      if (HistBoost::Run(train_helper, source, cut, settings, method).empty()) {
+        std::cerr << "WARNING: training '" << method << "' failed!" << std::endl;
       }
     }
+  }
 
-    // grab entry
-    const uint64_t bytes = ntToApply -> GetEntry(iEntry);
-    if (bytes < 0.) {
-      std::cerr << "WARNING error in entry #" << iEntry << "! Aborting loop!" << std::endl;
-      break;
-    } else {
-      nBytes += bytes;
-    }
+  // merge outputs of separate trainings into the output file
+  if (!files.empty()) {
+    ParallelTrain::Merge(files, output);
+    std::cout << "      Merged outputs of " << files.size() << " separate trainings." << std::endl;
+  }
+  std::cout << "    Finished training calibration models!" << endl;
 
-    // make sure output variables are empty
-    out_helper.ResetValues();
-    read_helper.ResetValues();
+  // --------------------------------------------------------------------------
+  // Apply tmva models
+  // --------------------------------------------------------------------------
 
-    // evaluate targets
-    read_helper.EvaluateMethods(reader, in_helper);
+  // only read what the reader & cuts need
+  //   - n.b. compressed sizes are only reported for trees
+  if (opt.do_project) {
+    const int64_t allBytes = toApply -> GetZipBytes();
+    toApply -> SetActiveVariables( TMVAHelper::GetVariablesToRead(param) );
+    std::cout << "    Projected input onto needed variables:\n"
+              << "      compressed bytes (all branches)    = " << allBytes << "\n"
+              << "      compressed bytes (active branches) = " << toApply -> GetZipBytes(true)
+              << std::endl;
+  }
 
-    // apply cuts if need be
-    const bool isInCut = selector -> EvalInstance();
-    if (opt.do_read_cut && !isInCut) continue;
+  // get number of events for application
+  const uint64_t    nEntries = toApply -> GetEntries();
+  const std::size_t nOutputs = read_helper.GetOutputs().size();
+  cout << "    Processing: " << nEntries << " events" << endl;
 
-    // set values in output tuple & fill
-    for (const std::string& output : read_helper.GetOutputs()) {
-      out_helper.SetVariable( output, read_helper.GetVariable(output) );
+  // with several threads, each worker reads its own
+  // copy of the input and outputs are merged in order
+  TMVA::Reader* reader = nullptr;
+  if (opt.n_threads > 1) {
+
+    ParallelApply::Source source;
+    source.file    = opt.in_file;
+    source.tuple   = opt.in_tuple;
+    source.backend = backend;
+    source.cache   = applyCache.IsOpen() ? applyCache.GetPath() : "";
+    source.active  = opt.do_project ? TMVAHelper::GetVariablesToRead(param) : std::vector<std::string>();
+    source.cut     = opt.do_read_cut ? param.reading_cuts : TCut("");
+
+    ParallelApply::Settings settings;
+    settings.threads    = opt.n_threads;
+    settings.block_size = opt.block_size;
+    settings.chunk_size = 16 * opt.block_size;
+
+    std::cout << "    Begin applying calibration models on " << opt.n_threads << " threads:" << std::endl;
+    const ParallelApply::Result result = ParallelApply::Run(
+      source,
+      {opt.out_tmva, opt.name_tmva},
+      read_helper,
+      in_helper,
+      nEntries,
+      settings,
+      [&](std::span<const float> outputs) {
+        out_helper.SetValues(outputs);
+        toOutput.Fill();
+      },
+      opt.do_progress
+    );
+    if (!result.error.empty()) {
+      std::cerr << "PANIC: couldn't apply calibration models!" << std::endl;
+      assert(result.error.empty());
     }
-    ntOutput -> Fill( out_helper.GetValues().data() );
+    std::cout << "    Application loop finished:\n"
+              << "      entries written = " << result.written
+              << std::endl;
+
+  } else {
+
+    // instantiate selector for applying ntuple cuts & block reader
+    NTupleIO::Selector selector("selector", param.reading_cuts, *toApply);
+    NTupleBlockReader  blocks(*toApply, opt.block_size);
+    blocks.SetSelector(selector);
+
+    // instantiate reader
+    reader = new TMVA::Reader(read_helper.CompressOptions().data());
+    std::cout << "    Begin applying calibration models:" << std::endl;
+
+    // add input variables to reader, book methods
+    read_helper.ReadVariables(reader, in_helper);
+    read_helper.BookMethodsToRead(reader, opt.out_tmva, opt.name_tmva);
+    std::cout << "      Added variables and methods to read." << std::endl;
+
+    while (blocks.Next()) {
+
+      // announce progress
+      const uint64_t nRead = blocks.GetFirstEntry() + blocks.GetSize();
+      if (opt.do_progress) {
+        std::cout << "      Processing entry " << nRead << "/" << nEntries << "...";
+        if (nRead < nEntries) {
+          std::cout << "\r" << std::flush;
+        } else {
+          std::cout << std::endl;
+        }
+      }
 
-  }  // end entry loop
-  std::cout << "    Application loop finished." << std::endl;
+      // evaluate targets over whole block, one method at a time
+      read_helper.EvaluateMethods(reader, in_helper, blocks, opt.do_read_cut);
+
+      // loop over entries in block
+      std::span<const uint8_t> isInCut = blocks.GetMask();
+      for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+
+        // apply cuts if need be
+        if (opt.do_read_cut && !isInCut[iRow]) continue;
+
+        // set values in output tuple & fill
+        //   - n.b. out_helper was built from the reader's
+        //     list of outputs, so the two share indices
+        for (std::size_t iOut = 0; iOut < nOutputs; ++iOut) {
+          out_helper.SetVariable( iOut, read_helper.GetColumn(iOut)[iRow] );
+        }
+        toOutput.Fill();
+
+      }  // end row loop
+    }  // end block loop
+    if (blocks.HasError()) {
+      std::cerr << "PANIC: couldn't read every entry to apply calibration models to!" << std::endl;
+      assert(!blocks.HasError());
+    }
+    std::cout << "    Application loop finished:\n"
+              << "      bytes read from file = " << inToApply -> GetBytesRead() << "\n"
+              << "      bytes unpacked       = " << blocks.GetBytes()
+              << std::endl;
+  }
 
   // --------------------------------------------------------------------------
   // Save output and exit
@@ -240,7 +581,7 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
 
   // save & close files
   output    -> cd();
-  ntOutput  -> Write(); 
+  toOutput.Write();
   output    -> Close();
   inToTrain -> cd();
   inToTrain -> Close();
@@ -250,7 +591,7 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   // delete tmva objects
   delete factory;
   delete loader;
-  delete reader;
+  if (reader) delete reader;
 
   // announce end & exit
   std::cout << "  Finished BHCal calibration script!\n" << std::endl;
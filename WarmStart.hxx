@@ -0,0 +1,807 @@
+/// ===========================================================================
+/*! \file   WarmStart.hxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  Utilities to continue training a TMVA method
+ *  from its last weights when a new sample comes
+ *  in, instead of retraining it from scratch.
+ */
+/// ===========================================================================
+
+#ifndef WarmStart_hxx
+#define WarmStart_hxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+// root libraries
+#include <TTree.h>
+#include <TXMLEngine.h>
+// tmva components
+#include <TMVA/Types.h>
+// analysis utilities
+#include "NTupleIO.hxx"
+#include "TMVAHelper.hxx"
+#include "NativeModel.hxx"
+#include "NativeForest.hxx"
+#include "FeatureCache.hxx"
+#include "ParallelTrain.hxx"
+#include "CheckpointTrain.hxx"
+#include "PreparedDataset.hxx"
+
+
+
+// ============================================================================
+//! Warm Start
+// ============================================================================
+/*! Continues a method from the weights an earlier
+ *  training left in '<directory>/weights':
+ *
+ *    - BDTG: the forest is read natively & the new
+ *      trees are fit to its residuals (target minus
+ *      the old forest's output) on every sample seen
+ *      so far. The new forest is then appended to the
+ *      old one in a single weights file, with the two
+ *      offsets summed;
+ *    - MLP: the booked network is initialized from
+ *      the old weights & trained for `cycles` more
+ *      cycles on every sample seen so far. n.b. TMVA
+ *      takes the Norm ranges from what it's trained
+ *      on, so they only move as far as the new sample
+ *      widens them;
+ *    - LD: the sums of x x^T & y x over every sample
+ *      seen so far are kept next to the weights, the
+ *      new sample's are added, & the coefficients are
+ *      solved for again. This is exactly what training
+ *      on all samples at once would give.
+ *
+ *  Continuing on the new sample alone would be
+ *  cheaper, but a new sample (e.g. one energy) covers
+ *  a narrow slice of the inputs: new trees' leaves &
+ *  a network trained only there would pull the
+ *  calibration away at every earlier sample. So for
+ *  BDTG & MLP a copy of each sample's prepared caches
+ *  is kept next to the weights, and the cost (& disk
+ *  space) of continuing grows with the samples seen;
+ *  it's still less than a full retraining as far
+ *  fewer trees or cycles are trained. Samples whose
+ *  copies went missing are left out (with a warning).
+ *
+ *  The samples a method was continued with are kept
+ *  in '<weights>.warm' (keyed by `key`), so running on
+ *  the same sample twice does nothing; a method with
+ *  no weights yet is trained in full. Weights with no
+ *  record of their samples (e.g. trained elsewhere,
+ *  or retrained since) aren't touched, as going on
+ *  from them would drop every sample they came from:
+ *  remove them to start over from the new sample.
+ *  BDTG & LD require VarTransform=None, & continued
+ *  methods are only trained (the output file is only
+ *  written by a full training; see
+ *  ParallelTrain::Merge).
+ */
+namespace WarmStart {
+
+  // --------------------------------------------------------------------------
+  //! How to continue
+  // --------------------------------------------------------------------------
+  struct Settings {
+    std::string name;              // name of TMVA process
+    std::string directory;         // tmva directory (name of data loader)
+    std::string stem;              // prefix of output file
+    std::string key;               // identifies the new sample (e.g. hash of input)
+    std::size_t trees  = 200;      // BDTG: no. of trees to add
+    std::size_t cycles = 2000;     // MLP: no. of cycles to train for
+  };
+
+  // --------------------------------------------------------------------------
+  //! Samples a method was trained on
+  // --------------------------------------------------------------------------
+  /*! For LD, each sample also keeps its weighted sums
+   *  [sum w, sum w x x^T, sum w y x], with x_0 = 1.
+   */
+  struct History {
+    uint64_t                                   weights = 0;  // hash of weights file they went into
+    std::map<std::string, std::vector<double>> samples;      // sums of each sample
+  };
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get path to the weights of a method
+  // --------------------------------------------------------------------------
+  inline std::string GetWeightsPath(const Settings& settings, const std::string& method) {
+
+    return settings.directory + "/weights/" + settings.name + "_" + method + ".weights.xml";
+
+  }  // end 'GetWeightsPath(Settings&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read history of a method
+  // --------------------------------------------------------------------------
+  inline bool ReadHistory(const std::string& path, History& history) {
+
+    std::ifstream in(path);
+    if (!in.good()) return false;
+
+    history = History();
+    std::string field;
+    while (in >> field) {
+      if (field == "weights") {
+        in >> history.weights;
+      } else if (field == "sample") {
+        std::string key;
+        std::size_t size = 0;
+        in >> key >> size;
+
+        std::vector<double> sums(size);
+        for (double& sum : sums) in >> sum;
+        history.samples[key] = sums;
+      }
+    }
+    return true;
+
+  }  // end 'ReadHistory(std::string&, History&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write history of a method
+  // --------------------------------------------------------------------------
+  /*! Written to a temporary file first & moved into
+   *  place, like CheckpointTrain::WriteState.
+   */
+  inline bool WriteHistory(const std::string& path, const History& history) {
+
+    const std::string temp = path + ".tmp";
+    {
+      std::ofstream out(temp, std::ios::trunc);
+      out << std::setprecision(17)
+          << "weights " << history.weights << "\n";
+      for (const auto& [key, sums] : history.samples) {
+        out << "sample " << key << " " << sums.size();
+        for (const double sum : sums) out << " " << sum;
+        out << "\n";
+      }
+      if (!out.good()) return false;
+    }
+    return std::rename(temp.data(), path.data()) == 0;
+
+  }  // end 'WriteHistory(std::string&, History&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get expressions of the variables in a weights file
+  // --------------------------------------------------------------------------
+  inline std::vector<std::string> GetExpressions(TXMLEngine& xml, XMLNodePointer_t root) {
+
+    std::vector<std::string> expressions;
+
+    XMLNodePointer_t vars = NativeModel::FindChild(xml, root, "Variables");
+    if (!vars) return expressions;
+
+    for (XMLNodePointer_t var = xml.GetChild(vars); var; var = xml.GetNext(var)) {
+      if (std::string("Variable") != xml.GetNodeName(var)) continue;
+      expressions.push_back( NativeModel::GetAttr(xml, var, "Expression") );
+    }
+    return expressions;
+
+  }  // end 'GetExpressions(TXMLEngine&, XMLNodePointer_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Check if a weights file transforms its inputs
+  // --------------------------------------------------------------------------
+  inline bool HasTransformations(TXMLEngine& xml, XMLNodePointer_t root) {
+
+    XMLNodePointer_t transforms = NativeModel::FindChild(xml, root, "Transformations");
+    return transforms && (NativeModel::GetAttr(xml, transforms, "NTransformations") != "0");
+
+  }  // end 'HasTransformations(TXMLEngine&, XMLNodePointer_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Replace an attribute of a node
+  // --------------------------------------------------------------------------
+  inline void SetAttr(TXMLEngine& xml, XMLNodePointer_t node, const std::string& name, const std::string& value) {
+
+    xml.FreeAttr(node, name.data());
+    xml.NewAttr(node, nullptr, name.data(), value.data());
+    return;
+
+  }  // end 'SetAttr(TXMLEngine&, XMLNodePointer_t, std::string&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print a double at full precision
+  // --------------------------------------------------------------------------
+  inline std::string ToString(const double value) {
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return std::string(buffer);
+
+  }  // end 'ToString(double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Append the trees of one forest to another
+  // --------------------------------------------------------------------------
+  /*! The trees of `base` are put in front of those in
+   *  `added`, & the result (with the header of `added`)
+   *  is written to `path`. As the added trees were fit
+   *  to residuals, the offset of the merged forest (the
+   *  boost weight of its first tree) is the sum of both.
+   */
+  inline bool MergeForests(const std::string& base, const std::string& added, const std::string& path) {
+
+    TXMLEngine      xml;
+    XMLDocPointer_t baseDoc  = xml.ParseFile(base.data());
+    XMLDocPointer_t addedDoc = xml.ParseFile(added.data());
+    if (!baseDoc || !addedDoc) {
+      std::cerr << "WARNING: couldn't parse forests '" << base << "' and '" << added << "'!" << std::endl;
+      if (baseDoc)  xml.FreeDoc(baseDoc);
+      if (addedDoc) xml.FreeDoc(addedDoc);
+      return false;
+    }
+
+    XMLNodePointer_t baseRoot     = xml.DocGetRootElement(baseDoc);
+    XMLNodePointer_t addedRoot    = xml.DocGetRootElement(addedDoc);
+    XMLNodePointer_t baseWeights  = NativeModel::FindChild(xml, baseRoot, "Weights");
+    XMLNodePointer_t addedWeights = NativeModel::FindChild(xml, addedRoot, "Weights");
+
+    // forests can only be summed if they see the
+    // same, untransformed inputs
+    bool isGood = baseWeights && addedWeights
+               && !HasTransformations(xml, baseRoot)
+               && !HasTransformations(xml, addedRoot)
+               && (GetExpressions(xml, baseRoot) == GetExpressions(xml, addedRoot));
+    if (!isGood) {
+      std::cerr << "WARNING: can't merge forests with different variables or with transformations!" << std::endl;
+      xml.FreeDoc(baseDoc);
+      xml.FreeDoc(addedDoc);
+      return false;
+    }
+
+    // collect trees of each forest
+    auto getTrees = [&](XMLNodePointer_t weights) {
+      std::vector<XMLNodePointer_t> trees;
+      for (XMLNodePointer_t tree = xml.GetChild(weights); tree; tree = xml.GetNext(tree)) {
+        if (std::string("BinaryTree") == xml.GetNodeName(tree)) trees.push_back(tree);
+      }
+      return trees;
+    };
+    const std::vector<XMLNodePointer_t> baseTrees  = getTrees(baseWeights);
+    const std::vector<XMLNodePointer_t> addedTrees = getTrees(addedWeights);
+    if (baseTrees.empty() || addedTrees.empty()) {
+      xml.FreeDoc(baseDoc);
+      xml.FreeDoc(addedDoc);
+      return false;
+    }
+
+    const double offset = std::strtod(NativeModel::GetAttr(xml, baseTrees.front(), "boostWeight").data(), nullptr)
+                        + std::strtod(NativeModel::GetAttr(xml, addedTrees.front(), "boostWeight").data(), nullptr);
+
+    // move old trees in front of the new ones & renumber
+    for (auto tree = baseTrees.rbegin(); tree != baseTrees.rend(); ++tree) {
+      xml.UnlinkNode(*tree);
+      xml.AddChildFirst(addedWeights, *tree);
+    }
+
+    const std::vector<XMLNodePointer_t> trees = getTrees(addedWeights);
+    for (std::size_t iTree = 0; iTree < trees.size(); ++iTree) {
+      SetAttr(xml, trees[iTree], "itree", std::to_string(iTree));
+    }
+    SetAttr(xml, trees.front(), "boostWeight", ToString(offset));
+    SetAttr(xml, addedWeights, "NTrees", std::to_string(trees.size()));
+
+    // and keep the recorded options consistent
+    XMLNodePointer_t options = NativeModel::FindChild(xml, addedRoot, "Options");
+    for (XMLNodePointer_t option = options ? xml.GetChild(options) : nullptr; option; option = xml.GetNext(option)) {
+      if (NativeModel::GetAttr(xml, option, "name") != "NTrees") continue;
+      xml.SetNodeContent(option, std::to_string(trees.size()).data());
+    }
+
+    xml.SaveDoc(addedDoc, path.data());
+    xml.FreeDoc(baseDoc);
+    xml.FreeDoc(addedDoc);
+    return true;
+
+  }  // end 'MergeForests(std::string& x3)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write the rows of several caches to a new cache
+  // --------------------------------------------------------------------------
+  /*! Caches need the same columns, the first of which
+   *  is the target. If a model is given, the target is
+   *  replaced by the target minus the model's output,
+   *  evaluated in blocks of `block_size` rows.
+   */
+  inline bool WriteSamples(
+    const std::vector<const FeatureCache*>& caches,
+    const std::string& path,
+    const NativeModel::Base* model = nullptr,
+    const std::size_t block_size = 4096
+  ) {
+
+    if (caches.empty()) return false;
+    const std::vector<std::string>& columns = caches.front() -> GetVariables();
+    for (const FeatureCache* cache : caches) {
+      if (cache -> GetVariables() != columns) {
+        std::cerr << "WARNING: columns of '" << cache -> GetPath() << "' don't match!" << std::endl;
+        return false;
+      }
+    }
+
+    // find columns of model's variables
+    std::vector<std::size_t> indices;
+    for (const std::string& var : model ? model -> GetVariables() : std::vector<std::string>()) {
+      const auto column = std::find(columns.begin(), columns.end(), var);
+      if (column == columns.end()) {
+        std::cerr << "WARNING: variable '" << var << "' isn't in '" << caches.front() -> GetPath() << "'!" << std::endl;
+        return false;
+      }
+      indices.push_back( std::distance(columns.begin(), column) );
+    }
+
+    FeatureCache::Builder builder(path, columns, caches.front() -> GetSourceHash(), caches.front() -> GetCut());
+
+    std::vector<std::vector<float>> inputs(indices.size(), std::vector<float>(block_size));
+    std::vector<const float*>       inputPointers;
+    for (const std::vector<float>& input : inputs) {
+      inputPointers.push_back(input.data());
+    }
+
+    std::vector<float>          output(block_size, 0.);
+    std::vector<float*>         outputPointers = {output.data()};
+    std::vector<float>          row(columns.size());
+    NativeModel::Context        context;
+    for (const FeatureCache* cache : caches) {
+      for (uint64_t start = 0; start < cache -> GetRows(); start += block_size) {
+
+        const std::size_t nRows = std::min<uint64_t>(block_size, cache -> GetRows() - start);
+        if (model) {
+          for (std::size_t iVar = 0; iVar < indices.size(); ++iVar) {
+            for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+              inputs[iVar][iRow] = cache -> GetValue(start + iRow, indices[iVar]);
+            }
+          }
+          model -> Evaluate(inputPointers, nRows, outputPointers, context);
+        }
+
+        for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+          for (std::size_t iCol = 0; iCol < columns.size(); ++iCol) {
+            row[iCol] = cache -> GetValue(start + iRow, iCol);
+          }
+          row[0] -= output[iRow];
+          if (!builder.Append(row)) return false;
+        }
+      }
+    }
+    return builder.Close();
+
+  }  // end 'WriteSamples(std::vector<const FeatureCache*>&, std::string&, NativeModel::Base*, std::size_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get path to the kept copy of a sample
+  // --------------------------------------------------------------------------
+  /*! e.g. '<weights>.<hash of key>.train.fcache', with
+   *  `type` either "train" or "test".
+   */
+  inline std::string GetSamplePath(const std::string& weights, const std::string& key, const std::string& type) {
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long) FeatureCache::Hash(key.data(), key.size()));
+    return weights + "." + hash + "." + type + ".fcache";
+
+  }  // end 'GetSamplePath(std::string&, std::string&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Open the kept copies of every sample in a history
+  // --------------------------------------------------------------------------
+  /*! Samples whose copies are missing or have columns
+   *  other than `variables` are skipped (with a
+   *  warning). Returns the no. of samples opened.
+   */
+  inline std::size_t OpenSamples(
+    const std::string& weights,
+    const History& history,
+    const std::vector<std::string>& variables,
+    std::vector<std::unique_ptr<FeatureCache>>& train,
+    std::vector<std::unique_ptr<FeatureCache>>& test
+  ) {
+
+    train.clear();
+    test.clear();
+    for (const auto& sample : history.samples) {
+      auto trainCache = std::make_unique<FeatureCache>();
+      auto testCache  = std::make_unique<FeatureCache>();
+
+      const bool isGood = trainCache -> Open( GetSamplePath(weights, sample.first, "train") )
+                       && testCache -> Open( GetSamplePath(weights, sample.first, "test") )
+                       && (trainCache -> GetVariables() == variables)
+                       && (testCache -> GetVariables() == variables);
+      if (!isGood) {
+        std::cerr << "WARNING: no copy of sample '" << sample.first << "' is kept, continuing without it!" << std::endl;
+        continue;
+      }
+      train.push_back( std::move(trainCache) );
+      test.push_back( std::move(testCache) );
+    }
+    return train.size();
+
+  }  // end 'OpenSamples(std::string&, History&, std::vector<std::string>&, std::vector<std::unique_ptr<FeatureCache>>& x2)'
+
+
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get the weighted sums of a cache for LD
+  // --------------------------------------------------------------------------
+  /*! With x = (1, x_1, ..., x_n) taken from the columns
+   *  after the target (the first column), returns
+   *  [sum w, sum w x x^T, sum w y x], as accumulated in
+   *  TMVA::MethodLD::GetSum() & GetSumVal().
+   */
+  inline std::vector<double> GetSums(const FeatureCache& cache, const std::size_t nVars, const double weight) {
+
+    const std::size_t   nDims = nVars + 1;
+    std::vector<double> sums(1 + (nDims * nDims) + nDims, 0.);
+    std::vector<double> x(nDims, 1.);
+    double* const       xx = sums.data() + 1;
+    double* const       xy = xx + (nDims * nDims);
+    for (uint64_t iRow = 0; iRow < cache.GetRows(); ++iRow) {
+
+      const double y = cache.GetValue(iRow, 0);
+      for (std::size_t iVar = 0; iVar < nVars; ++iVar) {
+        x[iVar + 1] = cache.GetValue(iRow, iVar + 1);
+      }
+
+      sums[0] += weight;
+      for (std::size_t iDim = 0; iDim < nDims; ++iDim) {
+        for (std::size_t jDim = 0; jDim < nDims; ++jDim) {
+          xx[(iDim * nDims) + jDim] += weight * x[iDim] * x[jDim];
+        }
+        xy[iDim] += weight * y * x[iDim];
+      }
+    }
+    return sums;
+
+  }  // end 'GetSums(FeatureCache&, std::size_t, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Solve for LD coefficients
+  // --------------------------------------------------------------------------
+  /*! Solves (sum w x x^T) c = (sum w y x) by gaussian
+   *  elimination with partial pivoting. Returns false
+   *  if the system is singular.
+   */
+  inline bool SolveCoefficients(const std::vector<double>& sums, const std::size_t nVars, std::vector<double>& coefficients) {
+
+    const std::size_t   nDims = nVars + 1;
+    std::vector<double> matrix(sums.begin() + 1, sums.begin() + 1 + (nDims * nDims));
+    std::vector<double> vector(sums.begin() + 1 + (nDims * nDims), sums.end());
+    auto at = [&](const std::size_t iRow, const std::size_t iCol) -> double& {
+      return matrix[(iRow * nDims) + iCol];
+    };
+
+    // eliminate below diagonal
+    for (std::size_t iCol = 0; iCol < nDims; ++iCol) {
+
+      std::size_t pivot = iCol;
+      for (std::size_t iRow = iCol + 1; iRow < nDims; ++iRow) {
+        if (std::abs(at(iRow, iCol)) > std::abs(at(pivot, iCol))) pivot = iRow;
+      }
+      if (std::abs(at(pivot, iCol)) < 1e-300) return false;
+
+      if (pivot != iCol) {
+        for (std::size_t jCol = 0; jCol < nDims; ++jCol) std::swap(at(pivot, jCol), at(iCol, jCol));
+        std::swap(vector[pivot], vector[iCol]);
+      }
+      for (std::size_t iRow = iCol + 1; iRow < nDims; ++iRow) {
+        const double factor = at(iRow, iCol) / at(iCol, iCol);
+        for (std::size_t jCol = iCol; jCol < nDims; ++jCol) at(iRow, jCol) -= factor * at(iCol, jCol);
+        vector[iRow] -= factor * vector[iCol];
+      }
+    }
+
+    // and substitute back
+    coefficients.assign(nDims, 0.);
+    for (std::size_t iRow = nDims; iRow-- > 0;) {
+      double sum = vector[iRow];
+      for (std::size_t jCol = iRow + 1; jCol < nDims; ++jCol) sum -= at(iRow, jCol) * coefficients[jCol];
+      coefficients[iRow] = sum / at(iRow, iRow);
+    }
+    return true;
+
+  }  // end 'SolveCoefficients(std::vector<double>&, std::size_t, std::vector<double>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Overwrite the coefficients of an LD weights file
+  // --------------------------------------------------------------------------
+  /*! Coefficient 0 is the constant term; the others
+   *  follow the order of the variables.
+   */
+  inline bool SetCoefficients(const std::string& path, const std::vector<double>& coefficients) {
+
+    TXMLEngine      xml;
+    XMLDocPointer_t doc = xml.ParseFile(path.data());
+    if (!doc) return false;
+
+    XMLNodePointer_t root    = xml.DocGetRootElement(doc);
+    XMLNodePointer_t weights = NativeModel::FindChild(xml, root, "Weights");
+    if (!weights || HasTransformations(xml, root)) {
+      std::cerr << "WARNING: can't update LD weights with transformations!" << std::endl;
+      xml.FreeDoc(doc);
+      return false;
+    }
+
+    std::size_t nSet = 0;
+    for (XMLNodePointer_t coeff = xml.GetChild(weights); coeff; coeff = xml.GetNext(coeff)) {
+      if (std::string("Coefficient") != xml.GetNodeName(coeff)) continue;
+
+      const std::size_t index = std::stoul( NativeModel::GetAttr(xml, coeff, "IndexCoeff") );
+      if (index >= coefficients.size()) continue;
+      SetAttr(xml, coeff, "Value", ToString(coefficients[index]));
+      ++nSet;
+    }
+
+    const bool isGood = (nSet == coefficients.size());
+    if (isGood) xml.SaveDoc(doc, path.data());
+    xml.FreeDoc(doc);
+    return isGood;
+
+  }  // end 'SetCoefficients(std::string&, std::vector<double>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Train a method, continuing from its last weights if possible
+  // --------------------------------------------------------------------------
+  /*! `prepared` has to hold the new sample (the target
+   *  first, then the training variables). Returns the
+   *  output file if the method was trained in full,
+   *  and an empty string otherwise.
+   */
+  inline std::string Run(
+    const TMVAHelper::Trainer& helper,
+    PreparedDataset& prepared,
+    const ParallelTrain::Dataset& data,
+    const Settings& settings,
+    const std::string& method
+  ) {
+
+    const TMVA::Types::EMVA type    = TMVAHelper::MapNameToType()[method];
+    const std::string       options = helper.GetMethodOptions(method);
+    const std::string       weights = GetWeightsPath(settings, method);
+    const std::string       base    = weights.substr(0, weights.rfind(".weights.xml")) + ".base.weights.xml";
+    const std::string       record  = weights + ".warm";
+    const bool              isLD    = (type == TMVA::Types::kLD);
+
+    // trainings are run like checkpoint segments
+    CheckpointTrain::Settings segment;
+    segment.name      = settings.name;
+    segment.directory = settings.directory;
+    segment.stem      = settings.stem;
+
+    // history only applies to the weights it was
+    // written for
+    History history;
+    if (!ReadHistory(record, history) || !TMVAHelper::DoesFileExist(weights) || (history.weights != FeatureCache::HashFile(weights))) {
+      history = History();
+    }
+    if (history.samples.count(settings.key)) {
+      std::cout << "      '" << method << "' was already trained on this sample." << std::endl;
+      return "";
+    }
+
+    // never narrow weights down to the new sample
+    const bool hasWeights = TMVAHelper::DoesFileExist(weights);
+    if (hasWeights && history.samples.empty()) {
+      std::cerr << "WARNING: there's no record of the samples '" << method << "' was trained on, so it can't be"
+                << " continued without dropping them! Retrain it on every sample, or remove '" << weights
+                << "' to start over from this one." << std::endl;
+      return "";
+    }
+
+    // record sample: LD only needs its sums, others
+    // keep a copy of it to continue on later
+    const History     past  = history;
+    const std::size_t nVars = helper.GetTrainers().size();
+    if (isLD) {
+      history.samples[settings.key] = GetSums(prepared.GetTrain(), nVars, data.weight);
+    } else {
+      history.samples[settings.key] = {};
+
+      std::error_code error;
+      std::filesystem::copy_file(prepared.GetTrain().GetPath(), GetSamplePath(weights, settings.key, "train"), std::filesystem::copy_options::overwrite_existing, error);
+      if (!error) {
+        std::filesystem::copy_file(prepared.GetTest().GetPath(), GetSamplePath(weights, settings.key, "test"), std::filesystem::copy_options::overwrite_existing, error);
+      }
+      if (error) {
+        std::cerr << "WARNING: couldn't keep a copy of the new sample for '" << method << "': " << error.message() << std::endl;
+        return "";
+      }
+    }
+
+    // with nothing to continue from, train in full
+    if (!hasWeights) {
+      const std::string output = settings.stem + "." + method + ".root";
+      if (!CheckpointTrain::TrainSegment(helper, data, segment, method, options, "", output, true)) return "";
+
+      history.weights = FeatureCache::HashFile(weights);
+      if (!WriteHistory(record, history)) {
+        std::cerr << "WARNING: couldn't record samples of '" << method << "', it can't be continued later." << std::endl;
+      }
+      return output;
+    }
+
+    // BDTG & MLP continue on every sample so far
+    std::vector<std::unique_ptr<FeatureCache>> trainSamples;
+    std::vector<std::unique_ptr<FeatureCache>> testSamples;
+    std::vector<const FeatureCache*>           trainCaches;
+    std::vector<const FeatureCache*>           testCaches;
+    if (!isLD) {
+      OpenSamples(weights, history, prepared.GetVariables(), trainSamples, testSamples);
+      for (std::size_t iSample = 0; iSample < trainSamples.size(); ++iSample) {
+        trainCaches.push_back( trainSamples[iSample].get() );
+        testCaches.push_back( testSamples[iSample].get() );
+      }
+    }
+
+    // keep the old weights to start from (and to fall
+    // back on)
+    std::error_code error;
+    std::filesystem::copy_file(weights, base, std::filesystem::copy_options::overwrite_existing, error);
+    if (error) {
+      std::cerr << "WARNING: couldn't copy weights '" << weights << "': " << error.message() << std::endl;
+      return "";
+    }
+
+    const std::string output    = settings.stem + "." + method + ".warm.root";
+    const std::string trainPath = weights + ".union.train.fcache";
+    const std::string testPath  = weights + ".union.test.fcache";
+    bool              isGood    = false;
+    switch (type) {
+
+      // fit new trees to the residuals of the old ones,
+      // or start the network from the old weights
+      case TMVA::Types::kBDT:
+        [[fallthrough]];
+      case TMVA::Types::kMLP:
+        {
+          const bool          isForest = (type == TMVA::Types::kBDT);
+          NativeModel::Forest forest;
+          if (isForest && !forest.Load(base)) break;
+
+          const NativeModel::Base* model = isForest ? &forest : nullptr;
+          FeatureCache             trainUnion;
+          FeatureCache             testUnion;
+          if (!WriteSamples(trainCaches, trainPath, model) || !trainUnion.Open(trainPath)) break;
+          if (!WriteSamples(testCaches, testPath, model) || !testUnion.Open(testPath)) break;
+
+          NTupleIO::Reader       trainReader(prepared.GetHelper(), trainUnion, "unionTrain");
+          NTupleIO::Reader       testReader(prepared.GetHelper(), testUnion, "unionTest");
+          ParallelTrain::Dataset samples = data;
+          samples.tree = [&]() -> TTree* {return trainReader.GetTree();};
+          samples.test = [&]() -> TTree* {return testReader.GetTree();};
+
+          if (isForest) {
+            isGood = CheckpointTrain::TrainSegment(
+              helper,
+              samples,
+              segment,
+              method,
+              TMVAHelper::SetOption(options, "NTrees", std::to_string(settings.trees)),
+              "",
+              output,
+              false
+            ) && MergeForests(base, weights, weights);
+          } else {
+            isGood = CheckpointTrain::TrainSegment(
+              helper,
+              samples,
+              segment,
+              method,
+              TMVAHelper::SetOption(options, "NCycles", std::to_string(settings.cycles)),
+              base,
+              output,
+              false
+            );
+          }
+
+          trainUnion.Close();
+          testUnion.Close();
+        }
+        break;
+
+      // solve with the sums of every sample
+      //   - n.b. TMVA's own training only provides a
+      //     weights file to put the coefficients in
+      case TMVA::Types::kLD:
+        {
+          std::vector<double> total;
+          for (const auto& sample : history.samples) {
+            const std::vector<double>& sums = sample.second;
+            if (total.empty()) total.assign(sums.size(), 0.);
+            if (sums.size() != total.size()) {
+              total.clear();
+              break;
+            }
+            for (std::size_t iSum = 0; iSum < sums.size(); ++iSum) total[iSum] += sums[iSum];
+          }
+
+          std::vector<double> coefficients;
+          isGood = !total.empty()
+                && SolveCoefficients(total, nVars, coefficients)
+                && CheckpointTrain::TrainSegment(helper, data, segment, method, options, "", output, false)
+                && SetCoefficients(weights, coefficients);
+        }
+        break;
+
+      default:
+        std::cerr << "WARNING: '" << method << "' can't be continued from earlier weights!" << std::endl;
+        break;
+    }
+    std::remove(output.data());
+    std::remove(trainPath.data());
+    std::remove(testPath.data());
+
+    // restore old weights if anything went wrong
+    //   - n.b. restoring rewrites the file, so its
+    //     samples are recorded again
+    if (!isGood) {
+      std::filesystem::copy_file(base, weights, std::filesystem::copy_options::overwrite_existing, error);
+      History restored = past;
+      restored.weights = FeatureCache::HashFile(weights);
+      if (error || !WriteHistory(record, restored)) {
+        std::cerr << "WARNING: couldn't restore the earlier weights of '" << method << "' & their samples!" << std::endl;
+      }
+      std::cerr << "WARNING: couldn't continue '" << method << "', kept its earlier weights." << std::endl;
+      return "";
+    }
+
+    history.weights = FeatureCache::HashFile(weights);
+    if (!WriteHistory(record, history)) {
+      std::cerr << "WARNING: couldn't record samples of '" << method << "', it can't be continued later." << std::endl;
+    }
+    std::cout << "      Continued '" << method << "' from " << base
+              << " (" << history.samples.size() << " samples so far)." << std::endl;
+    return "";
+
+  }  // end 'Run(TMVAHelper::Trainer&, PreparedDataset&, ParallelTrain::Dataset&, Settings&, std::string&)'
+
+}  // end WarmStart namespace
+
+#endif
+
+// end ========================================================================
@@ -13,6 +13,7 @@
 #define ApplyBHCalClusterCalibration_cxx
 
 // c++ utilities
+#include <span>
 #include <string>
 #include <vector>
 #include <cassert>
@@ -22,12 +23,16 @@
 #include <TCut.h>
 #include <TFile.h>
 #include <TNtuple.h>
+#include <TString.h>
 #include <TSystem.h>
 // tmva components
 #include <TMVA/Reader.h>
 // analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
 #include "../../utility/TMVAHelper.hxx"
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/ParallelApply.hxx"
 
 
 
@@ -40,6 +45,10 @@ struct Options {
   std::string out_file;     // output file
   std::string out_tmva;     // output tmva directory
   std::string name_tmva;    // name of TMVA process
+  std::size_t n_threads;    // number of threads to apply models with (1 = serial)
+  std::vector<std::string> out_select;  // outputs to evaluate, e.g. {"ePar_BDTG"} (empty = all)
+  bool        do_native;    // evaluate supported methods (BDTG, MLP, KNN) without TMVA::Reader
+  bool        do_cache;     // cache native models in binary files next to their weights
   bool        do_progress;  // print progress through entry loop
 }  DefaultOptions = {
   "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
@@ -47,6 +56,10 @@ struct Options {
   "testB.root",
   "tmva_test",
   "TMVARegression",
+  1,
+  {},
+  false,
+  false,
   true
 };
 
@@ -62,59 +75,10 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   // --------------------------------------------------------------------------
 
   // input variables & usage
-  const std::vector<std::pair<TMVAHelper::Use, std::string>> vecUseAndVar = {
-    {TMVAHelper::Use::Target, "ePar"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBEMC"},
-    {TMVAHelper::Use::Watch, "fracLeadBHCalVsBEMC"},
-    {TMVAHelper::Use::Watch, "fracSumBHCalVsBEMC"},
-    {TMVAHelper::Use::Train, "eLeadBHCal"},
-    {TMVAHelper::Use::Train, "eLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eSumBHCal"},
-    {TMVAHelper::Use::Watch, "eSumBEMC"},
-    {TMVAHelper::Use::Watch, "diffLeadBHCal"},
-    {TMVAHelper::Use::Watch, "diffLeadBEMC"},
-    {TMVAHelper::Use::Watch, "diffSumBHCal"},
-    {TMVAHelper::Use::Watch, "diffSumBEMC"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "nClustBHCal"},
-    {TMVAHelper::Use::Watch, "nClustBEMC"},
-    {TMVAHelper::Use::Watch, "hLeadBHCal"},
-    {TMVAHelper::Use::Watch, "hLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eLeadImage"},
-    {TMVAHelper::Use::Watch, "eSumImage"},
-    {TMVAHelper::Use::Watch, "eLeadScFi"},
-    {TMVAHelper::Use::Watch, "eSumScFi"},
-    {TMVAHelper::Use::Watch, "nClustImage"},
-    {TMVAHelper::Use::Watch, "nClustScFi"},
-    {TMVAHelper::Use::Watch, "hLeadImage"},
-    {TMVAHelper::Use::Watch, "hLeadScFi"},
-    {TMVAHelper::Use::Watch, "fLeadImage"},
-    {TMVAHelper::Use::Watch, "fLeadScFi"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer1"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer2"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer3"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer4"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer5"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer6"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer7"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer8"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer9"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer10"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer11"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer12"},
-    {TMVAHelper::Use::Train, "eSumImageLayer1"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer2"},
-    {TMVAHelper::Use::Train, "eSumImageLayer3"},
-    {TMVAHelper::Use::Train, "eSumImageLayer4"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer5"},
-    {TMVAHelper::Use::Train, "eSumImageLayer6"}
-  };
+  //   - n.b. every variable of the tuple schema, with
+  //     the usage set in TMVAClusterParameters.hxx
+  const std::vector<std::pair<TMVAHelper::Use, std::string>> vecUseAndVar = TMVAClusterParameters::GetUseAndVar();
+
 
   // methods to use
   //   - TODO might be good to add field for method-specific options
@@ -182,7 +146,7 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
             << std::endl;
 
   // grab input tuple
-  TNtuple* ntInput = (TNtuple*) input -> Get(opt.in_tuple.data());
+  TTree* ntInput = (TTree*) input -> Get(opt.in_tuple.data());
   if (!input) {
     std::cerr << "PANIC: couldn't grab input tuple!\n"
               << "       name  = " << opt.in_tuple << "\n"
@@ -203,6 +167,9 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   // create tmva helper
   TMVAHelper::Reader read_helper(vecUseAndVar, vecMethods);
   read_helper.SetOptions(vecReadOpts);
+  read_helper.SetUseNative(opt.do_native);
+  read_helper.SetUseCache(opt.do_cache);
+  read_helper.SelectOutputs(opt.out_select);
 
   // collect input leaves into a single vector
   std::vector<std::string> inputs;
@@ -211,7 +178,7 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   }
 
   // create input/output helpers
-  NTupleHelper in_helper( inputs );
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
   NTupleHelper out_helper( read_helper.GetOutputs() );
 
   // set input/output tuple branches
@@ -223,60 +190,96 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   // Apply tmva models
   // --------------------------------------------------------------------------
 
-  // instantiate reader
-  TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
-  std::cout << "    Begin applying calibration models:" << std::endl;
-
-  // add input variables to reader, book methods
-  read_helper.ReadVariables(reader, in_helper);
-  read_helper.BookMethodsToRead(reader, opt.out_tmva, opt.name_tmva);
-  std::cout << "      Added variables and methods to read." << std::endl;
-
   // get number of events for application
   const uint64_t nEntries = ntInput -> GetEntries();
   cout << "    Processing: " << nEntries << " events" << endl;
 
-  uint64_t nBytes = 0;
-  for (uint64_t iEntry = 0; iEntry < nEntries; iEntry++) {
-
-    // announce progress
-    if (opt.do_progress) {
-      std::cout << "      Processing entry " << iEntry + 1 << "/" << nEntries << "...";
-      if (iEntry + 1 < nEntries) {
-        std::cout << "\r" << std::flush;
-      } else {
-        std::cout << std::endl;
-      }
+  // with several threads, each worker reads its own
+  // copy of the input and outputs are merged in order
+  //   - n.b. the ecal cut is then applied while reading
+  TMVA::Reader* reader = nullptr;
+  if (opt.n_threads > 1) {
+
+    ParallelApply::Source source;
+    source.file  = opt.in_file;
+    source.tuple = opt.in_tuple;
+    if (doECalCut) {
+      source.cut = Form("(eLeadBEMC>%f)&&(eLeadBEMC<%f)", eneECalRange.first, eneECalRange.second);
     }
 
-    // grab entry
-    const uint64_t bytes = ntInput -> GetEntry(iEntry);
-    if (bytes < 0.) {
-      std::cerr << "WARNING error in entry #" << iEntry << "! Aborting loop!" << std::endl;
-      break;
-    } else {
-      nBytes += bytes;
+    ParallelApply::Settings settings;
+    settings.threads = opt.n_threads;
+
+    std::cout << "    Begin applying calibration models on " << opt.n_threads << " threads:" << std::endl;
+    const ParallelApply::Result result = ParallelApply::Run(
+      source,
+      {opt.out_tmva, opt.name_tmva},
+      read_helper,
+      in_helper,
+      nEntries,
+      settings,
+      [&](std::span<const float> outputs) {
+        out_helper.SetValues(outputs);
+        ntOutput -> Fill( out_helper.GetValues().data() );
+      },
+      opt.do_progress
+    );
+    if (!result.error.empty()) {
+      std::cerr << "PANIC: couldn't apply calibration models!" << std::endl;
+      assert(result.error.empty());
     }
 
-    // make sure output variables are empty
-    out_helper.ResetValues();
-    read_helper.ResetValues();
+  } else {
 
-    // evaluate targets
-    read_helper.EvaluateMethods(reader, in_helper);
+    // instantiate reader
+    reader = new TMVA::Reader(read_helper.CompressOptions().data());
+    std::cout << "    Begin applying calibration models:" << std::endl;
 
-    // apply ecal cut if need be
-    const double eLeadBEMC   = in_helper.GetVariable("eLeadBEMC");
-    const bool   isInECalCut = ((eLeadBEMC > eneECalRange.first) && (eLeadBEMC < eneECalRange.second));
-    if (doECalCut && !isInECalCut) continue;
+    // add input variables to reader, book methods
+    read_helper.ReadVariables(reader, in_helper);
+    read_helper.BookMethodsToRead(reader, opt.out_tmva, opt.name_tmva);
+    std::cout << "      Added variables and methods to read." << std::endl;
 
-    // set values in output tuple & fill
-    for (const std::string& output : read_helper.GetOutputs()) {
-      out_helper.SetVariable( output, read_helper.GetVariable(output) );
-    }
-    ntOutput -> Fill( out_helper.GetValues().data() );
+    uint64_t nBytes = 0;
+    for (uint64_t iEntry = 0; iEntry < nEntries; iEntry++) {
+
+      // announce progress
+      if (opt.do_progress) {
+        std::cout << "      Processing entry " << iEntry + 1 << "/" << nEntries << "...";
+        if (iEntry + 1 < nEntries) {
+          std::cout << "\r" << std::flush;
+        } else {
+          std::cout << std::endl;
+        }
+      }
+
+      // grab entry
+      const int64_t bytes = in_helper.GetEntry(ntInput, iEntry);
+      if (bytes < 0.) {
+        std::cerr << "WARNING error in entry #" << iEntry << "! Aborting loop!" << std::endl;
+        break;
+      } else {
+        nBytes += bytes;
+      }
+
+      // make sure output variables are empty
+      out_helper.ResetValues();
+      read_helper.ResetValues();
 
-  }  // end entry loop
+      // evaluate targets
+      read_helper.EvaluateMethods(reader, in_helper);
+
+      // apply ecal cut if need be
+      const double eLeadBEMC   = in_helper.GetVariable("eLeadBEMC");
+      const bool   isInECalCut = ((eLeadBEMC > eneECalRange.first) && (eLeadBEMC < eneECalRange.second));
+      if (doECalCut && !isInECalCut) continue;
+
+      // set values in output tuple & fill
+      out_helper.SetValues( read_helper.GetValues() );
+      ntOutput -> Fill( out_helper.GetValues().data() );
+
+    }  // end entry loop
+  }
   std::cout << "    Application loop finished." << std::endl;
 
   // --------------------------------------------------------------------------
@@ -291,7 +294,7 @@ void ApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   input    -> Close();
 
   // delete tmva object
-  delete reader;
+  if (reader) delete reader;
 
   // announce end & exit
   std::cout << "  Finished BHCal calibration script!\n" << std::endl;
@@ -0,0 +1,191 @@
+/// ===========================================================================
+/*! \file   BenchmarkNativeBackends.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A benchmark of inference throughput of the native
+ *  evaluators (BDTG, MLP, KNN) against TMVA::Reader.
+ *  Entries are read in blocks; for every method with
+ *  a native evaluator, each block is evaluated once
+ *  through TMVA (one entry at a time) and once
+ *  natively (the whole block at once), and the
+ *  entries per second of each are reported.
+ *
+ *  Needs weights from a previous training (see
+ *  TrainAndApplyBHCalClusterCalibration.cxx). Check
+ *  that the outputs agree with ValidateNativeBackends.cxx.
+ */
+/// ===========================================================================
+
+#define BenchmarkNativeBackends_cxx
+
+// c++ utilities
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TFile.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+#include <TMVA/MethodBase.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;     // input calibration tuple
+  std::string in_tuple;    // name of input tuple
+  std::string out_tmva;    // tmva directory holding weights
+  std::string name_tmva;   // name of TMVA process
+  uint64_t    entries;     // max number of entries to evaluate
+  std::size_t block_size;  // no. of entries per block
+} DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "tmva_test",
+  "TMVARegression",
+  1000000,
+  4096
+};
+
+
+
+// ============================================================================
+//! Benchmark native evaluators against TMVA
+// ============================================================================
+void BenchmarkNativeBackends(const Options& opt = DefaultOptions) {
+
+  // announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning native backend benchmark..." << std::endl;
+
+  // set up helpers
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters();
+  TMVAHelper::Reader     tmva_helper( param.variables, param.methods );
+  TMVAHelper::Reader     native_helper( param.variables, param.methods );
+  tmva_helper.SetOptions(param.opts_reading);
+  native_helper.SetOptions(param.opts_reading);
+  native_helper.SetUseNative(true);
+
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+
+  // book methods both ways
+  TMVA::Tools::Instance();
+  TMVA::Reader* tmva   = new TMVA::Reader(tmva_helper.CompressOptions().data());
+  TMVA::Reader* native = new TMVA::Reader(native_helper.CompressOptions().data());
+  tmva_helper.ReadVariables(tmva, in_helper);
+  native_helper.ReadVariables(native, in_helper);
+  tmva_helper.BookMethodsToRead(tmva, opt.out_tmva, opt.name_tmva);
+  native_helper.BookMethodsToRead(native, opt.out_tmva, opt.name_tmva);
+
+  // collect methods with both a native evaluator & a tmva handle
+  std::vector<std::size_t>       methods;
+  std::vector<TMVA::MethodBase*> handles;
+  for (std::size_t iMethod = 0; iMethod < param.methods.size(); ++iMethod) {
+    const std::string title  = param.methods[iMethod].first + " method";
+    TMVA::MethodBase* handle = dynamic_cast<TMVA::MethodBase*>( tmva -> FindMVA(title) );
+    if (!native_helper.GetNative(iMethod) || !handle) continue;
+    methods.push_back(iMethod);
+    handles.push_back(handle);
+  }
+  if (methods.empty()) {
+    std::cout << "    No methods can be evaluated natively! Exiting." << std::endl;
+    return;
+  }
+
+  // columns of training variables & space for outputs
+  std::vector<std::size_t> trainers;
+  for (const std::string& trainer : tmva_helper.GetTrainers()) {
+    trainers.push_back( in_helper.GetIndex(trainer) );
+  }
+  const std::size_t               nTargets = tmva_helper.GetTargets().size();
+  std::vector<std::vector<float>> outputs(nTargets, std::vector<float>(opt.block_size));
+  std::vector<float*>             outPtrs;
+  std::vector<const float*>       inPtrs(trainers.size());
+  NativeModel::Context            context;
+  for (std::vector<float>& output : outputs) {
+    outPtrs.push_back( output.data() );
+  }
+
+  // --------------------------------------------------------------------------
+  // time each method both ways, block by block
+  // --------------------------------------------------------------------------
+  std::vector<double> tmvaTime(methods.size(), 0.);
+  std::vector<double> nativeTime(methods.size(), 0.);
+  double              checksum = 0.;
+
+  TFile*            input = new TFile(opt.in_file.data(), "read");
+  NTupleIO::Reader  source(in_helper, input, opt.in_tuple);
+  NTupleBlockReader blocks(source, opt.block_size);
+  uint64_t          nEntries = 0;
+  while (blocks.Next() && (nEntries < opt.entries)) {
+
+    for (std::size_t iTrain = 0; iTrain < trainers.size(); ++iTrain) {
+      inPtrs[iTrain] = blocks.GetColumn(trainers[iTrain]).data();
+    }
+
+    for (std::size_t iCheck = 0; iCheck < methods.size(); ++iCheck) {
+
+      // tmva, one entry at a time
+      auto startTmva = std::chrono::steady_clock::now();
+      for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+        for (std::size_t iTrain = 0; iTrain < trainers.size(); ++iTrain) {
+          in_helper.SetVariable(trainers[iTrain], inPtrs[iTrain][iRow]);
+        }
+        checksum += tmva -> EvaluateRegression(handles[iCheck]).front();
+      }
+      auto stopTmva = std::chrono::steady_clock::now();
+
+      // native, whole block at once
+      auto startNative = std::chrono::steady_clock::now();
+      native_helper.GetNative(methods[iCheck]) -> Evaluate(inPtrs, blocks.GetSize(), outPtrs, context);
+      auto stopNative = std::chrono::steady_clock::now();
+      checksum += outputs.front().front();
+
+      tmvaTime[iCheck]   += std::chrono::duration<double>(stopTmva - startTmva).count();
+      nativeTime[iCheck] += std::chrono::duration<double>(stopNative - startNative).count();
+    }
+    nEntries += blocks.GetSize();
+  }  // end block loop
+  if (blocks.HasError()) {
+    std::cerr << "WARNING: stopped reading after " << nEntries << " entries!" << std::endl;
+  }
+
+  // report results
+  std::cout << "    Evaluated " << nEntries << " entries in blocks of " << opt.block_size << ":" << std::endl;
+  for (std::size_t iCheck = 0; iCheck < methods.size(); ++iCheck) {
+    std::cout << "      " << std::setw(10) << std::left << param.methods[methods[iCheck]].first << std::right
+              << "  tmva = "   << std::setw(12) << nEntries / tmvaTime[iCheck]   << " entries/s"
+              << "  native = " << std::setw(12) << nEntries / nativeTime[iCheck] << " entries/s"
+              << "  (x" << tmvaTime[iCheck] / nativeTime[iCheck] << ")"
+              << std::endl;
+  }
+  std::cout << "    Checksum = " << checksum << std::endl;
+
+  // clean up & exit
+  delete tmva;
+  delete native;
+  input -> Close();
+  std::cout << "  Finished native backend benchmark!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
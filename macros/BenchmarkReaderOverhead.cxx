@@ -0,0 +1,267 @@
+/// ===========================================================================
+/*! \file   BenchmarkReaderOverhead.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A benchmark of the per-event cost TMVAHelper::Reader
+ *  adds on top of TMVA. Four passes over the same
+ *  in-memory entries are timed:
+ *
+ *    1. TMVA alone (EvaluateRegression on method handles),
+ *    2. the old string-based path (titles & output names
+ *       built per event, looked up by name),
+ *    3. TMVAHelper::Reader::EvaluateMethods plus copying
+ *       outputs into an NTupleHelper,
+ *    4. the block (method-major) EvaluateMethods, one
+ *       block of entries at a time.
+ *
+ *  The overhead of 2-4 is their time minus that of 1.
+ *
+ *  Heap allocations are counted by replacing the
+ *  global operator new, which only takes effect in a
+ *  standalone build:
+ *
+ *    g++ -O2 -std=c++20 BenchmarkReaderOverhead.cxx \
+ *      $(root-config --cflags --libs) -lTMVA -o benchReader
+ *
+ *  Needs weights from a previous training (see
+ *  TrainAndApplyBHCalClusterCalibration.cxx).
+ */
+/// ===========================================================================
+
+#define BenchmarkReaderOverhead_cxx
+
+// c++ utilities
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <new>
+// root libraries
+#include <TFile.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+#include <TMVA/MethodBase.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Allocation counter
+// ============================================================================
+namespace {
+  std::atomic<uint64_t> nAllocs = 0;
+}
+
+#ifndef __CLING__
+void* operator new(std::size_t size) {
+  ++nAllocs;
+  if (void* ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {std::free(ptr);}
+void operator delete(void* ptr, std::size_t) noexcept {std::free(ptr);}
+#endif
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;    // input calibration tuple
+  std::string in_tuple;   // name of input tuple
+  std::string out_tmva;   // tmva directory holding weights
+  std::string name_tmva;  // name of TMVA process
+  uint64_t    entries;    // max number of entries to evaluate
+  std::size_t block_size; // no. of entries per block in block pass
+} DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "tmva_test",
+  "TMVARegression",
+  100000,
+  4096
+};
+
+
+
+// ============================================================================
+//! Benchmark per-event overhead of TMVAHelper::Reader
+// ============================================================================
+void BenchmarkReaderOverhead(const Options& opt = DefaultOptions) {
+
+  // announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning TMVAHelper::Reader overhead benchmark..." << std::endl;
+
+  // set up helpers
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters();
+  TMVAHelper::Reader     read_helper( param.variables, param.methods );
+  read_helper.SetOptions(param.opts_reading);
+
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+  NTupleHelper out_helper( read_helper.GetOutputs() );
+
+  // load entries into memory so that i/o isn't timed
+  TFile*             input = new TFile(opt.in_file.data(), "read");
+  std::vector<float> rows;
+  uint64_t           nEntries = 0;
+  {
+    NTupleIO::Reader source(in_helper, input, opt.in_tuple);
+    nEntries = std::min(opt.entries, source.GetEntries());
+    for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+      source.GetEntry(iEntry);
+      rows.insert(rows.end(), in_helper.GetValues().begin(), in_helper.GetValues().end());
+    }
+  }
+  std::cout << "    Loaded " << nEntries << " entries." << std::endl;
+
+  // book methods
+  TMVA::Tools::Instance();
+  TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
+  read_helper.ReadVariables(reader, in_helper);
+  read_helper.BookMethodsToRead(reader, opt.out_tmva, opt.name_tmva);
+
+  // grab handles & titles of booked methods
+  std::vector<std::string>       methods;
+  std::vector<TMVA::MethodBase*> handles;
+  for (const auto& methodAndOpts : param.methods) {
+    const std::string title  = methodAndOpts.first + " method";
+    TMVA::MethodBase* handle = dynamic_cast<TMVA::MethodBase*>( reader -> FindMVA(title) );
+    if (!handle) continue;
+    methods.push_back(methodAndOpts.first);
+    handles.push_back(handle);
+  }
+  std::cout << "    Booked " << handles.size() << " methods." << std::endl;
+
+  // lambda to time one pass & count allocations
+  const std::size_t nVars = in_helper.GetVariables().size();
+  auto runPass = [&](const std::string& label, auto&& evaluate) {
+
+    const uint64_t startAllocs = nAllocs.load();
+    const auto     startTime   = std::chrono::steady_clock::now();
+    for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+      in_helper.SetValues( std::span<const float>(rows.data() + (iEntry * nVars), nVars) );
+      evaluate();
+    }
+    const auto     stopTime   = std::chrono::steady_clock::now();
+    const uint64_t stopAllocs = nAllocs.load();
+
+    const double nanoseconds = std::chrono::duration<double, std::nano>(stopTime - startTime).count() / nEntries;
+    std::cout << "    " << label << ":\n"
+              << "      time / entry   = " << nanoseconds << " ns\n"
+              << "      allocs / entry = " << (double) (stopAllocs - startAllocs) / nEntries
+              << std::endl;
+    return nanoseconds;
+
+  };
+
+  // 1. tmva alone
+  const double tmvaTime = runPass("TMVA only", [&]() {
+    for (TMVA::MethodBase* handle : handles) {
+      reader -> EvaluateRegression(handle);
+    }
+  });
+
+  // 2. old string-based path
+  std::map<std::string, std::size_t> outdex;
+  for (std::size_t iOut = 0; iOut < read_helper.GetOutputs().size(); ++iOut) {
+    outdex[ read_helper.GetOutputs()[iOut] ] = iOut;
+  }
+  std::vector<float>       outvals( read_helper.GetOutputs().size() );
+  std::vector<std::string> targets = read_helper.GetTargets();
+  const double stringTime = runPass("string-based path", [&]() {
+    for (const std::string& method : methods) {
+      const std::string        title  = method + " method";
+      const std::vector<float> values = reader -> EvaluateRegression(title);
+      for (std::size_t iTarget = 0; iTarget < targets.size(); ++iTarget) {
+        const std::string output = targets[iTarget] + "_" + method;
+        outvals.at(outdex[output]) = values.at(iTarget);
+      }
+    }
+    const std::vector<std::string> outputs = read_helper.GetOutputs();
+    for (const std::string& output : outputs) {
+      out_helper.SetVariable(output, outvals.at(outdex[output]));
+    }
+  });
+
+  // 3. current helper path
+  const double helperTime = runPass("TMVAHelper::Reader", [&]() {
+    read_helper.EvaluateMethods(reader, in_helper);
+    out_helper.SetValues( read_helper.GetValues() );
+  });
+
+  // 4. block path
+  //   - n.b. entries are re-read through a block reader,
+  //     and only the evaluation is timed
+  double blockTime = 0.;
+  {
+    NTupleIO::Reader  source(in_helper, input, opt.in_tuple);
+    NTupleBlockReader blocks(source, opt.block_size);
+
+    uint64_t nBlockEntries = 0;
+    uint64_t blockAllocs   = 0;
+    while (blocks.Next() && (nBlockEntries < nEntries)) {
+      const uint64_t startAllocs = nAllocs.load();
+      const auto     startTime   = std::chrono::steady_clock::now();
+      read_helper.EvaluateMethods(reader, in_helper, blocks);
+      const auto     stopTime    = std::chrono::steady_clock::now();
+      blockAllocs   += nAllocs.load() - startAllocs;
+      blockTime     += std::chrono::duration<double, std::nano>(stopTime - startTime).count();
+      nBlockEntries += blocks.GetSize();
+    }
+    if (blocks.HasError()) {
+      std::cerr << "WARNING: stopped reading after " << nBlockEntries << " entries!" << std::endl;
+    }
+    blockTime /= nBlockEntries;
+    std::cout << "    block path (" << opt.block_size << " entries / block):\n"
+              << "      time / entry   = " << blockTime << " ns\n"
+              << "      allocs / entry = " << (double) blockAllocs / nBlockEntries
+              << std::endl;
+  }
+
+  // report overheads & exit
+  std::cout << "    Overhead on top of TMVA:\n"
+            << "      string-based path  = " << stringTime - tmvaTime << " ns / entry\n"
+            << "      TMVAHelper::Reader = " << helperTime - tmvaTime << " ns / entry\n"
+            << "      block path         = " << blockTime  - tmvaTime << " ns / entry"
+            << std::endl;
+
+  delete reader;
+  input -> Close();
+  std::cout << "  Finished TMVAHelper::Reader overhead benchmark!\n" << std::endl;
+  return;
+
+}
+
+
+
+#ifndef __CLING__
+// ============================================================================
+//! Entry point for standalone builds
+// ============================================================================
+int main() {
+
+  BenchmarkReaderOverhead();
+  return 0;
+
+}
+#endif
+
+// end ========================================================================
@@ -0,0 +1,185 @@
+/// ===========================================================================
+/*! \file   BenchmarkTupleBackends.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to compare write time, file size,
+ *  and read time of the calibration tuple between
+ *  the TTree and RNTuple backends of NTupleIO.
+ *  Entries are either copied from an existing
+ *  calibration tuple or generated on the fly.
+ *
+ *  The tree is also read back in blocks, with and
+ *  without the block reader's bulk branch reads.
+ */
+/// ===========================================================================
+
+#define BenchmarkTupleBackends_cxx
+
+// c++ utilities
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <filesystem>
+// root libraries
+#include <TFile.h>
+#include <TRandom3.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;    // input calibration tuple (leave empty to generate entries)
+  std::string in_tuple;   // name of input tuple
+  std::string out_label;  // label for scratch output files
+  uint64_t    entries;    // number of entries to generate if no input
+  std::size_t block_size; // entries per block when reading in blocks
+} DefaultOptions = {
+  "",
+  "ntForCalib",
+  "benchmarkTupleBackends",
+  10000000,
+  4096
+};
+
+
+
+// ============================================================================
+//! Compare tuple backends
+// ============================================================================
+void BenchmarkTupleBackends(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning tuple backend benchmark..." << std::endl;
+
+  // helper for values & random generator for fake entries
+  NTupleHelper helper( NTupleClusterSchema::GetVariables(), NTupleClusterSchema::GetBranches() );
+  TRandom3     random(1);
+
+  // open input if provided
+  TFile*                            input = nullptr;
+  std::unique_ptr<NTupleIO::Reader> source;
+  if (!opt.in_file.empty()) {
+    input  = new TFile(opt.in_file.data(), "read");
+    source = std::make_unique<NTupleIO::Reader>(helper, input, opt.in_tuple);
+  }
+  const uint64_t nEntries = source ? source -> GetEntries() : opt.entries;
+
+  // lambda to set values of an entry
+  auto loadEntry = [&](const uint64_t iEntry) {
+    if (source) {
+      source -> GetEntry(iEntry);
+    } else {
+      for (std::size_t iVar = 0; iVar < NTupleClusterSchema::NVars; ++iVar) {
+        helper.SetVariable(iVar, random.Exp(2.));
+      }
+    }
+  };
+
+  // loop over backends
+  const std::vector<std::pair<NTupleIO::Backend, std::string>> backends = {
+    {NTupleIO::Backend::Tree,    "ttree"},
+    {NTupleIO::Backend::RNTuple, "rntuple"}
+  };
+  for (const auto& [backend, label] : backends) {
+
+    const std::string path = opt.out_label + "." + label + ".root";
+
+    // ------------------------------------------------------------------------
+    // time writing
+    // ------------------------------------------------------------------------
+    auto   startWrite = std::chrono::steady_clock::now();
+    TFile* output     = new TFile(path.data(), "recreate");
+    {
+      NTupleIO::Writer writer(helper, output, opt.in_tuple, "Benchmark tuple", backend);
+      for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+        loadEntry(iEntry);
+        writer.Fill();
+      }
+      writer.Write();
+    }
+    output -> Close();
+    auto stopWrite = std::chrono::steady_clock::now();
+
+    // ------------------------------------------------------------------------
+    // time reading every column back
+    // ------------------------------------------------------------------------
+    NTupleHelper reread( NTupleClusterSchema::GetVariables(), NTupleClusterSchema::GetBranches() );
+    double       checksum  = 0.;
+    auto         startRead = std::chrono::steady_clock::now();
+    TFile*       toRead    = new TFile(path.data(), "read");
+    {
+      NTupleIO::Reader reader(reread, toRead, opt.in_tuple, backend);
+      for (uint64_t iEntry = 0; iEntry < reader.GetEntries(); ++iEntry) {
+        reader.GetEntry(iEntry);
+        checksum += reread.GetVariable(NTupleClusterSchema::ePar);
+      }
+    }
+    toRead -> Close();
+    auto stopRead = std::chrono::steady_clock::now();
+
+    // ------------------------------------------------------------------------
+    // time reading trees in blocks, basket by basket & entry by entry
+    // ------------------------------------------------------------------------
+    std::vector<double> blockTimes;
+    for (const bool useBulk : {true, false}) {
+      if (backend != NTupleIO::Backend::Tree) break;
+
+      double checkBlocks = 0.;
+      auto   startBlocks = std::chrono::steady_clock::now();
+      TFile* toBlock     = new TFile(path.data(), "read");
+      {
+        NTupleIO::Reader  reader(reread, toBlock, opt.in_tuple, backend);
+        NTupleBlockReader blocks(reader, opt.block_size);
+        blocks.SetUseBulk(useBulk);
+        while (blocks.Next()) {
+          for (const float value : blocks.GetColumn(NTupleClusterSchema::ePar)) {
+            checkBlocks += value;
+          }
+        }
+        if (blocks.HasError()) {
+          std::cerr << "WARNING: couldn't read every entry in blocks!" << std::endl;
+        }
+        if (useBulk && !blocks.IsBulk()) {
+          std::cerr << "WARNING: tree couldn't be read in bulk!" << std::endl;
+        }
+      }
+      toBlock -> Close();
+      auto stopBlocks = std::chrono::steady_clock::now();
+      blockTimes.push_back( std::chrono::duration<double>(stopBlocks - startBlocks).count() );
+      checksum += checkBlocks;
+    }
+
+    // report results
+    const double writeTime = std::chrono::duration<double>(stopWrite - startWrite).count();
+    const double readTime  = std::chrono::duration<double>(stopRead - startRead).count();
+    const double fileSize  = std::filesystem::file_size(path) / (1024. * 1024.);
+    std::cout << "    " << label << " (" << nEntries << " entries):\n"
+              << "      write time = " << writeTime << " s\n"
+              << "      read time  = " << readTime  << " s\n";
+    if (blockTimes.size() == 2) {
+      std::cout << "      block read (bulk)      = " << blockTimes[0] << " s\n"
+                << "      block read (per entry) = " << blockTimes[1] << " s\n";
+    }
+    std::cout << "      file size  = " << fileSize  << " MB\n"
+              << "      checksum   = " << checksum
+              << std::endl;
+
+  }  // end backend loop
+
+  // close input if needed & exit
+  if (input) input -> Close();
+  std::cout << "  Finished tuple backend benchmark!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,172 @@
+/// ===========================================================================
+/*! \file   BenchmarkWriterPolicies.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to compare write throughput, file
+ *  size, and read throughput of the calibration
+ *  tuple across NTupleIO writer presets (and the
+ *  TTree and RNTuple backends). Entries are copied
+ *  from an existing calibration tuple, which is
+ *  the representative case, or generated on the
+ *  fly if no input is given.
+ *
+ *  n.b. read timings include whatever the OS has
+ *  cached from the write; drop caches between runs
+ *  for cold-read numbers.
+ */
+/// ===========================================================================
+
+#define BenchmarkWriterPolicies_cxx
+
+// c++ utilities
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <filesystem>
+// root libraries
+#include <TFile.h>
+#include <TRandom3.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;    // input calibration tuple (leave empty to generate entries)
+  std::string in_tuple;   // name of input tuple
+  std::string in_backend; // backend of input tuple
+  std::string out_label;  // label for scratch output files
+  uint64_t    entries;    // number of entries to generate if no input
+  bool        do_rntuple; // also benchmark the rntuple backend
+} DefaultOptions = {
+  "",
+  "ntForCalib",
+  "tree",
+  "benchmarkWriterPolicies",
+  5000000,
+  true
+};
+
+
+
+// ============================================================================
+//! Compare writer presets
+// ============================================================================
+void BenchmarkWriterPolicies(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning writer policy benchmark..." << std::endl;
+
+  // helper for values & random generator for fake entries
+  NTupleHelper helper( NTupleClusterSchema::GetVariables(), NTupleClusterSchema::GetBranches() );
+  TRandom3     random(1);
+
+  // open input if provided
+  TFile*                            input = nullptr;
+  std::unique_ptr<NTupleIO::Reader> source;
+  if (!opt.in_file.empty()) {
+    input  = new TFile(opt.in_file.data(), "read");
+    source = std::make_unique<NTupleIO::Reader>(helper, input, opt.in_tuple, NTupleIO::ParseBackend(opt.in_backend));
+  }
+  const uint64_t nEntries = source ? source -> GetEntries() : opt.entries;
+  const double   rawSize  = nEntries * NTupleClusterSchema::NVars * sizeof(float) / (1024. * 1024.);
+
+  // lambda to set values of an entry
+  //   - n.b. generated values are rounded a bit so
+  //     that they compress somewhat like real ones
+  auto loadEntry = [&](const uint64_t iEntry) {
+    if (source) {
+      source -> GetEntry(iEntry);
+    } else {
+      for (std::size_t iVar = 0; iVar < NTupleClusterSchema::NVars; ++iVar) {
+        helper.SetVariable(iVar, std::round(random.Exp(2.) * 1000.) / 1000.);
+      }
+    }
+  };
+
+  // presets & backends to run over
+  const std::vector<std::pair<NTupleIO::Preset, std::string>> presets = {
+    {NTupleIO::Preset::Default,   "default"},
+    {NTupleIO::Preset::FastWrite, "fastwrite"},
+    {NTupleIO::Preset::SmallFile, "smallfile"},
+    {NTupleIO::Preset::FastRead,  "fastread"}
+  };
+  std::vector<std::pair<NTupleIO::Backend, std::string>> backends = {
+    {NTupleIO::Backend::Tree, "ttree"}
+  };
+  if (opt.do_rntuple) {
+    backends.push_back( {NTupleIO::Backend::RNTuple, "rntuple"} );
+  }
+
+  // loop over presets & backends
+  std::cout << "    " << nEntries << " entries, " << rawSize << " MB uncompressed" << std::endl;
+  for (const auto& [backend, backendLabel] : backends) {
+    for (const auto& [preset, presetLabel] : presets) {
+
+      const std::string label = backendLabel + "." + presetLabel;
+      const std::string path  = opt.out_label + "." + label + ".root";
+
+      // ----------------------------------------------------------------------
+      // time writing
+      // ----------------------------------------------------------------------
+      auto   startWrite = std::chrono::steady_clock::now();
+      TFile* output     = new TFile(path.data(), "recreate");
+      {
+        NTupleIO::Writer writer(helper, output, opt.in_tuple, "Benchmark tuple", backend, NTupleIO::GetPolicy(preset));
+        for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+          loadEntry(iEntry);
+          writer.Fill();
+        }
+        writer.Write();
+      }
+      output -> Close();
+      auto stopWrite = std::chrono::steady_clock::now();
+
+      // ----------------------------------------------------------------------
+      // time reading every column back
+      // ----------------------------------------------------------------------
+      NTupleHelper reread( NTupleClusterSchema::GetVariables(), NTupleClusterSchema::GetBranches() );
+      double       checksum  = 0.;
+      auto         startRead = std::chrono::steady_clock::now();
+      TFile*       toRead    = new TFile(path.data(), "read");
+      {
+        NTupleIO::Reader reader(reread, toRead, opt.in_tuple, backend);
+        for (uint64_t iEntry = 0; iEntry < reader.GetEntries(); ++iEntry) {
+          reader.GetEntry(iEntry);
+          checksum += reread.GetVariable(NTupleClusterSchema::ePar);
+        }
+      }
+      toRead -> Close();
+      auto stopRead = std::chrono::steady_clock::now();
+
+      // report results
+      const double writeTime = std::chrono::duration<double>(stopWrite - startWrite).count();
+      const double readTime  = std::chrono::duration<double>(stopRead - startRead).count();
+      const double fileSize  = std::filesystem::file_size(path) / (1024. * 1024.);
+      std::cout << "    " << label << ":\n"
+                << "      write throughput = " << rawSize / writeTime << " MB/s (" << writeTime << " s)\n"
+                << "      read throughput  = " << rawSize / readTime  << " MB/s (" << readTime  << " s)\n"
+                << "      file size        = " << fileSize << " MB (ratio " << rawSize / fileSize << ")\n"
+                << "      checksum         = " << checksum
+                << std::endl;
+
+    }  // end preset loop
+  }  // end backend loop
+
+  // close input if needed & exit
+  if (input) input -> Close();
+  std::cout << "  Finished writer policy benchmark!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
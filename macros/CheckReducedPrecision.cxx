@@ -0,0 +1,179 @@
+/// ===========================================================================
+/*! \file   CheckReducedPrecision.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to check what reduced-precision
+ *  storage costs and saves. A full-precision tuple
+ *  (either the calibration tuple or the TMVA output
+ *  tuple) is rewritten at full and at reduced
+ *  precision, and for each branch the compressed
+ *  size of both, and for each variable the largest
+ *  absolute & relative error, are reported.
+ */
+/// ===========================================================================
+
+#define CheckReducedPrecision_cxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;    // input tuple at full precision
+  std::string in_tuple;   // name of input tuple
+  std::string out_label;  // label for scratch output files
+  bool        is_output;  // if true, input is a TMVA output tuple
+} DefaultOptions = {
+  "forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke10pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "checkReducedPrecision",
+  false
+};
+
+
+
+// ============================================================================
+//! Check size savings & errors of reduced-precision storage
+// ============================================================================
+void CheckReducedPrecision(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning reduced-precision check..." << std::endl;
+
+  // open input & figure out its variables
+  TFile* input = new TFile(opt.in_file.data(), "read");
+  TTree* tree  = (TTree*) input -> Get(opt.in_tuple.data());
+  if (!tree) {
+    std::cerr << "PANIC: couldn't grab tuple '" << opt.in_tuple << "'!" << std::endl;
+    assert(tree);
+  }
+
+  std::vector<std::string> variables = NTupleClusterSchema::GetVariables();
+  if (opt.is_output) {
+    variables.clear();
+    TObjArray* branches = tree -> GetListOfBranches();
+    for (int iBranch = 0; iBranch < branches -> GetEntriesFast(); ++iBranch) {
+      variables.push_back( branches -> At(iBranch) -> GetName() );
+    }
+  }
+
+  // lambda to get layout at full or reduced precision
+  auto getLayout = [&](const bool reduced) {
+    return opt.is_output
+      ? NTupleClusterSchema::GetOutputBranches(variables, reduced)
+      : NTupleClusterSchema::GetBranches(variables, reduced);
+  };
+
+  // --------------------------------------------------------------------------
+  // rewrite input at both precisions
+  // --------------------------------------------------------------------------
+  NTupleHelper source(variables, getLayout(false));
+  NTupleHelper full(variables, getLayout(false));
+  NTupleHelper reduced(variables, getLayout(true));
+
+  const std::string pathFull    = opt.out_label + ".full.root";
+  const std::string pathReduced = opt.out_label + ".reduced.root";
+  TFile* outFull    = new TFile(pathFull.data(), "recreate");
+  TFile* outReduced = new TFile(pathReduced.data(), "recreate");
+  {
+    NTupleIO::Reader reader(source, input, opt.in_tuple);
+    NTupleIO::Writer toFull(full, outFull, opt.in_tuple, "Full precision");
+    NTupleIO::Writer toReduced(reduced, outReduced, opt.in_tuple, "Reduced precision");
+    for (uint64_t iEntry = 0; iEntry < reader.GetEntries(); ++iEntry) {
+      reader.GetEntry(iEntry);
+      full.SetValues( source.GetValueSpan() );
+      reduced.SetValues( source.GetValueSpan() );
+      toFull.Fill();
+      toReduced.Fill();
+    }
+    outFull -> cd();
+    toFull.Write();
+    outReduced -> cd();
+    toReduced.Write();
+  }
+  outFull    -> Close();
+  outReduced -> Close();
+  std::cout << "    Wrote full & reduced copies of '" << opt.in_tuple << "'." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // compare what was written
+  // --------------------------------------------------------------------------
+  TFile* inFull    = new TFile(pathFull.data(), "read");
+  TFile* inReduced = new TFile(pathReduced.data(), "read");
+
+  // compressed size per branch
+  TTree* treeFull    = (TTree*) inFull -> Get(opt.in_tuple.data());
+  TTree* treeReduced = (TTree*) inReduced -> Get(opt.in_tuple.data());
+  int64_t totalFull    = 0;
+  int64_t totalReduced = 0;
+  std::cout << "    Compressed size per branch (full -> reduced):" << std::endl;
+  for (const NTupleHelper::Branch& branch : reduced.GetBranches()) {
+    const int64_t bytesFull    = treeFull -> GetBranch(branch.name.data()) -> GetZipBytes("*");
+    const int64_t bytesReduced = treeReduced -> GetBranch(branch.name.data()) -> GetZipBytes("*");
+    totalFull    += bytesFull;
+    totalReduced += bytesReduced;
+    std::cout << "      " << std::setw(24) << std::left << branch.name << std::right
+              << std::setw(12) << bytesFull << " -> " << std::setw(12) << bytesReduced
+              << "  (" << 100. * (1. - (double) bytesReduced / bytesFull) << "% saved)"
+              << std::endl;
+  }
+  std::cout << "      total: " << totalFull << " -> " << totalReduced
+            << " bytes (" << 100. * (1. - (double) totalReduced / totalFull) << "% saved)"
+            << std::endl;
+
+  // largest error per variable
+  NTupleHelper     readFull(variables, getLayout(false));
+  NTupleHelper     readReduced(variables, getLayout(true));
+  NTupleIO::Reader fromFull(readFull, inFull, opt.in_tuple);
+  NTupleIO::Reader fromReduced(readReduced, inReduced, opt.in_tuple);
+
+  std::vector<double> maxAbs(variables.size(), 0.);
+  std::vector<double> maxRel(variables.size(), 0.);
+  for (uint64_t iEntry = 0; iEntry < fromFull.GetEntries(); ++iEntry) {
+    fromFull.GetEntry(iEntry);
+    fromReduced.GetEntry(iEntry);
+    for (std::size_t iVar = 0; iVar < variables.size(); ++iVar) {
+      const double value = readFull.GetVariable(iVar);
+      const double error = std::abs(readReduced.GetVariable(iVar) - value);
+      maxAbs[iVar] = std::max(maxAbs[iVar], error);
+      if (value != 0.) {
+        maxRel[iVar] = std::max(maxRel[iVar], error / std::abs(value));
+      }
+    }
+  }
+
+  std::cout << "    Largest error per variable (absolute, relative):" << std::endl;
+  for (std::size_t iVar = 0; iVar < variables.size(); ++iVar) {
+    std::cout << "      " << std::setw(24) << std::left << variables[iVar] << std::right
+              << std::setw(14) << maxAbs[iVar] << std::setw(14) << maxRel[iVar]
+              << std::endl;
+  }
+
+  // close files & exit
+  inFull    -> Close();
+  inReduced -> Close();
+  input     -> Close();
+  std::cout << "  Finished reduced-precision check!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
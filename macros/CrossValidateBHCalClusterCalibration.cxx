@@ -0,0 +1,159 @@
+/// ===========================================================================
+/*! \file   CrossValidateBHCalClusterCalibration.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to cross-validate the calibration
+ *  methods over k folds instead of scoring them on a
+ *  single random split. Folds are trained at the
+ *  same time in parallel worker processes; every
+ *  event's out-of-fold calibrated energy is written
+ *  to the output file, and each method's resolution
+ *  & linearity are reported per fold & overall.
+ *  Methods & options are taken from
+ *  TMVAClusterParameters.hxx.
+ */
+/// ===========================================================================
+
+#define CrossValidateBHCalClusterCalibration_cxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TSystem.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/CrossValidate.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;      // input calibration tuple
+  std::string in_tuple;     // name of input tuple
+  std::string out_file;     // output file with out-of-fold estimates
+  std::string out_dir;      // directory to train folds in
+  std::string name_tmva;    // name of TMVA process
+  std::string fold_dir;     // directory for the events of each fold
+  std::size_t n_folds;      // number of folds
+  std::size_t n_jobs;       // number of folds to train at once (0 = all)
+  std::size_t n_threads;    // number of threads per fold for native methods (0 = cores / jobs)
+  uint64_t    seed;         // seed for assigning events to folds
+  std::size_t n_bins;       // number of bins in target to measure resolution in
+} DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "crossValidation.root",
+  "tmva_folds",
+  "TMVARegression",
+  "folds",
+  5,
+  0,
+  0,
+  100,
+  10
+};
+
+
+
+// ============================================================================
+//! Cross-validate calibration methods
+// ============================================================================
+void CrossValidateBHCalClusterCalibration(const Options& opt = DefaultOptions) {
+
+  // announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning calibration cross-validation..." << std::endl;
+
+  // set up helpers
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters();
+  TMVAHelper::Trainer    train_helper( param.variables, param.methods );
+  train_helper.SetFactoryOptions(param.opts_factory);
+  train_helper.SetTrainOptions(param.opts_training);
+
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+
+  // deal (or reuse) events into folds
+  TFile* input = new TFile(opt.in_file.data(), "read");
+  if (!input || input -> IsZombie()) {
+    std::cerr << "PANIC: couldn't open input file '" << opt.in_file << "'!" << std::endl;
+    assert(input && !input -> IsZombie());
+  }
+  gSystem -> mkdir(opt.fold_dir.data(), true);
+
+  NTupleIO::Reader     source(in_helper, input, opt.in_tuple);
+  CrossValidate::Folds folds(train_helper, opt.n_folds, opt.seed, param.add_spectators);
+  const bool           isNew = folds.Update(
+    source,
+    param.training_cuts,
+    FeatureCache::HashFile(opt.in_file),
+    opt.fold_dir + "/" + opt.in_tuple
+  );
+  std::cout << "    " << (isNew ? "Built" : "Reusing") << " " << folds.GetNFolds() << " folds of "
+            << folds.GetAssignment().size() << " events."
+            << std::endl;
+
+  // --------------------------------------------------------------------------
+  // train & apply folds
+  // --------------------------------------------------------------------------
+  TFile* output = new TFile(opt.out_file.data(), "recreate");
+
+  CrossValidate::Settings settings;
+  settings.name      = opt.name_tmva;
+  settings.directory = opt.out_dir;
+  settings.jobs      = opt.n_jobs;
+  settings.threads   = opt.n_threads;
+  settings.bins      = opt.n_bins;
+  settings.weight    = param.tree_weight;
+
+  const std::vector<CrossValidate::Result> results = CrossValidate::Run(train_helper, folds, settings, output);
+
+  // report mean & spread of fold scores
+  std::cout << "    Cross-validated " << results.size() << " outputs:" << std::endl;
+  for (const CrossValidate::Result& result : results) {
+    if (result.resolutions.empty()) {
+      std::cout << "      " << result.output << ": no fold finished!" << std::endl;
+      continue;
+    }
+
+    double mean = 0.;
+    double rms  = 0.;
+    for (const double resolution : result.resolutions) {
+      mean += resolution;
+      rms  += resolution * resolution;
+    }
+    mean /= result.resolutions.size();
+    rms   = std::sqrt(std::max((rms / result.resolutions.size()) - (mean * mean), 0.));
+
+    std::cout << "      " << result.output << ": resolution = " << result.resolution
+              << " (folds: " << mean << " +- " << rms << "), non-linearity = " << result.linearity
+              << std::endl;
+  }
+
+  // clean up & exit
+  output -> Close();
+  input  -> Close();
+  std::cout << "    Wrote out-of-fold estimates to " << opt.out_file << "\n"
+            << "  Finished calibration cross-validation!\n"
+            << std::endl;
+  return;
+
+}
+
+// end ========================================================================
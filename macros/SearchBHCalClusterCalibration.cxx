@@ -0,0 +1,172 @@
+/// ===========================================================================
+/*! \file   SearchBHCalClusterCalibration.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to search the options of the
+ *  calibration methods instead of tuning them by
+ *  hand. Each method in the list of parameter spaces
+ *  is trained once per configuration (grid, random,
+ *  or successive halving search) in parallel worker
+ *  processes, and every trial's resolution,
+ *  linearity, and training time are written to a
+ *  table. Options not searched over are taken from
+ *  TMVAClusterParameters.hxx.
+ */
+/// ===========================================================================
+
+#define SearchBHCalClusterCalibration_cxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TSystem.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/HyperSearch.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/PreparedDataset.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;      // input calibration tuple
+  std::string in_tuple;     // name of input tuple
+  std::string out_table;    // output table of trials
+  std::string out_dir;      // directory to run trials in
+  std::string name_tmva;    // name of TMVA process
+  std::string prep_dir;     // directory for prepared train/test datasets
+  std::string strategy;     // search strategy ("grid", "random", "halving")
+  std::size_t n_jobs;       // number of trials to run at once
+  std::size_t n_trials;     // number of configurations per method (random search)
+  double      budget;       // wall-clock budget in seconds (0 = none)
+  double      screen;       // fraction of training events to screen on (grid/random, 0 = off)
+  std::vector<HyperSearch::Space> spaces;  // options to search per method
+} DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "search.txt",
+  "tmva_search",
+  "TMVARegression",
+  "prepared",
+  "halving",
+  8,
+  20,
+  0.,
+  0.,
+  {
+    {
+      "BDTG",
+      {
+        {"NTrees",    {"500", "1000", "2000"}},
+        {"Shrinkage", {"0.05", "0.1", "0.3"}},
+        {"MaxDepth",  {"3", "4", "5"}}
+      }
+    },
+    {
+      "MLP",
+      {
+        {"HiddenLayers", {"N", "N+10", "N+20", "N,N"}},
+        {"NCycles",      {"2000", "5000", "20000"}}
+      }
+    }
+  }
+};
+
+
+
+// ============================================================================
+//! Search options of calibration methods
+// ============================================================================
+void SearchBHCalClusterCalibration(const Options& opt = DefaultOptions) {
+
+  // announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning calibration option search..." << std::endl;
+
+  // set up helpers
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters();
+  TMVAHelper::Trainer    train_helper( param.variables, param.methods );
+  train_helper.SetFactoryOptions(param.opts_factory);
+  train_helper.SetTrainOptions(param.opts_training);
+
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+
+  // prepare (or reuse) the train/test split every
+  // trial is run on
+  TFile* input = new TFile(opt.in_file.data(), "read");
+  if (!input || input -> IsZombie()) {
+    std::cerr << "PANIC: couldn't open input file '" << opt.in_file << "'!" << std::endl;
+    assert(input && !input -> IsZombie());
+  }
+  gSystem -> mkdir(opt.prep_dir.data(), true);
+
+  NTupleIO::Reader source(in_helper, input, opt.in_tuple);
+  PreparedDataset  prepared(train_helper);
+  const bool       isNew = prepared.Update(
+    source,
+    param.training_cuts,
+    FeatureCache::HashFile(opt.in_file),
+    opt.prep_dir + "/" + opt.in_tuple + ".prep"
+  );
+  train_helper.SetTrainOptions( prepared.GetTrainingOptions() );
+  std::cout << "    " << (isNew ? "Built" : "Reusing") << " prepared dataset:\n"
+            << "      train = " << prepared.GetTrain().GetRows() << " rows\n"
+            << "      test  = " << prepared.GetTest().GetRows() << " rows"
+            << std::endl;
+
+  // --------------------------------------------------------------------------
+  // run search
+  // --------------------------------------------------------------------------
+  HyperSearch::Settings settings;
+  settings.name      = opt.name_tmva;
+  settings.directory = opt.out_dir;
+  settings.strategy  = HyperSearch::ParseStrategy(opt.strategy);
+  settings.trials    = opt.n_trials;
+  settings.jobs      = opt.n_jobs;
+  settings.budget    = opt.budget;
+  settings.screen    = opt.screen;
+  settings.weight    = param.tree_weight;
+
+  const std::vector<HyperSearch::Trial> trials = HyperSearch::Run(train_helper, prepared, opt.spaces, settings);
+
+  // write out table & report best options
+  std::ofstream table(opt.out_table);
+  HyperSearch::WriteTable(trials, table);
+  std::cout << "    Ran " << trials.size() << " trials, wrote table to " << opt.out_table << std::endl;
+  for (const HyperSearch::Space& space : opt.spaces) {
+    const HyperSearch::Trial best = HyperSearch::GetBest(trials, space.method);
+    if (best.status != HyperSearch::Status::Done) {
+      std::cout << "      " << space.method << ": no trial finished on all events!" << std::endl;
+      continue;
+    }
+    std::cout << "      " << space.method << ": best score = " << best.score
+              << " (resolution = " << best.resolution << ", linearity = " << best.linearity << ")\n"
+              << "        options = " << best.options
+              << std::endl;
+  }
+
+  // clean up & exit
+  input -> Close();
+  std::cout << "  Finished calibration option search!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,183 @@
+/// ===========================================================================
+/*! \file   TestFeatureCache.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A self-checking ROOT macro for feature caches.
+ *  Random rows are written to a cache in both
+ *  layouts & read back, a builder that's never
+ *  closed has to leave an existing cache alone, and
+ *  a cache built from a small tuple by
+ *  NTupleIO::UpdateCache has to be reused for the
+ *  same key & rebuilt for a stale one (different
+ *  source hash or cut). Returns how many checks
+ *  failed.
+ */
+/// ===========================================================================
+
+#define TestFeatureCache_cxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+// root libraries
+#include <TCut.h>
+#include <TFile.h>
+// analysis utilities
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TestChecks.hxx"
+#include "../../utility/TestEvents.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string out_label;  // label for scratch files
+  std::size_t rows;       // no. of rows to write
+  uint64_t    seed;       // seed for random values
+} DefaultOptions = {
+  "testFeatureCache",
+  10000,
+  100
+};
+
+
+
+// ============================================================================
+//! Check feature caches round trip & go stale
+// ============================================================================
+int TestFeatureCache(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning feature cache test..." << std::endl;
+
+  TestChecks checks("feature cache");
+
+  // random rows to write
+  const std::vector<std::string>        variables = TestEvents::Columns;
+  const std::vector<std::vector<float>> rows      = TestEvents::Make(opt.rows, opt.seed);
+
+  // --------------------------------------------------------------------------
+  // round trip in both layouts
+  // --------------------------------------------------------------------------
+  for (const FeatureCache::Layout layout : {FeatureCache::Layout::Row, FeatureCache::Layout::Column}) {
+
+    const std::string name = (layout == FeatureCache::Layout::Row) ? "row" : "column";
+    const std::string path = opt.out_label + "." + name + ".fcache";
+    {
+      FeatureCache::Builder builder(path, variables, 42, "x0 > 0", layout);
+      for (const std::vector<float>& row : rows) builder.Append(row);
+      checks.Check(builder.Close(), "wrote " + name + "-major cache");
+    }
+
+    FeatureCache cache;
+    checks.Check(cache.Open(path), "opened " + name + "-major cache");
+    checks.Check(cache.Matches(42, variables, "x0 > 0"), name + "-major cache matches its key");
+    checks.Check(!cache.Matches(43, variables, "x0 > 0"), name + "-major cache doesn't match another source");
+    checks.Check(!cache.Matches(42, variables, "x0 > 1"), name + "-major cache doesn't match another cut");
+    checks.Check((cache.GetRows() == rows.size()) && (cache.GetCols() == variables.size()), name + "-major cache has every row & column");
+
+    bool isSame = (cache.GetRows() == rows.size());
+    for (std::size_t iRow = 0; isSame && (iRow < rows.size()); ++iRow) {
+      for (std::size_t iCol = 0; iCol < variables.size(); ++iCol) {
+        const float expected = rows[iRow][iCol];
+        isSame &= (cache.GetValue(iRow, iCol) == expected);
+        isSame &= (layout == FeatureCache::Layout::Row)
+                ? (cache.GetRow(iRow)[iCol] == expected)
+                : (cache.GetColumn(iCol)[iRow] == expected);
+      }
+    }
+    checks.Check(isSame, name + "-major cache reads back every value");
+
+    // a builder that's never closed leaves the
+    // existing cache as is
+    {
+      FeatureCache::Builder abandoned(path, variables, 7, "", layout);
+      abandoned.Append(rows.front());
+    }
+    FeatureCache kept;
+    checks.Check(kept.Open(path) && kept.Matches(42, variables, "x0 > 0"), "abandoned builder left " + name + "-major cache alone");
+    checks.Check(!std::ifstream(path + ".tmp").good(), "abandoned builder left no temporary file");
+    cache.Close();
+    kept.Close();
+    std::remove(path.data());
+  }
+
+  // --------------------------------------------------------------------------
+  // reuse & rebuild a cache of a tuple
+  // --------------------------------------------------------------------------
+  const std::string tuple = opt.out_label + ".root";
+  const std::string path  = opt.out_label + ".tuple.fcache";
+  std::remove(path.data());
+  {
+    NTupleHelper helper(variables);
+    TFile*       output = new TFile(tuple.data(), "recreate");
+    {
+      NTupleIO::Writer writer(helper, output, "ntForTest", "Feature cache test");
+      for (const std::vector<float>& row : rows) {
+        helper.SetValues(row);
+        writer.Fill();
+      }
+      output -> cd();
+      writer.Write();
+    }
+    output -> Close();
+  }
+
+  NTupleHelper helper(variables);
+  TFile*       input = new TFile(tuple.data(), "read");
+  FeatureCache cache;
+  const TCut   all   = "";
+  const TCut   some  = "x1 > 0";
+
+  const bool isBuilt = NTupleIO::UpdateCache(cache, helper, input, "ntForTest", NTupleIO::Backend::Tree, all, 1, path);
+  checks.Check(isBuilt && (cache.GetRows() == rows.size()), "missing cache is built with every row");
+
+  bool isSame = (cache.GetRows() == rows.size());
+  for (std::size_t iRow = 0; isSame && (iRow < rows.size()); ++iRow) {
+    for (std::size_t iCol = 0; iCol < variables.size(); ++iCol) {
+      isSame &= (cache.GetValue(iRow, iCol) == rows[iRow][iCol]);
+    }
+  }
+  checks.Check(isSame, "cache of tuple holds the tuple's values");
+
+  const bool isReused = !NTupleIO::UpdateCache(cache, helper, input, "ntForTest", NTupleIO::Backend::Tree, all, 1, path);
+  checks.Check(isReused && cache.Matches(1, variables, ""), "cache is reused for the same key");
+
+  const bool isRehashed = NTupleIO::UpdateCache(cache, helper, input, "ntForTest", NTupleIO::Backend::Tree, all, 2, path);
+  checks.Check(isRehashed && (cache.GetSourceHash() == 2), "cache of a stale source is rebuilt");
+
+  uint64_t nPassing = 0;
+  for (const std::vector<float>& row : rows) {
+    if (row[2] > 0.) ++nPassing;
+  }
+  const bool isRecut = NTupleIO::UpdateCache(cache, helper, input, "ntForTest", NTupleIO::Backend::Tree, some, 2, path);
+  checks.Check(isRecut && (cache.GetCut() == some.GetTitle()) && (cache.GetRows() == nPassing), "cache with a stale cut is rebuilt");
+
+  FeatureCache unwritable;
+  NTupleIO::UpdateCache(unwritable, helper, input, "ntForTest", NTupleIO::Backend::Tree, all, 1, path + ".missing/cache");
+  checks.Check(!unwritable.IsOpen(), "cache that can't be written is left closed");
+
+  // clean up
+  cache.Close();
+  input -> Close();
+  std::remove(path.data());
+  std::remove(tuple.data());
+
+  // announce end & exit
+  const std::size_t nFailed = checks.Report();
+  std::cout << "  Finished feature cache test!\n" << std::endl;
+  return nFailed;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,236 @@
+/// ===========================================================================
+/*! \file   TestHistBoost.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A self-checking ROOT macro for HistBDTG. A forest
+ *  is trained by HistBoost on random events with a
+ *  fixed seed, & written as a TMVA BDT. Read back
+ *  through TMVA::Reader (and NativeModel::Forest),
+ *  it has to give the same estimates on held-out
+ *  events as walking the trained trees directly.
+ *  Training with one thread or several has to give
+ *  the same forest, and every leaf response has to
+ *  be finite. Returns 0 if every check passed.
+ */
+/// ===========================================================================
+
+#define TestHistBoost_cxx
+
+// c++ utilities
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TSystem.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/HistBoost.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/TestChecks.hxx"
+#include "../../utility/TestEvents.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string out_label;   // label for scratch files & tmva directory
+  std::string name_tmva;   // name of TMVA process
+  std::string options;     // HistBDTG options
+  std::size_t n_train;     // no. of training events
+  std::size_t n_test;      // no. of testing events
+  std::size_t threads;     // no. of threads to compare a single thread with
+  std::size_t block_size;  // no. of entries per block
+  uint64_t    seed;        // seed for random events
+  double      tolerance;   // max relative difference allowed
+} DefaultOptions = {
+  "testHistBoost",
+  "TMVARegression",
+  "NTrees=100:MaxDepth=3:Shrinkage=0.1:UseBaggedBoost:BaggedSampleFraction=0.5:MaxBins=64",
+  20000,
+  2000,
+  4,
+  512,
+  100,
+  1e-5
+};
+
+
+
+// ============================================================================
+//! Walk a trained forest
+// ============================================================================
+/*! Events go to the second child of a node iff
+ *  x >= cut, as written to the weights.
+ */
+double Evaluate(const HistBoost::Forest& forest, std::span<const float> row) {
+
+  double estimate = forest.offset;
+  for (const HistBoost::Tree& tree : forest.trees) {
+    int32_t node = 0;
+    while (tree.feature[node] >= 0) {
+      node = tree.child[node] + (row[tree.feature[node] + 1] >= tree.cut[node]);
+    }
+    estimate += tree.response[node];
+  }
+  return estimate;
+
+}  // end 'Evaluate(HistBoost::Forest&, std::span<const float>)'
+
+
+
+// ============================================================================
+//! Check a HistBoost forest read back through TMVA
+// ============================================================================
+int TestHistBoost(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning HistBoost test..." << std::endl;
+
+  TestChecks checks("HistBoost");
+
+  // --------------------------------------------------------------------------
+  // train on a single thread & on several
+  // --------------------------------------------------------------------------
+  const std::vector<std::string> columns = TestEvents::Columns;
+  const std::vector<std::pair<TMVAHelper::Use, std::string>> inputs = {
+    {TMVAHelper::Use::Target, "y"},
+    {TMVAHelper::Use::Train,  "x0"},
+    {TMVAHelper::Use::Train,  "x1"},
+    {TMVAHelper::Use::Train,  "x2"}
+  };
+  const std::vector<std::pair<std::string, std::string>> methods = {
+    {"HistBDTG", opt.options}
+  };
+
+  HistBoost::Data data;
+  data.target    = columns.front();
+  data.variables = std::vector<std::string>(columns.begin() + 1, columns.end());
+  data.columns.resize(data.variables.size());
+  for (const std::vector<float>& row : TestEvents::Make(opt.n_train, opt.seed)) {
+    data.values.push_back(row[0]);
+    for (std::size_t iVar = 0; iVar < data.variables.size(); ++iVar) {
+      data.columns[iVar].push_back(row[iVar + 1]);
+    }
+  }
+
+  HistBoost::Config config = HistBoost::ParseConfig(opt.options);
+  config.threads = 1;
+  HistBoost::Booster      single(config);
+  const HistBoost::Forest forest = single.Train(data);
+
+  config.threads = opt.threads;
+  HistBoost::Booster      several(config);
+  const HistBoost::Forest other = several.Train(data);
+
+  bool isSame = (forest.trees.size() == other.trees.size()) && (forest.offset == other.offset);
+  for (std::size_t iTree = 0; isSame && (iTree < forest.trees.size()); ++iTree) {
+    isSame &= (forest.trees[iTree].feature == other.trees[iTree].feature)
+           && (forest.trees[iTree].cut == other.trees[iTree].cut)
+           && (forest.trees[iTree].response == other.trees[iTree].response);
+  }
+  checks.Check(!forest.trees.empty(), "trained " + std::to_string(forest.trees.size()) + " trees");
+  checks.Check(isSame, "1 & " + std::to_string(opt.threads) + " threads train the same forest");
+
+  bool isFinite = std::isfinite(forest.offset);
+  for (const HistBoost::Tree& tree : forest.trees) {
+    for (const double response : tree.response) {
+      isFinite &= std::isfinite(response);
+    }
+  }
+  checks.Check(isFinite, "every response is finite");
+
+  // write weights where TMVAHelper looks for them
+  const std::string directory = opt.out_label + "/weights";
+  const std::string weights   = directory + "/" + opt.name_tmva + "_HistBDTG.weights.xml";
+  gSystem -> mkdir(directory.data(), true);
+  checks.Check(HistBoost::WriteWeights(weights, "HistBDTG", data, config, forest), "wrote weights");
+
+  // --------------------------------------------------------------------------
+  // read back both ways & compare with the forest
+  // --------------------------------------------------------------------------
+  const std::vector<std::vector<float>> rows = TestEvents::Make(opt.n_test, opt.seed + 1);
+  const std::string                     path = opt.out_label + ".test.fcache";
+
+  // the same events, written where the readers can see them
+  FeatureCache test;
+  const bool   isOpen = TestEvents::Write(path, opt.n_test, opt.seed + 1) && test.Open(path);
+  if (!isOpen) {
+    std::cerr << "PANIC: couldn't write testing events!" << std::endl;
+    assert(isOpen);
+  }
+  NTupleHelper     testHelper(columns);
+  NTupleIO::Reader testSource(testHelper, test, "ntTest");
+
+  TMVAHelper::Reader tmva_helper(inputs, methods);
+  TMVAHelper::Reader native_helper(inputs, methods);
+  tmva_helper.SetOptions({"!Color", "Silent"});
+  native_helper.SetOptions({"!Color", "Silent"});
+  native_helper.SetUseNative(true);
+
+  TMVA::Tools::Instance();
+  TMVA::Reader* tmva   = new TMVA::Reader(tmva_helper.CompressOptions().data());
+  TMVA::Reader* native = new TMVA::Reader(native_helper.CompressOptions().data());
+  tmva_helper.ReadVariables(tmva, testHelper);
+  native_helper.ReadVariables(native, testHelper);
+  tmva_helper.BookMethodsToRead(tmva, opt.out_label, opt.name_tmva);
+  native_helper.BookMethodsToRead(native, opt.out_label, opt.name_tmva);
+  checks.Check(native_helper.GetNative(0) != nullptr, "weights load natively");
+
+  // n.b. the estimate follows the target
+  double            maxTMVA   = 0.;
+  double            maxNative = 0.;
+  uint64_t          nTMVA     = 0;
+  uint64_t          nNative   = 0;
+  uint64_t          iEntry    = 0;
+  NTupleBlockReader blocks(testSource, opt.block_size);
+  while (blocks.Next()) {
+    tmva_helper.EvaluateMethods(tmva, testHelper, blocks);
+    native_helper.EvaluateMethods(native, testHelper, blocks);
+
+    std::span<const float> fromTMVA   = tmva_helper.GetColumn(1);
+    std::span<const float> fromNative = native_helper.GetColumn(1);
+    for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow, ++iEntry) {
+      const double expected   = Evaluate(forest, rows[iEntry]);
+      const double scale      = std::max(std::abs(expected), 1e-12);
+      const double diffTMVA   = std::abs(fromTMVA[iRow] - expected) / scale;
+      const double diffNative = std::abs(fromNative[iRow] - expected) / scale;
+      maxTMVA   = std::max(maxTMVA, diffTMVA);
+      maxNative = std::max(maxNative, diffNative);
+      if (!(diffTMVA <= opt.tolerance))   ++nTMVA;
+      if (!(diffNative <= opt.tolerance)) ++nNative;
+    }
+  }  // end block loop
+  checks.Check(!blocks.HasError(), "every test entry is read");
+  checks.Check(nTMVA == 0, "TMVA::Reader matches the forest (max rel. diff = " + std::to_string(maxTMVA) + ")");
+  checks.Check(nNative == 0, "NativeModel::Forest matches the forest (max rel. diff = " + std::to_string(maxNative) + ")");
+
+  // clean up
+  delete tmva;
+  delete native;
+  test.Close();
+  std::remove(path.data());
+
+  // announce end & exit
+  const std::size_t nFailed = checks.Report();
+  std::cout << "  Finished HistBoost test!\n" << std::endl;
+  return nFailed;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,208 @@
+/// ===========================================================================
+/*! \file   TestNativeBackends.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A self-checking ROOT macro for the native
+ *  evaluators. A small BDTG, MLP, & KNN are trained
+ *  on random events with fixed seeds, and their
+ *  weight files are evaluated on held-out events by
+ *  TMVA::Reader & by NativeModel::Forest, Network, &
+ *  NearestNeighbors. Every method has to load
+ *  natively & agree with TMVA within the tolerance.
+ *  Unlike ValidateNativeBackends.cxx, this needs no
+ *  input or earlier training. The no. of failed
+ *  checks is returned.
+ */
+/// ===========================================================================
+
+#define TestNativeBackends_cxx
+
+// c++ utilities
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TFile.h>
+#include <TTree.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Types.h>
+#include <TMVA/Reader.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/TestChecks.hxx"
+#include "../../utility/TestEvents.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string out_label;   // label for scratch files & tmva directory
+  std::string name_tmva;   // name of TMVA process
+  std::size_t n_train;     // no. of training events
+  std::size_t n_test;      // no. of testing events
+  std::size_t block_size;  // no. of entries per block
+  uint64_t    seed;        // seed for random events
+  double      tolerance;   // max relative difference allowed
+} DefaultOptions = {
+  "testNativeBackends",
+  "TMVARegression",
+  5000,
+  2000,
+  512,
+  100,
+  1e-5
+};
+
+
+
+// ============================================================================
+//! Check native evaluators against TMVA::Reader
+// ============================================================================
+int TestNativeBackends(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning native backend test..." << std::endl;
+
+  TestChecks checks("native backend");
+
+  // --------------------------------------------------------------------------
+  // make events & train
+  // --------------------------------------------------------------------------
+  const std::vector<std::string> columns = TestEvents::Columns;
+  const std::vector<std::pair<TMVAHelper::Use, std::string>> inputs = {
+    {TMVAHelper::Use::Target, "y"},
+    {TMVAHelper::Use::Train,  "x0"},
+    {TMVAHelper::Use::Train,  "x1"},
+    {TMVAHelper::Use::Train,  "x2"}
+  };
+  const std::vector<std::pair<std::string, std::string>> methods = {
+    {"BDTG", "!H:!V:NTrees=100:BoostType=Grad:Shrinkage=0.1:UseBaggedBoost:BaggedSampleFraction=0.5:nCuts=20:MaxDepth=3"},
+    {"MLP",  "!H:!V:VarTransform=Norm:NeuronType=tanh:NCycles=100:HiddenLayers=N+3:TestRate=10:TrainingMethod=BFGS:!UseRegulator"},
+    {"KNN",  "nkNN=20:ScaleFrac=0.8:SigmaFact=1.0:Kernel=Gaus:UseKernel=F:UseWeight=T:!Trim"}
+  };
+
+  const std::string trainPath = opt.out_label + ".train.fcache";
+  const std::string testPath  = opt.out_label + ".test.fcache";
+  FeatureCache      trainCache;
+  FeatureCache      testCache;
+  const bool        isMade = TestEvents::Write(trainPath, opt.n_train, opt.seed)
+                          && TestEvents::Write(testPath, opt.n_test, opt.seed + 1)
+                          && trainCache.Open(trainPath)
+                          && testCache.Open(testPath);
+  if (!isMade) {
+    std::cerr << "PANIC: couldn't write random events!" << std::endl;
+    assert(isMade);
+  }
+
+  NTupleHelper     trainHelper(columns);
+  NTupleHelper     testHelper(columns);
+  NTupleIO::Reader trainSource(trainHelper, trainCache, "ntTrain");
+  NTupleIO::Reader testSource(testHelper, testCache, "ntTest");
+
+  TMVAHelper::Trainer trainer(inputs, methods);
+  trainer.SetFactoryOptions({"!V", "Silent", "!Color", "!DrawProgressBar", "AnalysisType=Regression"});
+  trainer.SetTrainOptions({"nTrain_Regression=0", "nTest_Regression=0", "SplitMode=Block", "!V"});
+
+  TMVA::Tools::Instance();
+  TFile*            output  = TFile::Open((opt.out_label + ".root").data(), "recreate");
+  TMVA::Factory*    factory = new TMVA::Factory(opt.name_tmva.data(), output, trainer.CompressFactoryOptions().data());
+  TMVA::DataLoader* loader  = new TMVA::DataLoader(opt.out_label.data());
+  trainer.LoadVariables(loader);
+  loader -> AddRegressionTree(trainSource.GetTree(), 1.0, TMVA::Types::kTraining);
+  loader -> AddRegressionTree(testSource.GetTree(), 1.0, TMVA::Types::kTesting);
+  loader -> PrepareTrainingAndTestTree("", trainer.CompressTrainingOptions().data());
+  trainer.BookMethodsToTrain(factory, loader);
+  factory -> TrainAllMethods();
+  output -> Close();
+  delete factory;
+  delete loader;
+  std::cout << "    Trained " << methods.size() << " methods on " << opt.n_train << " events." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // book weights both ways
+  // --------------------------------------------------------------------------
+  TMVAHelper::Reader tmva_helper(inputs, methods);
+  TMVAHelper::Reader native_helper(inputs, methods);
+  tmva_helper.SetOptions({"!Color", "Silent"});
+  native_helper.SetOptions({"!Color", "Silent"});
+  native_helper.SetUseNative(true);
+
+  TMVA::Reader* tmva   = new TMVA::Reader(tmva_helper.CompressOptions().data());
+  TMVA::Reader* native = new TMVA::Reader(native_helper.CompressOptions().data());
+  tmva_helper.ReadVariables(tmva, testHelper);
+  native_helper.ReadVariables(native, testHelper);
+  tmva_helper.BookMethodsToRead(tmva, opt.out_label, opt.name_tmva);
+  native_helper.BookMethodsToRead(native, opt.out_label, opt.name_tmva);
+  for (std::size_t iMethod = 0; iMethod < methods.size(); ++iMethod) {
+    checks.Check(native_helper.GetNative(iMethod) != nullptr, "'" + methods[iMethod].first + "' is evaluated natively");
+  }
+
+  // --------------------------------------------------------------------------
+  // evaluate every block both ways & compare
+  // --------------------------------------------------------------------------
+  const std::size_t     nTargets = tmva_helper.GetTargets().size();
+  std::vector<double>   maxRel(methods.size(), 0.);
+  std::vector<uint64_t> nBad(methods.size(), 0);
+  NTupleBlockReader     blocks(testSource, opt.block_size);
+  while (blocks.Next()) {
+    tmva_helper.EvaluateMethods(tmva, testHelper, blocks);
+    native_helper.EvaluateMethods(native, testHelper, blocks);
+    for (std::size_t iMethod = 0; iMethod < methods.size(); ++iMethod) {
+      for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+
+        // outputs of a method follow its targets
+        const std::size_t      iOut     = nTargets + (iMethod * nTargets) + iTarget;
+        std::span<const float> expected = tmva_helper.GetColumn(iOut);
+        std::span<const float> observed = native_helper.GetColumn(iOut);
+        for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+          const double diff  = std::abs(observed[iRow] - expected[iRow]);
+          const double scale = std::max(std::abs((double) expected[iRow]), 1e-12);
+          maxRel[iMethod] = std::max(maxRel[iMethod], diff / scale);
+          if (!(diff / scale <= opt.tolerance)) ++nBad[iMethod];
+        }
+      }
+    }
+  }  // end block loop
+  checks.Check(!blocks.HasError(), "every test entry is read");
+
+  for (std::size_t iMethod = 0; iMethod < methods.size(); ++iMethod) {
+    checks.Check(
+      nBad[iMethod] == 0,
+      "'" + methods[iMethod].first + "' matches TMVA on " + std::to_string(opt.n_test)
+        + " events (max rel. diff = " + std::to_string(maxRel[iMethod]) + ")"
+    );
+  }
+
+  // clean up
+  delete tmva;
+  delete native;
+  trainCache.Close();
+  testCache.Close();
+  std::remove(trainPath.data());
+  std::remove(testPath.data());
+
+  // announce end & exit
+  const std::size_t nFailed = checks.Report();
+  std::cout << "  Finished native backend test!\n" << std::endl;
+  return nFailed;
+
+}
+
+// end ========================================================================
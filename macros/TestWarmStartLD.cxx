@@ -0,0 +1,234 @@
+/// ===========================================================================
+/*! \file   TestWarmStartLD.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A self-checking ROOT macro for continuing LD
+ *  trainings. Two samples of random events are
+ *  written separately & joined with
+ *  WarmStart::WriteSamples; TMVA's LD is trained
+ *  on the union, while WarmStart::SolveCoefficients
+ *  solves with the summed WarmStart::GetSums of each
+ *  sample. Both have to give the same estimates on
+ *  held-out events, directly & once the solved
+ *  coefficients are put into the weights file by
+ *  WarmStart::SetCoefficients. Failed checks are
+ *  counted & returned.
+ */
+/// ===========================================================================
+
+#define TestWarmStartLD_cxx
+
+// c++ utilities
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+// root libraries
+#include <TFile.h>
+#include <TTree.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Types.h>
+#include <TMVA/Reader.h>
+#include <TMVA/Factory.h>
+#include <TMVA/DataLoader.h>
+// analysis utilities
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/WarmStart.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/TestChecks.hxx"
+#include "../../utility/TestEvents.hxx"
+#include "../../utility/FeatureCache.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string out_label;   // label for scratch files & tmva directory
+  std::string name_tmva;   // name of TMVA process
+  std::size_t n_sample;    // no. of events per sample
+  std::size_t n_test;      // no. of testing events
+  std::size_t block_size;  // no. of entries per block
+  uint64_t    seed;        // seed for random events
+  double      tolerance;   // max relative difference allowed
+} DefaultOptions = {
+  "testWarmStartLD",
+  "TMVARegression",
+  3000,
+  2000,
+  512,
+  100,
+  1e-4
+};
+
+
+
+// ============================================================================
+//! Check solved LD coefficients against a direct training
+// ============================================================================
+int TestWarmStartLD(const Options& opt = DefaultOptions) {
+
+  // announce start
+  std::cout << "\n  Beginning LD continuation test..." << std::endl;
+
+  TestChecks checks("LD continuation");
+
+  // --------------------------------------------------------------------------
+  // make samples & their union
+  // --------------------------------------------------------------------------
+  const std::vector<std::string> columns = TestEvents::Columns;
+  const std::size_t              nVars   = columns.size() - 1;
+  const std::vector<std::pair<TMVAHelper::Use, std::string>> inputs = {
+    {TMVAHelper::Use::Target, "y"},
+    {TMVAHelper::Use::Train,  "x0"},
+    {TMVAHelper::Use::Train,  "x1"},
+    {TMVAHelper::Use::Train,  "x2"}
+  };
+  const std::vector<std::pair<std::string, std::string>> methods = {
+    {"LD", "!H:!V:VarTransform=None"}
+  };
+
+  const std::string firstPath  = opt.out_label + ".first.fcache";
+  const std::string secondPath = opt.out_label + ".second.fcache";
+  const std::string unionPath  = opt.out_label + ".union.fcache";
+  const std::string testPath   = opt.out_label + ".test.fcache";
+  FeatureCache      first;
+  FeatureCache      second;
+  FeatureCache      joined;
+  FeatureCache      test;
+  const bool        isMade = TestEvents::Write(firstPath, opt.n_sample, opt.seed, TestEvents::Model::Linear, 0.)
+                          && TestEvents::Write(secondPath, opt.n_sample, opt.seed + 1, TestEvents::Model::Linear, 1.)
+                          && TestEvents::Write(testPath, opt.n_test, opt.seed + 2, TestEvents::Model::Linear, 0.5)
+                          && first.Open(firstPath)
+                          && second.Open(secondPath)
+                          && test.Open(testPath)
+                          && WarmStart::WriteSamples({&first, &second}, unionPath)
+                          && joined.Open(unionPath);
+  if (!isMade) {
+    std::cerr << "PANIC: couldn't write random events!" << std::endl;
+    assert(isMade);
+  }
+  checks.Check(joined.GetRows() == first.GetRows() + second.GetRows(), "union holds every event of both samples");
+
+  // --------------------------------------------------------------------------
+  // train LD directly on the union
+  // --------------------------------------------------------------------------
+  NTupleHelper     unionHelper(columns);
+  NTupleHelper     testHelper(columns);
+  NTupleIO::Reader unionSource(unionHelper, joined, "ntUnion");
+  NTupleIO::Reader testSource(testHelper, test, "ntTest");
+
+  TMVAHelper::Trainer trainer(inputs, methods);
+  trainer.SetFactoryOptions({"!V", "Silent", "!Color", "!DrawProgressBar", "AnalysisType=Regression"});
+  trainer.SetTrainOptions({"nTrain_Regression=0", "nTest_Regression=0", "SplitMode=Block", "!V"});
+
+  TMVA::Tools::Instance();
+  TFile*            output  = TFile::Open((opt.out_label + ".root").data(), "recreate");
+  TMVA::Factory*    factory = new TMVA::Factory(opt.name_tmva.data(), output, trainer.CompressFactoryOptions().data());
+  TMVA::DataLoader* loader  = new TMVA::DataLoader(opt.out_label.data());
+  trainer.LoadVariables(loader);
+  loader -> AddRegressionTree(unionSource.GetTree(), 1.0, TMVA::Types::kTraining);
+  loader -> AddRegressionTree(testSource.GetTree(), 1.0, TMVA::Types::kTesting);
+  loader -> PrepareTrainingAndTestTree("", trainer.CompressTrainingOptions().data());
+  trainer.BookMethodsToTrain(factory, loader);
+  factory -> TrainAllMethods();
+  output -> Close();
+  delete factory;
+  delete loader;
+
+  // --------------------------------------------------------------------------
+  // solve with the sums of each sample
+  // --------------------------------------------------------------------------
+  std::vector<double>       total = WarmStart::GetSums(first, nVars, 1.0);
+  const std::vector<double> sums  = WarmStart::GetSums(second, nVars, 1.0);
+  for (std::size_t iSum = 0; iSum < sums.size(); ++iSum) {
+    total[iSum] += sums[iSum];
+  }
+
+  std::vector<double> coefficients;
+  checks.Check(WarmStart::SolveCoefficients(total, nVars, coefficients), "summed system can be solved");
+  coefficients.resize(nVars + 1, 0.);
+
+  // put them into a copy of the trained weights
+  const std::string weights = opt.out_label + "/weights/" + opt.name_tmva + "_LD.weights.xml";
+  const std::string solved  = opt.out_label + "/weights/" + opt.name_tmva + "_LD.solved.weights.xml";
+  std::error_code   error;
+  std::filesystem::copy_file(weights, solved, std::filesystem::copy_options::overwrite_existing, error);
+  checks.Check(!error && WarmStart::SetCoefficients(solved, coefficients), "solved coefficients are written to a weights file");
+
+  // --------------------------------------------------------------------------
+  // compare estimates on the testing events
+  // --------------------------------------------------------------------------
+  TMVAHelper::Reader direct_helper(inputs, methods);
+  TMVAHelper::Reader solved_helper(inputs, methods);
+  direct_helper.SetOptions({"!Color", "Silent"});
+  solved_helper.SetOptions({"!Color", "Silent"});
+
+  TMVA::Reader* direct = new TMVA::Reader(direct_helper.CompressOptions().data());
+  TMVA::Reader* booked = new TMVA::Reader(solved_helper.CompressOptions().data());
+  direct_helper.ReadVariables(direct, testHelper);
+  solved_helper.ReadVariables(booked, testHelper);
+  direct_helper.BookMethodsToRead(direct, {weights});
+  solved_helper.BookMethodsToRead(booked, {solved});
+
+  // n.b. the estimate follows the target
+  double            maxDirect = 0.;
+  double            maxBooked = 0.;
+  uint64_t          nDirect   = 0;
+  uint64_t          nBooked   = 0;
+  NTupleBlockReader blocks(testSource, opt.block_size);
+  while (blocks.Next()) {
+    direct_helper.EvaluateMethods(direct, testHelper, blocks);
+    solved_helper.EvaluateMethods(booked, testHelper, blocks);
+
+    std::span<const float> expected = direct_helper.GetColumn(1);
+    std::span<const float> observed = solved_helper.GetColumn(1);
+    for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+      double estimate = coefficients[0];
+      for (std::size_t iVar = 0; iVar < nVars; ++iVar) {
+        estimate += coefficients[iVar + 1] * blocks.GetColumn(iVar + 1)[iRow];
+      }
+
+      const double scale      = std::max(std::abs((double) expected[iRow]), 1e-12);
+      const double diffDirect = std::abs(estimate - expected[iRow]) / scale;
+      const double diffBooked = std::abs(observed[iRow] - expected[iRow]) / scale;
+      maxDirect = std::max(maxDirect, diffDirect);
+      maxBooked = std::max(maxBooked, diffBooked);
+      if (!(diffDirect <= opt.tolerance)) ++nDirect;
+      if (!(diffBooked <= opt.tolerance)) ++nBooked;
+    }
+  }  // end block loop
+  checks.Check(!blocks.HasError(), "every test entry is read");
+  checks.Check(nDirect == 0, "solved coefficients match TMVA's LD (max rel. diff = " + std::to_string(maxDirect) + ")");
+  checks.Check(nBooked == 0, "weights with solved coefficients match TMVA's LD (max rel. diff = " + std::to_string(maxBooked) + ")");
+
+  // clean up
+  delete direct;
+  delete booked;
+  for (FeatureCache* cache : {&first, &second, &joined, &test}) {
+    cache -> Close();
+  }
+  for (const std::string& path : {firstPath, secondPath, unionPath, testPath, solved}) {
+    std::remove(path.data());
+  }
+
+  // announce end & exit
+  const std::size_t nFailed = checks.Report();
+  std::cout << "  Finished LD continuation test!\n" << std::endl;
+  return nFailed;
+
+}
+
+// end ========================================================================
@@ -28,7 +28,12 @@
 #include <TMVA/Factory.h>
 #include <TMVA/DataLoader.h>
 // analysis utilities
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/HistBoost.hxx"
 #include "../../utility/TMVAHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
 
 
 
@@ -63,59 +68,10 @@ void TrainBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   // --------------------------------------------------------------------------
 
   // input variables & usage
-  const std::vector<std::pair<TMVAHelper::Use, std::string>> vecUseAndVar = {
-    {TMVAHelper::Use::Target, "ePar"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBHCal"},
-    {TMVAHelper::Use::Watch, "fracParVsSumBEMC"},
-    {TMVAHelper::Use::Watch, "fracLeadBHCalVsBEMC"},
-    {TMVAHelper::Use::Watch, "fracSumBHCalVsBEMC"},
-    {TMVAHelper::Use::Train, "eLeadBHCal"},
-    {TMVAHelper::Use::Train, "eLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eSumBHCal"},
-    {TMVAHelper::Use::Watch, "eSumBEMC"},
-    {TMVAHelper::Use::Watch, "diffLeadBHCal"},
-    {TMVAHelper::Use::Watch, "diffLeadBEMC"},
-    {TMVAHelper::Use::Watch, "diffSumBHCal"},
-    {TMVAHelper::Use::Watch, "diffSumBEMC"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBHCal"},
-    {TMVAHelper::Use::Watch, "nHitsLeadBEMC"},
-    {TMVAHelper::Use::Watch, "nClustBHCal"},
-    {TMVAHelper::Use::Watch, "nClustBEMC"},
-    {TMVAHelper::Use::Watch, "hLeadBHCal"},
-    {TMVAHelper::Use::Watch, "hLeadBEMC"},
-    {TMVAHelper::Use::Watch, "fLeadBHCal"},
-    {TMVAHelper::Use::Watch, "fLeadBEMC"},
-    {TMVAHelper::Use::Watch, "eLeadImage"},
-    {TMVAHelper::Use::Watch, "eSumImage"},
-    {TMVAHelper::Use::Watch, "eLeadScFi"},
-    {TMVAHelper::Use::Watch, "eSumScFi"},
-    {TMVAHelper::Use::Watch, "nClustImage"},
-    {TMVAHelper::Use::Watch, "nClustScFi"},
-    {TMVAHelper::Use::Watch, "hLeadImage"},
-    {TMVAHelper::Use::Watch, "hLeadScFi"},
-    {TMVAHelper::Use::Watch, "fLeadImage"},
-    {TMVAHelper::Use::Watch, "fLeadScFi"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer1"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer2"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer3"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer4"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer5"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer6"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer7"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer8"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer9"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer10"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer11"},
-    {TMVAHelper::Use::Train, "eSumScFiLayer12"},
-    {TMVAHelper::Use::Train, "eSumImageLayer1"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer2"},
-    {TMVAHelper::Use::Train, "eSumImageLayer3"},
-    {TMVAHelper::Use::Train, "eSumImageLayer4"},
-    {TMVAHelper::Use::Watch, "eSumImageLayer5"},
-    {TMVAHelper::Use::Train, "eSumImageLayer6"}
-  };
+  //   - n.b. every variable of the tuple schema, with
+  //     the usage set in TMVAClusterParameters.hxx
+  const std::vector<std::pair<TMVAHelper::Use, std::string>> vecUseAndVar = TMVAClusterParameters::GetUseAndVar();
+
 
   // methods to use
   //   - TODO might be good to add field for method-specific options
@@ -231,9 +187,31 @@ void TrainBHCalClusterCalibration(const Options& opt = DefaultOptions) {
   factory -> TrainAllMethods();
   factory -> TestAllMethods();
   factory -> EvaluateAllMethods();
-  std::cout << "      Trained models.\n"
-            << "    Finished training calibration models!"
-            << endl;
+  std::cout << "      Trained models." << std::endl;
+
+  // train native methods on the same tuple, their
+  // weights are read like any other BDT's
+  //   - n.b. TMVA's train/test split isn't applied
+  //     to them
+  //   - n.b. vecMethods lists no native method as is,
+  //     so add e.g. "HistBDTG" there to train one
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : vecUseAndVar) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper     in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+  NTupleIO::Reader source(in_helper, input, opt.in_tuple);
+
+  HistBoost::Settings settings;
+  settings.name      = opt.name_tmva;
+  settings.directory = opt.out_tmva;
+  for (const std::string& method : vecMethods) {
+    if (!TMVAHelper::IsNative(method)) continue;
+    if (HistBoost::Run(train_helper, source, trainCut, settings, method).empty()) {
+      std::cerr << "WARNING: training '" << method << "' failed!" << std::endl;
+    }
+  }
+  std::cout << "    Finished training calibration models!" << endl;
 
   // --------------------------------------------------------------------------
   // Close I/O and exit
@@ -0,0 +1,199 @@
+/// ===========================================================================
+/*! \file   ValidateNativeBackends.cxx
+ *  \author Derek Anderson
+ *  \date   10.16.2026
+ *
+ *  A ROOT macro to check native evaluators against
+ *  TMVA::Reader. Every entry of a calibration tuple
+ *  is evaluated block by block both ways, and for
+ *  each method that can be evaluated natively the
+ *  largest absolute & relative differences, the
+ *  number of entries outside the tolerance, and the
+ *  time spent in each backend are reported.
+ *  Covers every method with a native evaluator
+ *  (BDTG, MLP, KNN). Optionally, standalone C++ sources
+ *  are generated for the forests.
+ *
+ *  Needs weights from a previous training (see
+ *  TrainAndApplyBHCalClusterCalibration.cxx).
+ */
+/// ===========================================================================
+
+#define ValidateNativeBackends_cxx
+
+// c++ utilities
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TFile.h>
+// tmva components
+#include <TMVA/Tools.h>
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "../NTupleClusterSchema.hxx"
+#include "../TMVAClusterParameters.hxx"
+#include "../../utility/NTupleIO.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/NativeForest.hxx"
+#include "../../utility/NTupleBlockReader.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;     // input calibration tuple
+  std::string in_tuple;    // name of input tuple
+  std::string out_tmva;    // tmva directory holding weights
+  std::string name_tmva;   // name of TMVA process
+  std::string out_source;  // prefix for generated sources (leave empty to skip)
+  std::size_t block_size;  // no. of entries per block
+  double      tolerance;   // max relative difference allowed
+} DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "tmva_test",
+  "TMVARegression",
+  "",
+  4096,
+  1e-5
+};
+
+
+
+// ============================================================================
+//! Validate native evaluators against TMVA
+// ============================================================================
+void ValidateNativeBackends(const Options& opt = DefaultOptions) {
+
+  // announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning native backend validation..." << std::endl;
+
+  // set up helpers
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters();
+  TMVAHelper::Reader     tmva_helper( param.variables, param.methods );
+  TMVAHelper::Reader     native_helper( param.variables, param.methods );
+  tmva_helper.SetOptions(param.opts_reading);
+  native_helper.SetOptions(param.opts_reading);
+  native_helper.SetUseNative(true);
+
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+  NTupleHelper in_helper( inputs, NTupleClusterSchema::GetBranches(inputs) );
+
+  // book methods both ways
+  TMVA::Tools::Instance();
+  TMVA::Reader* tmva   = new TMVA::Reader(tmva_helper.CompressOptions().data());
+  TMVA::Reader* native = new TMVA::Reader(native_helper.CompressOptions().data());
+  tmva_helper.ReadVariables(tmva, in_helper);
+  native_helper.ReadVariables(native, in_helper);
+  tmva_helper.BookMethodsToRead(tmva, opt.out_tmva, opt.name_tmva);
+  native_helper.BookMethodsToRead(native, opt.out_tmva, opt.name_tmva);
+
+  // collect methods evaluated natively
+  std::vector<std::size_t> methods;
+  for (std::size_t iMethod = 0; iMethod < param.methods.size(); ++iMethod) {
+    if (!native_helper.GetNative(iMethod)) continue;
+    methods.push_back(iMethod);
+    std::cout << "    Evaluating '" << param.methods[iMethod].first << "' natively." << std::endl;
+  }
+  if (methods.empty()) {
+    std::cout << "    No methods can be evaluated natively! Exiting." << std::endl;
+    return;
+  }
+
+  // generate sources if needed
+  for (const std::size_t iMethod : methods) {
+    auto forest = std::dynamic_pointer_cast<const NativeModel::Forest>( native_helper.GetNative(iMethod) );
+    if (!forest || opt.out_source.empty()) continue;
+
+    const std::string method = param.methods[iMethod].first;
+    const std::string path   = opt.out_source + "." + method + ".cxx";
+    if (forest -> WriteSource(path, "Evaluate" + method)) {
+      std::cout << "    Wrote " << forest -> GetNTrees() << " trees of '" << method << "' to " << path << std::endl;
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // evaluate every block both ways & compare
+  // --------------------------------------------------------------------------
+  const std::size_t nTargets = tmva_helper.GetTargets().size();
+  const std::size_t nMethods = methods.size();
+
+  std::vector<double>   maxAbs(nMethods, 0.);
+  std::vector<double>   maxRel(nMethods, 0.);
+  std::vector<uint64_t> nBad(nMethods, 0);
+  double                tmvaTime   = 0.;
+  double                nativeTime = 0.;
+
+  TFile*            input = new TFile(opt.in_file.data(), "read");
+  NTupleIO::Reader  source(in_helper, input, opt.in_tuple);
+  NTupleBlockReader blocks(source, opt.block_size);
+  uint64_t          nEntries = 0;
+  while (blocks.Next()) {
+
+    auto start = std::chrono::steady_clock::now();
+    tmva_helper.EvaluateMethods(tmva, in_helper, blocks);
+    auto middle = std::chrono::steady_clock::now();
+    native_helper.EvaluateMethods(native, in_helper, blocks);
+    auto stop = std::chrono::steady_clock::now();
+    tmvaTime   += std::chrono::duration<double>(middle - start).count();
+    nativeTime += std::chrono::duration<double>(stop - middle).count();
+
+    for (std::size_t iCheck = 0; iCheck < nMethods; ++iCheck) {
+      for (std::size_t iTarget = 0; iTarget < nTargets; ++iTarget) {
+
+        // outputs of a method follow its targets
+        const std::size_t iOut = nTargets + (methods[iCheck] * nTargets) + iTarget;
+        std::span<const float> expected = tmva_helper.GetColumn(iOut);
+        std::span<const float> observed = native_helper.GetColumn(iOut);
+        for (std::size_t iRow = 0; iRow < blocks.GetSize(); ++iRow) {
+          const double diff  = std::abs(observed[iRow] - expected[iRow]);
+          const double scale = std::max(std::abs((double) expected[iRow]), 1e-12);
+          maxAbs[iCheck] = std::max(maxAbs[iCheck], diff);
+          maxRel[iCheck] = std::max(maxRel[iCheck], diff / scale);
+          if (diff / scale > opt.tolerance) ++nBad[iCheck];
+        }
+      }
+    }
+    nEntries += blocks.GetSize();
+  }  // end block loop
+  if (blocks.HasError()) {
+    std::cerr << "WARNING: stopped reading after " << nEntries << " entries!" << std::endl;
+  }
+
+  // report results
+  std::cout << "    Compared " << nEntries << " entries:" << std::endl;
+  for (std::size_t iCheck = 0; iCheck < nMethods; ++iCheck) {
+    std::cout << "      " << std::setw(10) << std::left << param.methods[methods[iCheck]].first << std::right
+              << "  max abs. diff = " << std::setw(12) << maxAbs[iCheck]
+              << "  max rel. diff = " << std::setw(12) << maxRel[iCheck]
+              << "  outside tolerance = " << nBad[iCheck]
+              << std::endl;
+  }
+  std::cout << "    Time spent evaluating:\n"
+            << "      tmva (all booked methods) = " << tmvaTime << " s\n"
+            << "      native + remaining tmva   = " << nativeTime << " s"
+            << std::endl;
+
+  // clean up & exit
+  delete tmva;
+  delete native;
+  input -> Close();
+  std::cout << "  Finished native backend validation!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================